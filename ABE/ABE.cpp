@@ -69,6 +69,33 @@ void AllocatorDeallocate(AllocatorRef ref, void * p) {
     static_cast<Allocator *>(ref)->deallocate(p);
 }
 
+AllocatorRef AllocatorCreateInstrumented(const char * name, AllocatorRef ref) {
+    sp<Allocator> allocator = new InstrumentedAllocator(name, static_cast<Allocator *>(ref));
+    return (AllocatorRef)allocator->RetainObject();
+}
+
+bool AllocatorGetStats(const AllocatorRef ref, AllocatorStats * stats) {
+    // all allocators share OBJECT_ID_ALLOCATOR, check the real type
+    const InstrumentedAllocator * allocator =
+        dynamic_cast<const InstrumentedAllocator *>(static_cast<const Allocator *>(ref));
+    if (allocator == NULL) {
+        memset(stats, 0, sizeof(AllocatorStats));
+        return false;
+    }
+
+    InstrumentedAllocator::Stats s = allocator->snapshot();
+    memcpy(stats->name, s.mName, sizeof(stats->name));
+    stats->live             = s.mLive;
+    stats->peak             = s.mPeak;
+    stats->allocations      = s.mAllocations;
+    stats->reallocations    = s.mReallocations;
+    stats->deallocations    = s.mDeallocations;
+    for (size_t i = 0; i < 32 && i < InstrumentedAllocator::kHistogramBins; ++i) {
+        stats->histogram[i] = s.mHistogram[i];
+    }
+    return true;
+}
+
 SharedBufferRef SharedBufferCreate(AllocatorRef _allocator, size_t sz) {
     return __NAMESPACE_ABE::SharedBuffer::Create(_allocator, sz);
 }
@@ -40,13 +40,20 @@
 #include <ABE/core/System.h>
 
 #ifdef __cplusplus  // only available for c++
+#include <ABE/core/Hash.h>
+#include <ABE/core/Number.h>
 #include <ABE/core/Allocator.h>
 #include <ABE/core/SharedBuffer.h>
 #include <ABE/core/String.h>
+#include <ABE/core/StringView.h>
+#include <ABE/core/StringBuilder.h>
+#include <ABE/core/Cord.h>
+#include <ABE/core/Atom.h>
 #include <ABE/core/Mutex.h>
 
 // object types [SharedObject] [c & c++]
 #include <ABE/core/Buffer.h>
+#include <ABE/core/BufferChain.h>
 #include <ABE/core/Message.h>
 #include <ABE/core/Content.h>
 #include <ABE/core/Looper.h>
@@ -60,6 +67,7 @@
 #include <ABE/stl/Vector.h>
 #include <ABE/stl/HashTable.h>
 #include <ABE/stl/Queue.h>
+#include <ABE/stl/Stack.h>
 
 // math [non-SharedObject]
 #include <ABE/math/Matrix.h>
@@ -90,6 +98,21 @@ ABE_EXPORT void *               AllocatorAllocate(AllocatorRef, size_t);
 ABE_EXPORT void *               AllocatorReallocate(AllocatorRef, void *, size_t);
 ABE_EXPORT void                 AllocatorDeallocate(AllocatorRef, void *);
 
+// allocator statistics, see InstrumentedAllocator
+typedef struct AllocatorStats {
+    char        name[32];
+    size_t      live;           // bytes in use
+    size_t      peak;           // max of live
+    size_t      allocations;
+    size_t      reallocations;
+    size_t      deallocations;
+    size_t      histogram[32];  // bin i: [2^(i-1), 2^i) bytes
+} AllocatorStats;
+ABE_EXPORT AllocatorRef         AllocatorCreateInstrumented(const char * name, AllocatorRef);
+// return false with zeroed stats if the allocator is not
+// created by AllocatorCreateInstrumented
+ABE_EXPORT bool                 AllocatorGetStats(const AllocatorRef, AllocatorStats *);
+
 
 typedef SharedObjectRef         SharedBufferRef;
 ABE_EXPORT SharedBufferRef      SharedBufferCreate(AllocatorRef allocator, size_t);
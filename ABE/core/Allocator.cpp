@@ -36,10 +36,22 @@
 #include "Log.h"
 
 #include "Allocator.h" 
+#include "System.h"
+#include "stl/Stack.h"
+#include "Config.h"
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#if HAVE_MALLOC_H
+#include <malloc.h>
+#elif HAVE_MALLOC_MALLOC_H
+#include <malloc/malloc.h>
+#endif
 
-#define MIN(a, b)   (a) > (b) ? (b) : (a)
 #define POW_2(x)    (1 << (32 - __builtin_clz((x)-1)))
 #define ALIGN (32)
 
@@ -67,6 +79,18 @@ static int posix_memalign(void **ptr, size_t alignment, size_t size) {
 
 __BEGIN_NAMESPACE_ABE
 
+// usable bytes of a malloc block
+static ABE_INLINE size_t MallocUsable(void * ptr, size_t n) {
+#if HAVE_MALLOC_USABLE_SIZE
+    const size_t length = malloc_usable_size(ptr);
+#elif HAVE_MALLOC_SIZE
+    const size_t length = malloc_size(ptr);
+#else
+    const size_t length = n;
+#endif
+    return length > n ? length : n;
+}
+
 struct AllocatorDefault : public Allocator {
     AllocatorDefault() : Allocator() { }
     virtual ~AllocatorDefault() { }
@@ -84,19 +108,28 @@ struct AllocatorDefault : public Allocator {
         CHECK_NULL(ptr);
         free(ptr);
     }
+    virtual size_t usable(void * ptr, size_t n) {
+        return MallocUsable(ptr, n);
+    }
 };
-sp<Allocator> kAllocatorDefault = new AllocatorDefault;
+
+static Allocator * CreateAllocatorDefault() {
+    const char * name = GetEnvironmentValue("ABE_ALLOCATOR");
+    if (!strcmp(name, "threadcache")) {
+        return new ThreadCacheAllocator;
+    }
+    return new AllocatorDefault;
+}
+sp<Allocator> kAllocatorDefault = CreateAllocatorDefault();
 
 struct AllocatorDefaultAligned : public Allocator {
     const size_t mAlignment;
-    size_t mSize;
     AllocatorDefaultAligned(size_t align) : Allocator(), mAlignment(POW_2(align)) { }
     virtual ~AllocatorDefaultAligned() { }
     virtual void * allocate(size_t size) {
         void * ptr;
         CHECK_EQ(posix_memalign(&ptr, mAlignment, size), 0);
         CHECK_NULL(ptr);
-        mSize = size;
         return ptr;
     }
     virtual void * reallocate(void * ptr, size_t size) {
@@ -106,18 +139,25 @@ struct AllocatorDefaultAligned : public Allocator {
         // and free(3).  (Note however, that the allocation returned
         // by realloc(3) or reallocf(3) is not guaranteed to preserve
         // the original alignment).
+        // so realloc() first, which keeps the data without knowing the
+        // old size, and copy only if the alignment is lost.
+        void * ptr0 = realloc(ptr, size);
+        CHECK_NULL(ptr0);
+        if (((uintptr_t)ptr0 & (mAlignment - 1)) == 0) return ptr0;
+
         void * _ptr;
         CHECK_EQ(posix_memalign(&_ptr, mAlignment, size), 0);
         CHECK_NULL(_ptr);
-        memcpy(_ptr, ptr, MIN(size, mSize));
-        mSize = size;
-        free(ptr);
+        memcpy(_ptr, ptr0, size);
+        free(ptr0);
         return _ptr;
     }
     virtual void deallocate(void * ptr) {
         CHECK_NULL(ptr);
         free(ptr);
-        mSize = 0;
+    }
+    virtual size_t usable(void * ptr, size_t n) {
+        return MallocUsable(ptr, n);
     }
 };
 
@@ -125,5 +165,732 @@ sp<Allocator> GetAlignedAllocator(size_t alignment) {
     return new AllocatorDefaultAligned(alignment);
 }
 
-__END_NAMESPACE_ABE
+// each slot has a header, which tells deallocate() where it comes from.
+// the body of a free slot holds the next link, so no space is wasted
+// while the slot is in use.
+struct PoolAllocator::Slot {
+    Slab *      mSlab;      // NULL if it comes from malloc
+};
+typedef LockFree::FreeList::Node FreeNode;
+
+struct PoolAllocator::FreedSlots {
+    LockFree::FreeList  mList;
+    volatile size_t     mCount;
+    FreedSlots() : mCount(0) { }
+};
+
+struct PoolAllocator::Slab {
+    Slab *      mPrev;      // partial list
+    Slab *      mNext;
+    FreeNode *  mFree;      // freed slots
+    size_t      mBump;      // slots never used start from here
+    size_t      mUsed;
+    Slot *      mSlots;
+};
+
+// slot body keeps malloc alignment, header sits right before it.
+#define SLOT_ALIGNMENT  (2 * sizeof(void *))
+#define SLOT_ALIGN(x, a) (((x) + (a) - 1) & ~((a) - 1))
+#define SLOT_OFFSET     (SLOT_ALIGNMENT - sizeof(PoolAllocator::Slot))
+
+#define SLOT_BODY(slot)     reinterpret_cast<FreeNode *>((slot) + 1)
+#define SLOT_HEADER(ptr)    (static_cast<Slot *>(static_cast<void *>(ptr)) - 1)
 
+PoolAllocator::PoolAllocator(size_t size, bool threadSafe, size_t slabSize) : Allocator(),
+    mSize(SLOT_ALIGN(size > sizeof(FreeNode) ? size : sizeof(FreeNode), sizeof(void *))),
+    mSlotLength(SLOT_ALIGN(sizeof(Slot) + mSize, SLOT_ALIGNMENT)),
+    mSlabSlots(slabSize / mSlotLength > 8 ? slabSize / mSlotLength : 8),
+    mThreadSafe(threadSafe), mPartial(NULL), mSlabs(0),
+    mFreed(new FreedSlots) {
+        CHECK_GT(size, 0);
+    }
+
+PoolAllocator::~PoolAllocator() {
+    drain();
+    // all slabs with slots in use are full slabs or in partial list
+    while (mPartial) {
+        CHECK_EQ(mPartial->mUsed, 0, "slots leaked");
+        freeSlab(mPartial);
+    }
+    CHECK_EQ(mSlabs, 0, "slabs leaked");
+    delete mFreed;
+}
+
+PoolAllocator::Slab * PoolAllocator::allocateSlab() {
+    const size_t length = SLOT_ALIGN(sizeof(Slab), SLOT_ALIGNMENT) + SLOT_OFFSET + mSlabSlots * mSlotLength;
+    Slab * slab = static_cast<Slab *>(malloc(length));
+    CHECK_NULL(slab);
+    slab->mPrev     = NULL;
+    slab->mNext     = mPartial;
+    slab->mFree     = NULL;
+    slab->mBump     = 0;
+    slab->mUsed     = 0;
+    slab->mSlots    = reinterpret_cast<Slot *>((char *)slab + SLOT_ALIGN(sizeof(Slab), SLOT_ALIGNMENT) + SLOT_OFFSET);
+    if (mPartial) mPartial->mPrev = slab;
+    mPartial = slab;
+    ++mSlabs;
+    return slab;
+}
+
+// remove from partial list and free
+void PoolAllocator::freeSlab(Slab * slab) {
+    if (slab->mPrev)    slab->mPrev->mNext = slab->mNext;
+    else                mPartial = slab->mNext;
+    if (slab->mNext)    slab->mNext->mPrev = slab->mPrev;
+    --mSlabs;
+    free(slab);
+}
+
+void * PoolAllocator::allocateSlot() {
+    // recently freed slots first, they are still hot in cache.
+    FreeNode * node = mFreed->mList.pop();
+    if (node) {
+        ABE_ATOMIC_SUB(&mFreed->mCount, 1);
+        return node;
+    }
+
+    Slab * slab = mPartial ? mPartial : allocateSlab();
+
+    Slot * slot;
+    if (slab->mFree) {
+        node = slab->mFree;
+        slab->mFree = node->mNext;
+        slot = SLOT_HEADER(node);
+    } else {
+        slot = reinterpret_cast<Slot *>((char *)slab->mSlots + slab->mBump++ * mSlotLength);
+        slot->mSlab = slab;
+    }
+
+    // full slab: leave partial list
+    if (++slab->mUsed == mSlabSlots) {
+        mPartial = slab->mNext;
+        if (mPartial) mPartial->mPrev = NULL;
+        slab->mNext = NULL;
+    }
+    return slot + 1;
+}
+
+void PoolAllocator::freeSlot(Slot * slot) {
+    Slab * slab = slot->mSlab;
+    FreeNode * node = SLOT_BODY(slot);
+    node->mNext = slab->mFree;
+    slab->mFree = node;
+
+    // full slab: back to partial list
+    if (slab->mUsed-- == mSlabSlots) {
+        slab->mPrev = NULL;
+        slab->mNext = mPartial;
+        if (mPartial) mPartial->mPrev = slab;
+        mPartial = slab;
+    }
+
+    // empty slab: return it if it is not the only one
+    if (slab->mUsed == 0 && (slab->mPrev || slab->mNext)) {
+        freeSlab(slab);
+    }
+}
+
+// return freed slots to their slabs, so empty slabs can be released.
+// pop() & popAll() only happen with mLock held, so a slot can not be
+// released while others are still reading its link.
+void PoolAllocator::drain() {
+    FreeNode * node = mFreed->mList.popAll();
+    size_t n = 0;
+    while (node) {
+        FreeNode * next = node->mNext;
+        freeSlot(SLOT_HEADER(node));
+        node = next;
+        ++n;
+    }
+    if (n) ABE_ATOMIC_SUB(&mFreed->mCount, n);
+}
+
+void * PoolAllocator::allocate(size_t n) {
+    if (n > mSize) {
+        char * base = static_cast<char *>(malloc(SLOT_ALIGNMENT + n));
+        CHECK_NULL(base);
+        Slot * slot = reinterpret_cast<Slot *>(base + SLOT_OFFSET);
+        slot->mSlab = NULL;
+        return slot + 1;
+    }
+
+    if (mThreadSafe) mLock.lock();
+    void * ptr = allocateSlot();
+    if (mThreadSafe) mLock.unlock();
+    return ptr;
+}
+
+void * PoolAllocator::reallocate(void * ptr, size_t n) {
+    if (ptr == NULL) return allocate(n);
+
+    Slot * slot = SLOT_HEADER(ptr);
+    if (slot->mSlab == NULL) {
+        char * base = static_cast<char *>(realloc((char *)slot - SLOT_OFFSET, SLOT_ALIGNMENT + n));
+        CHECK_NULL(base);
+        return base + SLOT_ALIGNMENT;
+    }
+
+    if (n <= mSize) return ptr;
+    void * _ptr = allocate(n);
+    memcpy(_ptr, ptr, mSize);
+    deallocate(ptr);
+    return _ptr;
+}
+
+// push to the lock free list, no lock needed until a slab worth of
+// slots are freed, then give them back to slabs at once.
+void PoolAllocator::deallocate(void * ptr) {
+    CHECK_NULL(ptr);
+    Slot * slot = SLOT_HEADER(ptr);
+    if (slot->mSlab == NULL) {
+        free((char *)slot - SLOT_OFFSET);
+        return;
+    }
+
+    mFreed->mList.push(SLOT_BODY(slot));
+    if (ABE_ATOMIC_ADD(&mFreed->mCount, 1) < mSlabSlots) return;
+
+    if (mThreadSafe) mLock.lock();
+    drain();
+    if (mThreadSafe) mLock.unlock();
+}
+
+size_t PoolAllocator::usable(void * ptr, size_t n) {
+    Slot * slot = SLOT_HEADER(ptr);
+    return slot->mSlab ? mSize : n;
+}
+
+// size classes of thread cache
+static const size_t kSizeClasses[] = {
+    16,     32,     48,     64,     80,     96,     112,    128,
+    192,    256,    384,    512,    768,    1024,   1536,   2048,
+    3072,   4096
+};
+#define NCLASS          (sizeof(kSizeClasses) / sizeof(kSizeClasses[0]))
+#define LARGE_CLASS     NCLASS
+#define BATCH_COUNT     (32)                // blocks move between cache & depot
+#define CACHE_MAX       (BATCH_COUNT * 2)   // max blocks per class per thread
+
+// header of each block
+struct Block {
+    union {
+        LockFree::FreeList::Node    mBatch;     // link batches in depot
+        size_t                      mClass;     // size class when in use
+    };
+    Block *                         mNext;      // link blocks in thread cache or batch
+};
+
+struct ThreadCache {
+    Block *     mBlocks[NCLASS];
+    size_t      mCount[NCLASS];
+};
+
+static LockFree::FreeList   gDepot[NCLASS];
+static pthread_key_t        gCacheKey;
+static pthread_once_t       gCacheOnce = PTHREAD_ONCE_INIT;
+static __thread ThreadCache * tls_cache = NULL;
+
+static ABE_INLINE size_t SizeClass(size_t n) {
+    if (n <= 128) return n ? (n - 1) >> 4 : 0;
+    for (size_t i = 8; i < NCLASS; ++i) {
+        if (n <= kSizeClasses[i]) return i;
+    }
+    return LARGE_CLASS;
+}
+
+// push a chain of blocks to depot as a batch
+static void DepotPush(size_t cls, Block * first) {
+    gDepot[cls].push(&first->mBatch);
+}
+
+// return all blocks to depot on thread exit
+static void ThreadCacheFlush(void * opaque) {
+    ThreadCache * cache = static_cast<ThreadCache *>(opaque);
+    for (size_t i = 0; i < NCLASS; ++i) {
+        if (cache->mBlocks[i]) DepotPush(i, cache->mBlocks[i]);
+    }
+    free(cache);
+    tls_cache = NULL;
+}
+
+static void ThreadCacheKeyCreate() {
+    CHECK_EQ(pthread_key_create(&gCacheKey, ThreadCacheFlush), 0);
+}
+
+static ABE_INLINE ThreadCache * ThreadCacheGet() {
+    if (__builtin_expect(tls_cache == NULL, 0)) {
+        pthread_once(&gCacheOnce, ThreadCacheKeyCreate);
+        tls_cache = static_cast<ThreadCache *>(calloc(1, sizeof(ThreadCache)));
+        CHECK_NULL(tls_cache);
+        pthread_setspecific(gCacheKey, tls_cache);
+    }
+    return tls_cache;
+}
+
+ThreadCacheAllocator::ThreadCacheAllocator() : Allocator() {
+}
+
+ThreadCacheAllocator::~ThreadCacheAllocator() {
+}
+
+void * ThreadCacheAllocator::allocate(size_t n) {
+    const size_t cls = SizeClass(n);
+    Block * block;
+    if (cls == LARGE_CLASS) {
+        block = static_cast<Block *>(malloc(sizeof(Block) + n));
+        CHECK_NULL(block);
+    } else {
+        ThreadCache * cache = ThreadCacheGet();
+        block = cache->mBlocks[cls];
+        if (block == NULL) {
+            // refill from depot
+            block = reinterpret_cast<Block *>(gDepot[cls].pop());
+            size_t count = 0;
+            for (Block * next = block; next; next = next->mNext) ++count;
+            cache->mCount[cls] = count;
+        }
+        if (block) {
+            cache->mBlocks[cls] = block->mNext;
+            --cache->mCount[cls];
+        } else {
+            block = static_cast<Block *>(malloc(sizeof(Block) + kSizeClasses[cls]));
+            CHECK_NULL(block);
+        }
+    }
+    block->mClass = cls;
+    return block + 1;
+}
+
+void * ThreadCacheAllocator::reallocate(void * ptr, size_t n) {
+    if (ptr == NULL) return allocate(n);
+
+    Block * block = static_cast<Block *>(ptr) - 1;
+    if (block->mClass == LARGE_CLASS) {
+        block = static_cast<Block *>(realloc(block, sizeof(Block) + n));
+        CHECK_NULL(block);
+        return block + 1;
+    }
+
+    const size_t length = kSizeClasses[block->mClass];
+    if (n <= length) return ptr;
+
+    void * _ptr = allocate(n);
+    memcpy(_ptr, ptr, length);
+    deallocate(ptr);
+    return _ptr;
+}
+
+void ThreadCacheAllocator::deallocate(void * ptr) {
+    CHECK_NULL(ptr);
+    Block * block = static_cast<Block *>(ptr) - 1;
+    const size_t cls = block->mClass;
+    if (cls == LARGE_CLASS) {
+        free(block);
+        return;
+    }
+
+    ThreadCache * cache = ThreadCacheGet();
+    block->mNext = cache->mBlocks[cls];
+    cache->mBlocks[cls] = block;
+
+    // too many blocks: move a batch to depot, for other threads
+    if (++cache->mCount[cls] > CACHE_MAX) {
+        Block * last = block;
+        for (size_t i = 1; i < BATCH_COUNT; ++i) last = last->mNext;
+        cache->mBlocks[cls] = last->mNext;
+        cache->mCount[cls] -= BATCH_COUNT;
+        last->mNext = NULL;
+        DepotPush(cls, block);
+    }
+}
+
+size_t ThreadCacheAllocator::usable(void * ptr, size_t n) {
+    Block * block = static_cast<Block *>(ptr) - 1;
+    return block->mClass == LARGE_CLASS ? n : kSizeClasses[block->mClass];
+}
+
+struct ArenaAllocator::Chunk {
+    Chunk *     mNext;
+    size_t      mLength;
+    size_t      mUsed;
+    size_t      mReserved;  // keep data aligned
+};
+
+// each block has a header with its size, for reallocate()
+struct ArenaBlock {
+    size_t      mSize;
+    size_t      mReserved;
+};
+
+#define ARENA_ALIGN(x)  (((x) + sizeof(ArenaBlock) - 1) & ~(sizeof(ArenaBlock) - 1))
+
+ArenaAllocator::ArenaAllocator(size_t chunkSize) : Allocator(),
+    mChunkSize(chunkSize), mChunks(NULL) {
+        CHECK_GT(chunkSize, sizeof(ArenaBlock));
+    }
+
+ArenaAllocator::~ArenaAllocator() {
+    while (mChunks) {
+        Chunk * next = mChunks->mNext;
+        free(mChunks);
+        mChunks = next;
+    }
+}
+
+ArenaAllocator::Chunk * ArenaAllocator::allocateChunk(size_t n) {
+    const size_t length = n > mChunkSize ? n : mChunkSize;
+    Chunk * chunk = static_cast<Chunk *>(malloc(sizeof(Chunk) + length));
+    CHECK_NULL(chunk);
+    chunk->mNext    = mChunks;
+    chunk->mLength  = length;
+    chunk->mUsed    = 0;
+    mChunks         = chunk;
+    return chunk;
+}
+
+void * ArenaAllocator::allocate(size_t n) {
+    const size_t length = sizeof(ArenaBlock) + ARENA_ALIGN(n);
+    Chunk * chunk = mChunks;
+    if (chunk == NULL || chunk->mUsed + length > chunk->mLength) {
+        chunk = allocateChunk(length);
+    }
+    ArenaBlock * block = reinterpret_cast<ArenaBlock *>((char *)(chunk + 1) + chunk->mUsed);
+    block->mSize    = n;
+    chunk->mUsed    += length;
+    return block + 1;
+}
+
+void * ArenaAllocator::reallocate(void * ptr, size_t n) {
+    if (ptr == NULL) return allocate(n);
+
+    ArenaBlock * block = static_cast<ArenaBlock *>(ptr) - 1;
+    if (n <= ARENA_ALIGN(block->mSize)) {
+        block->mSize = n;
+        return ptr;
+    }
+
+    // last block of current chunk: grow in place
+    Chunk * chunk = mChunks;
+    char * end = (char *)(chunk + 1) + chunk->mUsed;
+    if ((char *)ptr + ARENA_ALIGN(block->mSize) == end) {
+        const size_t extra = ARENA_ALIGN(n) - ARENA_ALIGN(block->mSize);
+        if (chunk->mUsed + extra <= chunk->mLength) {
+            chunk->mUsed    += extra;
+            block->mSize    = n;
+            return ptr;
+        }
+    }
+
+    void * _ptr = allocate(n);
+    memcpy(_ptr, ptr, block->mSize);
+    return _ptr;
+}
+
+void ArenaAllocator::deallocate(void * ptr) {
+    // NOTHING, memory is released by reset() or rewind()
+}
+
+void ArenaAllocator::reset() {
+    Mark mark = { NULL, 0 };
+    rewind(mark);
+}
+
+ArenaAllocator::Mark ArenaAllocator::mark() const {
+    Mark mark = { mChunks, mChunks ? mChunks->mUsed : 0 };
+    return mark;
+}
+
+void ArenaAllocator::rewind(const Mark& mark) {
+    // free chunks allocated after mark, but keep the first chunk
+    while (mChunks != mark.mChunk && mChunks->mNext) {
+        Chunk * next = mChunks->mNext;
+        free(mChunks);
+        mChunks = next;
+    }
+    if (mChunks) mChunks->mUsed = mChunks == mark.mChunk ? mark.mUsed : 0;
+}
+
+size_t ArenaAllocator::size() const {
+    size_t n = 0;
+    for (Chunk * chunk = mChunks; chunk; chunk = chunk->mNext) n += chunk->mUsed;
+    return n;
+}
+
+// each block has a header, mLength is 0 for malloc blocks
+struct HugePageAllocator::Block {
+    size_t      mLength;    // mapped length
+    size_t      mSize;      // requested size
+    size_t      mHugeTLB;   // mapped with MAP_HUGETLB
+    size_t      mReserved;  // keep data aligned
+};
+
+#define HUGE_PAGE_SIZE      (2 * 1024 * 1024)
+#define HUGE_PAGE_ALIGN(x)  (((x) + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1))
+
+#if HAVE_SYS_MMAN_H
+// MAP_HUGETLB fails if not enough huge pages reserved, don't try again
+// with this length or longer, until some huge tlb blocks are unmapped.
+static volatile size_t gHugeTLBFailed = (size_t)-1;
+
+// pre-fault pages in [from, to)
+static void Populate(char * from, char * to) {
+    const size_t page = sysconf(_SC_PAGESIZE);
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(from, to - from, MADV_POPULATE_WRITE) == 0) return;
+#endif
+    for (; from < to; from += page) *(volatile char *)from = 0;
+}
+#endif
+
+HugePageAllocator::HugePageAllocator(bool populate, size_t threshold) : Allocator(),
+    mPopulate(populate), mThreshold(threshold) {
+    }
+
+HugePageAllocator::~HugePageAllocator() {
+}
+
+HugePageAllocator::Block * HugePageAllocator::map(size_t n) {
+#if HAVE_SYS_MMAN_H
+    const size_t length = HUGE_PAGE_ALIGN(sizeof(Block) + n);
+    const int prot = PROT_READ | PROT_WRITE;
+    Block * block;
+
+#ifdef MAP_HUGETLB
+    if (length < ABE_ATOMIC_LOAD(&gHugeTLBFailed)) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_POPULATE
+        if (mPopulate) flags |= MAP_POPULATE;
+#endif
+        void * p = mmap(NULL, length, prot, flags, -1, 0);
+        if (p != MAP_FAILED) {
+            block = static_cast<Block *>(p);
+            block->mLength  = length;
+            block->mHugeTLB = 1;
+            return block;
+        }
+        INFO("MAP_HUGETLB %zu bytes failed, fall back to transparent huge pages", length);
+        size_t failed = ABE_ATOMIC_LOAD(&gHugeTLBFailed);
+        while (length < failed && !ABE_ATOMIC_CAS(&gHugeTLBFailed, &failed, length)) { }
+    }
+#endif
+
+    // map one more huge page and trim to huge page boundary,
+    // so the whole block can be backed by transparent huge pages.
+    char * p = static_cast<char *>(mmap(NULL, length + HUGE_PAGE_SIZE, prot,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (p == MAP_FAILED) return NULL;
+    char * aligned = (char *)HUGE_PAGE_ALIGN((uintptr_t)p);
+    if (aligned > p) munmap(p, aligned - p);
+    if (p + HUGE_PAGE_SIZE > aligned) munmap(aligned + length, p + HUGE_PAGE_SIZE - aligned);
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+    if (mPopulate) Populate(aligned, aligned + length);
+
+    block = reinterpret_cast<Block *>(aligned);
+    block->mLength  = length;
+    block->mHugeTLB = 0;
+    return block;
+#else
+    return NULL;
+#endif
+}
+
+void HugePageAllocator::unmap(Block * block) {
+#if HAVE_SYS_MMAN_H
+    const bool hugeTLB = block->mHugeTLB;
+    CHECK_EQ(munmap(block, block->mLength), 0);
+    // huge pages are back to the pool, MAP_HUGETLB may work again
+    if (hugeTLB) ABE_ATOMIC_STORE(&gHugeTLBFailed, (size_t)-1);
+#endif
+}
+
+void * HugePageAllocator::allocate(size_t n) {
+    Block * block = NULL;
+    if (n >= mThreshold) block = map(n);
+    if (block == NULL) {
+        block = static_cast<Block *>(malloc(sizeof(Block) + n));
+        CHECK_NULL(block);
+        block->mLength = 0;
+    }
+    block->mSize = n;
+    return block + 1;
+}
+
+void * HugePageAllocator::reallocate(void * ptr, size_t n) {
+    if (ptr == NULL) return allocate(n);
+
+    Block * block = static_cast<Block *>(ptr) - 1;
+    if (block->mLength == 0) {
+        if (n < mThreshold) {
+            block = static_cast<Block *>(realloc(block, sizeof(Block) + n));
+            CHECK_NULL(block);
+            block->mSize = n;
+            return block + 1;
+        }
+    } else if (sizeof(Block) + n <= block->mLength) {
+        block->mSize = n;
+        return ptr;
+    }
+#if HAVE_MREMAP
+    // move pages instead of copy. huge tlb mapping can not grow.
+    else if (!block->mHugeTLB) {
+        const size_t length = HUGE_PAGE_ALIGN(sizeof(Block) + n);
+        const size_t length0 = block->mLength;
+        // grow in place first, it keeps the alignment.
+        void * p = mremap(block, length0, length, 0);
+#ifdef MREMAP_FIXED
+        // or move pages into a huge page aligned hole.
+        if (p == MAP_FAILED) {
+            char * hole = static_cast<char *>(mmap(NULL, length + HUGE_PAGE_SIZE,
+                        PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (hole != MAP_FAILED) {
+                char * aligned = (char *)HUGE_PAGE_ALIGN((uintptr_t)hole);
+                p = mremap(block, length0, length, MREMAP_MAYMOVE | MREMAP_FIXED, aligned);
+                if (p != MAP_FAILED) {
+                    // [aligned, aligned + length) is replaced, unmap the rest
+                    if (aligned > hole) munmap(hole, aligned - hole);
+                    if (hole + HUGE_PAGE_SIZE > aligned) munmap(aligned + length, hole + HUGE_PAGE_SIZE - aligned);
+                } else {
+                    munmap(hole, length + HUGE_PAGE_SIZE);
+                }
+            }
+        }
+#endif
+        if (p != MAP_FAILED) {
+            char * from = (char *)p + length0;
+#ifdef MADV_HUGEPAGE
+            madvise(p, length, MADV_HUGEPAGE);
+#endif
+            if (mPopulate) Populate(from, (char *)p + length);
+            block = static_cast<Block *>(p);
+            block->mLength  = length;
+            block->mSize    = n;
+            return block + 1;
+        }
+    }
+#endif
+
+    void * _ptr = allocate(n);
+    memcpy(_ptr, ptr, block->mSize < n ? block->mSize : n);
+    deallocate(ptr);
+    return _ptr;
+}
+
+void HugePageAllocator::deallocate(void * ptr) {
+    CHECK_NULL(ptr);
+    Block * block = static_cast<Block *>(ptr) - 1;
+    if (block->mLength == 0) free(block);
+    else unmap(block);
+}
+
+// counters of a stripe, padded to cache lines
+struct InstrumentedAllocator::Counters {
+    volatile size_t mAllocations;
+    volatile size_t mReallocations;
+    volatile size_t mDeallocations;
+    volatile size_t mHistogram[kHistogramBins];
+    size_t          mReserved[5];
+};
+
+// threads are spread over stripes, less contention than a global counter
+#define NSTRIPES        (16)
+static __thread size_t      tls_stripe  = 0;    // 0: not assigned
+static volatile size_t      g_stripe    = 0;
+
+static ABE_INLINE size_t HistogramBin(size_t n) {
+    if (n == 0) return 0;
+    const size_t bin = sizeof(unsigned long long) * 8 - __builtin_clzll(n);
+    return bin < InstrumentedAllocator::kHistogramBins ? bin : InstrumentedAllocator::kHistogramBins - 1;
+}
+
+// size of each block is put right before it
+static ABE_INLINE size_t& BlockSize(void * ptr) {
+    return static_cast<size_t *>(ptr)[-1];
+}
+
+InstrumentedAllocator::InstrumentedAllocator(const char * name, const sp<Allocator>& allocator, size_t alignment) :
+    Allocator(), mAllocator(allocator),
+    mHeader(alignment > sizeof(size_t) ? alignment : sizeof(size_t)),
+    mLive(0), mPeak(0), mCounters(NULL) {
+        CHECK_NULL(name);
+        strncpy(mName, name, sizeof(mName) - 1);
+        mName[sizeof(mName) - 1] = '\0';
+        CHECK_EQ(posix_memalign((void **)&mCounters, 64, sizeof(Counters) * NSTRIPES), 0);
+        memset(mCounters, 0, sizeof(Counters) * NSTRIPES);
+    }
+
+InstrumentedAllocator::~InstrumentedAllocator() {
+    free(mCounters);
+}
+
+InstrumentedAllocator::Counters& InstrumentedAllocator::counters() {
+    if (__builtin_expect(tls_stripe == 0, 0)) {
+        tls_stripe = ABE_ATOMIC_ADD(&g_stripe, 1);
+    }
+    return mCounters[tls_stripe % NSTRIPES];
+}
+
+void InstrumentedAllocator::account(ssize_t delta) {
+    const size_t live = ABE_ATOMIC_ADD(&mLive, (size_t)delta);
+    size_t peak = ABE_ATOMIC_LOAD(&mPeak);
+    while (live > peak && !ABE_ATOMIC_CAS(&mPeak, &peak, live)) { }
+}
+
+void * InstrumentedAllocator::allocate(size_t n) {
+    char * ptr = static_cast<char *>(mAllocator->allocate(mHeader + n));
+    if (ptr == NULL) return NULL;
+    ptr += mHeader;
+    BlockSize(ptr) = n;
+
+    Counters& c = counters();
+    ABE_ATOMIC_ADD(&c.mAllocations, 1);
+    ABE_ATOMIC_ADD(&c.mHistogram[HistogramBin(n)], 1);
+    account(n);
+    return ptr;
+}
+
+void * InstrumentedAllocator::reallocate(void * ptr, size_t n) {
+    if (ptr == NULL) return allocate(n);
+
+    const size_t old = BlockSize(ptr);
+    char * _ptr = static_cast<char *>(mAllocator->reallocate((char *)ptr - mHeader, mHeader + n));
+    if (_ptr == NULL) return NULL;
+    _ptr += mHeader;
+    BlockSize(_ptr) = n;
+
+    Counters& c = counters();
+    ABE_ATOMIC_ADD(&c.mReallocations, 1);
+    ABE_ATOMIC_ADD(&c.mHistogram[HistogramBin(n)], 1);
+    account((ssize_t)n - (ssize_t)old);
+    return _ptr;
+}
+
+void InstrumentedAllocator::deallocate(void * ptr) {
+    CHECK_NULL(ptr);
+    const size_t n = BlockSize(ptr);
+    mAllocator->deallocate((char *)ptr - mHeader);
+
+    ABE_ATOMIC_ADD(&counters().mDeallocations, 1);
+    account(-(ssize_t)n);
+}
+
+InstrumentedAllocator::Stats InstrumentedAllocator::snapshot() const {
+    Stats stats;
+    memset(&stats, 0, sizeof(stats));
+    memcpy(stats.mName, mName, sizeof(mName));
+    stats.mLive = ABE_ATOMIC_LOAD(&mLive);
+    stats.mPeak = ABE_ATOMIC_LOAD(&mPeak);
+    for (size_t i = 0; i < NSTRIPES; ++i) {
+        const Counters& c = mCounters[i];
+        stats.mAllocations      += ABE_ATOMIC_LOAD(&c.mAllocations);
+        stats.mReallocations    += ABE_ATOMIC_LOAD(&c.mReallocations);
+        stats.mDeallocations    += ABE_ATOMIC_LOAD(&c.mDeallocations);
+        for (size_t j = 0; j < kHistogramBins; ++j) {
+            stats.mHistogram[j] += ABE_ATOMIC_LOAD(&c.mHistogram[j]);
+        }
+    }
+    return stats;
+}
+
+__END_NAMESPACE_ABE
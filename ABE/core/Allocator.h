@@ -36,6 +36,7 @@
 #define ABE_HEADERS_ALLOCATOR_H
 
 #include <ABE/core/Types.h>
+#include <ABE/core/Mutex.h>
 
 __BEGIN_NAMESPACE_ABE
 
@@ -58,11 +59,228 @@ struct ABE_EXPORT Allocator : public SharedObject {
      * free the memory
      */
     virtual void    deallocate(void * ptr) = 0;
+    /**
+     * usable bytes of a block allocated with n bytes
+     * @return return n or more, client may use the extra bytes without reallocate
+     */
+    virtual size_t  usable(void * ptr, size_t n) { return n; }
 };
 
 ABE_EXPORT extern sp<Allocator> kAllocatorDefault;
 ABE_EXPORT sp<Allocator> GetAlignedAllocator(size_t alignment);
 
+/**
+ * fixed size slab allocator.
+ * slots are carved out of large slabs, allocate() & deallocate() are O(1),
+ * and a slab is returned to system once all its slots are free.
+ * requests larger than slot size fall back to malloc, so it is safe to
+ * pass it to containers, which allocate storage with the same allocator.
+ * @note alignment is 2 * sizeof(void *), same as malloc.
+ */
+struct ABE_EXPORT PoolAllocator : public Allocator {
+    public:
+        /**
+         * @param size          slot size in bytes
+         * @param threadSafe    lock on allocate, deallocate is lock free
+         * @param slabSize      bytes of each slab
+         */
+        PoolAllocator(size_t size, bool threadSafe = false, size_t slabSize = 64 * 1024);
+        virtual ~PoolAllocator();
+
+        virtual void *  allocate(size_t n);
+        virtual void *  reallocate(void * ptr, size_t n);
+        virtual void    deallocate(void * ptr);
+        virtual size_t  usable(void * ptr, size_t n);
+
+        ABE_INLINE size_t   size() const    { return mSize;     }   // slot size
+
+    private:
+        struct Slot;
+        struct Slab;
+        struct FreedSlots;
+        Slab *          allocateSlab();
+        void            freeSlab(Slab *);
+        void *          allocateSlot();
+        void            freeSlot(Slot *);
+        void            drain();
+
+        const size_t    mSize;
+        const size_t    mSlotLength;
+        const size_t    mSlabSlots;
+        const bool      mThreadSafe;
+        Mutex           mLock;
+        Slab *          mPartial;   // slabs with free slots
+        size_t          mSlabs;
+        FreedSlots *    mFreed;     // freed slots, not back to slabs yet
+
+    private:
+        DISALLOW_EVILS(PoolAllocator);
+};
+
+/**
+ * thread caching allocator.
+ * small blocks are cached per thread by size class, and move between
+ * threads in batches through a global lock free depot, so frees from
+ * other threads are cheap too. blocks larger than 4k fall back to malloc.
+ * set environment ABE_ALLOCATOR=threadcache to use it as kAllocatorDefault.
+ * @note cached blocks are never returned to system.
+ */
+struct ABE_EXPORT ThreadCacheAllocator : public Allocator {
+    public:
+        ThreadCacheAllocator();
+        virtual ~ThreadCacheAllocator();
+
+        virtual void *  allocate(size_t n);
+        virtual void *  reallocate(void * ptr, size_t n);
+        virtual void    deallocate(void * ptr);
+        virtual size_t  usable(void * ptr, size_t n);
+
+    private:
+        DISALLOW_EVILS(ThreadCacheAllocator);
+};
+
+/**
+ * arena allocator, bump allocate from large chunks.
+ * deallocate() does nothing, memory is released at once by reset()
+ * or by an ArenaScope. for short lived objects, e.g. inside a job.
+ * @note not thread safe.
+ * @note objects allocated from arena MUST die before reset.
+ */
+struct ABE_EXPORT ArenaAllocator : public Allocator {
+    public:
+        struct Chunk;
+        struct Mark {
+            Chunk *     mChunk;
+            size_t      mUsed;
+        };
+
+    public:
+        ArenaAllocator(size_t chunkSize = 64 * 1024);
+        virtual ~ArenaAllocator();
+
+        virtual void *  allocate(size_t n);
+        virtual void *  reallocate(void * ptr, size_t n);
+        virtual void    deallocate(void * ptr);
+
+        /**
+         * release all memory, the first chunk is kept for reuse
+         */
+        void            reset();
+        /**
+         * current position, release memory allocated after it by rewind()
+         */
+        Mark            mark() const;
+        void            rewind(const Mark&);
+        /**
+         * bytes allocated from chunks
+         */
+        size_t          size() const;
+
+    private:
+        Chunk *         allocateChunk(size_t n);
+
+        const size_t    mChunkSize;
+        Chunk *         mChunks;    // newest first
+
+    private:
+        DISALLOW_EVILS(ArenaAllocator);
+};
+
+/**
+ * release arena memory allocated in this scope
+ */
+struct ABE_EXPORT ArenaScope : public NonSharedObject {
+    public:
+        ABE_INLINE ArenaScope(const sp<ArenaAllocator>& arena) : mArena(arena), mMark(arena->mark()) { }
+        ABE_INLINE ~ArenaScope()    { mArena->rewind(mMark); }
+
+    private:
+        sp<ArenaAllocator>      mArena;
+        ArenaAllocator::Mark    mMark;
+
+    private:
+        DISALLOW_EVILS(ArenaScope);
+};
+
+/**
+ * huge page allocator, for large buffers like video frames.
+ * blocks >= threshold are mapped with huge pages: MAP_HUGETLB if the
+ * system has reserved huge pages, otherwise 2M aligned mapping with
+ * madvise(MADV_HUGEPAGE). smaller blocks fall back to malloc.
+ * @param populate  pre-fault pages on allocate, avoid page faults on first touch.
+ * @param threshold minimum bytes to use huge pages.
+ * @note reallocate() uses mremap() to avoid copy when possible.
+ */
+struct ABE_EXPORT HugePageAllocator : public Allocator {
+    public:
+        HugePageAllocator(bool populate = false, size_t threshold = 1024 * 1024);
+        virtual ~HugePageAllocator();
+
+        virtual void *  allocate(size_t n);
+        virtual void *  reallocate(void * ptr, size_t n);
+        virtual void    deallocate(void * ptr);
+
+    private:
+        struct Block;
+        Block *         map(size_t n);
+        void            unmap(Block *);
+
+        const bool      mPopulate;
+        const size_t    mThreshold;
+
+    private:
+        DISALLOW_EVILS(HugePageAllocator);
+};
+
+/**
+ * allocator decorator, tracks live/peak bytes, call counts and a log2
+ * size histogram of another allocator, tagged by a name.
+ * counters are lock free and striped by thread, snapshot() sums them.
+ * @param alignment alignment of the wrapped allocator, a size header is
+ *                  put before each block and it keeps the alignment.
+ */
+struct ABE_EXPORT InstrumentedAllocator : public Allocator {
+    public:
+        enum { kHistogramBins = 32 };   // bin i: [2^(i-1), 2^i) bytes
+        struct Stats {
+            char        mName[32];
+            size_t      mLive;          // bytes in use
+            size_t      mPeak;          // max of mLive
+            size_t      mAllocations;
+            size_t      mReallocations;
+            size_t      mDeallocations;
+            size_t      mHistogram[kHistogramBins];     // of allocate & reallocate
+        };
+
+    public:
+        InstrumentedAllocator(const char * name,
+                const sp<Allocator>& allocator = kAllocatorDefault,
+                size_t alignment = 2 * sizeof(void *));
+        virtual ~InstrumentedAllocator();
+
+        virtual void *  allocate(size_t n);
+        virtual void *  reallocate(void * ptr, size_t n);
+        virtual void    deallocate(void * ptr);
+
+        const char *    name() const    { return mName; }
+        Stats           snapshot() const;
+
+    private:
+        struct Counters;
+        Counters&       counters();
+        void            account(ssize_t delta);
+
+        char            mName[32];
+        sp<Allocator>   mAllocator;
+        const size_t    mHeader;
+        volatile size_t mLive;
+        volatile size_t mPeak;
+        Counters *      mCounters;
+
+    private:
+        DISALLOW_EVILS(InstrumentedAllocator);
+};
+
 __END_NAMESPACE_ABE
 
 #endif // ABE_HEADERS_ALLOCATOR_H
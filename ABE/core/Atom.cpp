@@ -0,0 +1,133 @@
+/******************************************************************************
+ * Copyright (c) 2018, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    Atom.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181203     initial version
+//
+
+#define LOG_TAG "Atom"
+#include "Log.h"
+#include "Atom.h"
+#include "Hash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// buckets of intern table, each bucket is a lock free list which
+// only grows at head, so readers never block & entries never move.
+#define NBUCKETS    (1024)
+
+__BEGIN_NAMESPACE_ABE
+
+static void * volatile  gTable[NBUCKETS];
+static volatile size_t  gAtoms = 0;     // last id
+
+static ABE_INLINE size_t Hash(const char * s, size_t n) {
+    return (size_t)HashBytes(s, n);
+}
+
+Atom::Atom(const char * s, size_t n) : mEntry(NULL) {
+    CHECK_NULL(s);
+    mEntry = Intern(s, n ? strnlen(s, n) : strlen(s));
+}
+
+Atom::Atom(const String& s) : mEntry(NULL) {
+    if (!s.empty()) mEntry = Intern(s.c_str(), s.size());
+}
+
+Atom::Atom(const StringView& s) : mEntry(NULL) {
+    if (!s.empty()) mEntry = Intern(s.data(), s.size());
+}
+
+Atom Atom::Find(const char * s, size_t n) {
+    CHECK_NULL(s);
+    Atom atom;
+    atom.mEntry = Lookup(s, n ? strnlen(s, n) : strlen(s));
+    return atom;
+}
+
+Atom Atom::Find(const String& s) {
+    Atom atom;
+    atom.mEntry = Lookup(s.c_str(), s.size());
+    return atom;
+}
+
+Atom Atom::Find(const StringView& s) {
+    Atom atom;
+    atom.mEntry = Lookup(s.data(), s.size());
+    return atom;
+}
+
+const Atom::Entry * Atom::Lookup(const char * s, size_t n) {
+    if (n == 0) return NULL;
+
+    const size_t h = Hash(s, n);
+    Entry * volatile * bucket = reinterpret_cast<Entry * volatile *>(&gTable[h & (NBUCKETS - 1)]);
+    for (Entry * e = ABE_ATOMIC_LOAD(bucket); e; e = e->mNext) {
+        if (e->mHash == h && e->mSize == n && !memcmp(e->mString, s, n)) return e;
+    }
+    return NULL;
+}
+
+const Atom::Entry * Atom::Intern(const char * s, size_t n) {
+    if (n == 0) return NULL;
+
+    const size_t h = Hash(s, n);
+    Entry * volatile * bucket = reinterpret_cast<Entry * volatile *>(&gTable[h & (NBUCKETS - 1)]);
+    Entry * head = ABE_ATOMIC_LOAD(bucket);
+    Entry * until = NULL;
+    Entry * entry = NULL;
+    for (;;) {
+        // only entries after last look up are new
+        for (Entry * e = head; e != until; e = e->mNext) {
+            if (e->mHash == h && e->mSize == n && !memcmp(e->mString, s, n)) {
+                if (entry) free(entry);
+                return e;
+            }
+        }
+
+        if (entry == NULL) {
+            entry = static_cast<Entry *>(malloc(sizeof(Entry) + n));
+            CHECK_NULL(entry);
+            entry->mId      = ABE_ATOMIC_ADD(&gAtoms, 1);
+            entry->mHash    = h;
+            entry->mSize    = n;
+            memcpy(entry->mString, s, n);
+            entry->mString[n] = '\0';
+        }
+
+        entry->mNext = head;
+        until = head;
+        // head is updated if failed
+        if (ABE_ATOMIC_CAS(bucket, &head, entry)) return entry;
+    }
+}
+
+__END_NAMESPACE_ABE
@@ -0,0 +1,109 @@
+/******************************************************************************
+ * Copyright (c) 2018, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    Atom.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181203     initial version
+//
+
+#ifndef ABE_HEADERS_ATOM_H
+#define ABE_HEADERS_ATOM_H
+
+#include <ABE/core/Types.h>
+#include <ABE/core/String.h>
+#include <ABE/core/StringView.h>
+
+__BEGIN_NAMESPACE_ABE
+
+/**
+ * an interned string.
+ * atoms with same contents share one entry in a global lock free table,
+ * so copy, compare and hash are O(1). for hot keys, like Message keys.
+ * @note entries are never freed, don't make atoms from arbitrary data.
+ * @note make constant keys static, e.g. static const Atom kWidth("width");
+ */
+class ABE_EXPORT Atom : public NonSharedObject {
+    public:
+        /**
+         * empty atom, same as Atom("")
+         */
+        ABE_INLINE Atom() : mEntry(NULL) { }
+        /**
+         * intern a string, lock free, no allocation if exists
+         * @param s     pointer to a c-style string
+         * @param n     length of that string excluding terminating null
+         */
+        Atom(const char * s, size_t n = 0);
+        Atom(const String& s);
+        Atom(const StringView& s);
+
+        /**
+         * look up an interned string, never intern it.
+         * @return empty atom if not exists
+         */
+        static Atom Find(const char * s, size_t n = 0);
+        static Atom Find(const String& s);
+        static Atom Find(const StringView& s);
+
+        ABE_INLINE Atom(const Atom& rhs) : mEntry(rhs.mEntry) { }
+        ABE_INLINE Atom& operator=(const Atom& rhs)   { mEntry = rhs.mEntry; return *this;                 }
+
+    public:
+        ABE_INLINE const char * c_str() const   { return mEntry ? mEntry->mString : "";                 }
+        ABE_INLINE size_t       size() const    { return mEntry ? mEntry->mSize : 0;                    }
+        ABE_INLINE bool         empty() const   { return mEntry == NULL;                                }
+        ABE_INLINE String       string() const  { return mEntry ? String(mEntry->mString, mEntry->mSize) : String(""); }
+        /**
+         * unique id of this atom, 0 for empty atom
+         */
+        ABE_INLINE size_t       id() const      { return mEntry ? mEntry->mId : 0;                      }
+        ABE_INLINE size_t       hash() const    { return id();                                          }
+
+    public:
+        ABE_INLINE bool operator==(const Atom& rhs) const   { return mEntry == rhs.mEntry;              }
+        ABE_INLINE bool operator!=(const Atom& rhs) const   { return mEntry != rhs.mEntry;              }
+        ABE_INLINE bool operator<(const Atom& rhs) const    { return id() < rhs.id();                   }
+
+    private:
+        struct Entry {
+            Entry *         mNext;
+            size_t          mId;
+            size_t          mHash;
+            size_t          mSize;
+            char            mString[1];
+        };
+        static const Entry *    Intern(const char * s, size_t n);
+        static const Entry *    Lookup(const char * s, size_t n);
+
+        const Entry *   mEntry;
+};
+
+__END_NAMESPACE_ABE
+
+#endif // ABE_HEADERS_ATOM_H
@@ -36,9 +36,14 @@
 //#define LOG_NDEBUG 0
 #include "ABE/core/Log.h"
 #include "Buffer.h"
+#include "Config.h"
 
 #include <string.h> // strlen
 #include <ctype.h>  // isprint
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define MIN(a, b)   (a) > (b) ? (b) : (a)
 
@@ -80,52 +85,171 @@ static String hexdump(const void *data, uint32_t bytes) {
     return result;
 }
 
+// Ring buffer maps the same pages twice back to back, so ready bytes
+// are always contiguous, and rewind is index arithmetic only.
+// length is rounded up to pages, return NULL if not supported.
+static char * MapMirror(size_t& length) {
+#if HAVE_MEMFD_CREATE
+    const size_t page = sysconf(_SC_PAGESIZE);
+    length = (length + page - 1) & ~(page - 1);
+
+    int fd = memfd_create("ABE::Buffer", MFD_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    char * base = NULL;
+    if (ftruncate(fd, length) == 0) {
+        // reserve address space for both halves, then map over it
+        void * p = mmap(NULL, length * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+            base = static_cast<char *>(p);
+            const int prot = PROT_READ | PROT_WRITE;
+            if (mmap(base, length, prot, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+                    mmap(base + length, length, prot, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                munmap(base, length * 2);
+                base = NULL;
+            }
+        }
+    }
+    close(fd);  // pages are held by the mappings
+    if (base == NULL) {
+        INFO("mirrored mapping failed, fall back to allocator");
+    }
+    return base;
+#else
+    return NULL;
+#endif
+}
+
+static void UnmapMirror(char * base, size_t length) {
+#if HAVE_MEMFD_CREATE
+    CHECK_EQ(munmap(base, length * 2), 0);
+#endif
+}
+
+// backend memory, shared by a buffer and its slices
+struct Buffer::Storage : public SharedObject {
+    sp<Allocator>   mAllocator;
+    char *          mData;
+    size_t          mMirror;    // length of mirrored mapping, 0 if not mirrored
+
+    // mirror Ring buffer only with default allocator, custom allocators
+    // still get twice memory from themselves.
+    Storage(const sp<Allocator>& allocator, size_t capacity, eBufferType type) :
+        SharedObject(), mAllocator(allocator), mData(NULL), mMirror(0)
+    {
+        if (type == Ring && mAllocator.get() == kAllocatorDefault.get()) {
+            size_t length = capacity;
+            mData = MapMirror(length);
+            if (mData) {
+                mMirror = length;
+                return;
+            }
+        }
+
+        if (type == Ring) capacity <<= 1;
+        mData = (char *)mAllocator->allocate(capacity);
+        CHECK_NULL(mData);
+    }
+
+    virtual ~Storage() {
+        if (mMirror) UnmapMirror(mData, mMirror);
+        else mAllocator->deallocate(mData);
+    }
+};
+
 ///////////////////////////////////////////////////////////////////////////
 Buffer::Buffer(size_t capacity, const sp<Allocator>& allocator) : SharedObject(OBJECT_ID_BUFFER),
-    mAllocator(allocator),
     mData(NULL), mCapacity(capacity),
     mType(Linear), mReadPos(0), mWritePos(0)
 {
     CHECK_GT(mCapacity, 0);
-    _alloc();
+    _alloc(allocator);
 }
 
 Buffer::Buffer(size_t capacity, eBufferType type, const sp<Allocator>& allocator) : SharedObject(OBJECT_ID_BUFFER),
-    mAllocator(allocator),
     mData(NULL), mCapacity(capacity),
     mType(type), mReadPos(0), mWritePos(0)
 {
     CHECK_GT(mCapacity, 0);
-    _alloc();
+    _alloc(allocator);
 }
 
 Buffer::Buffer(const char *s, size_t n, eBufferType type, const sp<Allocator>& allocator) : SharedObject(OBJECT_ID_BUFFER),
-    mAllocator(allocator),
     mData(NULL), mCapacity(n ? n : strlen(s)),
     mType(type), mReadPos(0), mWritePos(0)
 {
     CHECK_GT(mCapacity, 0);
-    _alloc();
-    memcpy(mData, s, n);
-    mWritePos += n;
+    _alloc(allocator);
+    memcpy(mData, s, mCapacity);
+    mWritePos += mCapacity;
+}
+
+// a slice of n bytes, shares storage with its source
+Buffer::Buffer(const sp<Storage>& storage, char * data, size_t n) : SharedObject(OBJECT_ID_BUFFER),
+    mStorage(storage), mData(data), mCapacity(n),
+    mType(Linear), mReadPos(0), mWritePos(n)
+{
 }
 
-void Buffer::_alloc() {
-    size_t allocLength = mCapacity;
-    if (mType == Ring) allocLength <<= 1;
-    mData = (char *)mAllocator->allocate(allocLength);
-    CHECK_NULL(mData);
+void Buffer::_alloc(const sp<Allocator>& allocator) {
+    mStorage    = new Storage(allocator, mCapacity, mType);
+    mData       = mStorage->mData;
 }
 
 Buffer::~Buffer() {
-    if (mData) mAllocator->deallocate(mData);
+}
+
+// bytes before write pos may be shared with slices, copy them before
+// modify. bytes after write pos are never shared, so write() is free.
+void Buffer::_edit() {
+    if (mStorage->IsObjectNotShared()) return;
+
+    sp<Storage> storage = new Storage(mStorage->mAllocator, mCapacity, mType);
+    memcpy(storage->mData + mReadPos, mData + mReadPos, ready());
+    mStorage    = storage;
+    mData       = storage->mData;
+}
+
+char * Buffer::edit() {
+    _edit();
+    return data();
+}
+
+void Buffer::reset() {
+    if (mStorage->IsObjectShared()) {
+        // bytes are dropped, no copy
+        mStorage    = new Storage(mStorage->mAllocator, mCapacity, mType);
+        mData       = mStorage->mData;
+    }
+    mReadPos = mWritePos = 0;
 }
 
 int Buffer::resize(size_t cap) {
-    size_t allocLength = cap;
-    if (mType == Ring) allocLength <<= 1;
-    mData = (char *)mAllocator->reallocate(mData, allocLength);
-    mCapacity = cap;
+    if (mStorage->IsObjectNotShared() && !mStorage->mMirror && mData == mStorage->mData) {
+        size_t allocLength = cap;
+        if (mType == Ring) allocLength <<= 1;
+        mStorage->mData = (char *)mStorage->mAllocator->reallocate(mStorage->mData, allocLength);
+        mData       = mStorage->mData;
+        mCapacity   = cap;
+        return 0;
+    }
+
+    // shared, a slice or mirrored: new storage
+    sp<Storage> storage = new Storage(mStorage->mAllocator, cap, mType);
+    if (mType == Ring) {
+        // move ready bytes to the front
+        const size_t n = ready() < cap ? ready() : cap;
+        memcpy(storage->mData, mData + mReadPos, n);
+        mReadPos    = 0;
+        mWritePos   = n;
+    } else {
+        if (mWritePos > cap) mWritePos = cap;
+        if (mReadPos > mWritePos) mReadPos = mWritePos;
+        memcpy(storage->mData, mData, mWritePos);
+    }
+    mStorage    = storage;
+    mData       = storage->mData;
+    mCapacity   = cap;
     return 0;
 }
 
@@ -172,6 +296,7 @@ void Buffer::replace(size_t pos, int c, size_t n) {
     CHECK_GT(n, 0);
     CHECK_LT(pos, ready());
     CHECK_LE(pos + n, ready() + empty());
+    _edit();
 
     memset(mData + mReadPos + pos, c, n);
 }
@@ -179,6 +304,7 @@ void Buffer::replace(size_t pos, int c, size_t n) {
 void Buffer::replace(size_t pos, const char *s, size_t n) {
     CHECK_LT(pos, ready());
     CHECK_LE(pos + n, ready() + empty());
+    _edit();
 
     if (!n)     n = strlen(s);
     memcpy(mData + mReadPos + pos, s, n);
@@ -190,7 +316,7 @@ size_t Buffer::read(char *buf, size_t n) {
 
     n = MIN(n, ready());
 
-    memcpy(buf, data(), n);
+    memcpy(buf, mData + mReadPos, n);
     mReadPos    += n;
 
     _rewind();
@@ -201,7 +327,7 @@ sp<Buffer> Buffer::read(size_t n) {
     CHECK_GT(n, 0);
     if (ready() == 0) return NULL;
     n = MIN(n, ready());
-    sp<Buffer> buf = new Buffer(data(), n);
+    sp<Buffer> buf = split(0, n);
     mReadPos += n;
     _rewind();
     return buf;
@@ -225,9 +351,13 @@ void Buffer::step(size_t n) {
     _rewind();
 }
 
+// Ring buffer overwrites its bytes all the time, so copy
 sp<Buffer> Buffer::split(size_t pos, size_t n) const {
     CHECK_GT(n, 0);
     CHECK_LE(pos + n, ready());
+    if (mType == Linear) {
+        return new Buffer(mStorage, mData + mReadPos + pos, n);
+    }
     sp<Buffer> buf = new Buffer(n);
     buf->write(data() + pos, n);
     return buf;
@@ -259,9 +389,16 @@ void Buffer::_rewind() {
         if (ready() == 0) {
             // the easy rewind time 
             reset();
+        } else if (mStorage->mMirror) {
+            // same bytes one mirror length before
+            const size_t mirror = mStorage->mMirror;
+            if (mReadPos >= mirror) {
+                mReadPos    -= mirror;
+                mWritePos   -= mirror;
+            }
         } else if (mReadPos >= capacity()) {
             // read pos >= threshold
-            memmove(mData, data(), ready());
+            memmove(mData, mData + mReadPos, ready());
             mWritePos   -= mReadPos;
             mReadPos    = 0;
         }
@@ -53,12 +53,17 @@ __BEGIN_NAMESPACE_ABE
  *      read pos
  *
  * Buffer is not thread safe
+ *
+ * split() & read() of a Linear buffer return slices sharing storage with
+ * it, no bytes are copied. edit(), replace() & resize() copy on write,
+ * write() never touches bytes of slices.
+ * @note data() & operator[] never copy, modify bytes through edit().
  */
 class ABE_EXPORT Buffer : public SharedObject {
     public:
         enum eBufferType {
             Linear,             ///< linear buffer
-            Ring,               ///< implement ring buffer, take twice memory as it need
+            Ring,               ///< implement ring buffer, read & write are always contiguous
             Default = Linear
         };
     
@@ -107,7 +112,12 @@ class ABE_EXPORT Buffer : public SharedObject {
         /**
          * reset read & write position of this buffer
          */
-        ABE_INLINE void         reset() { mReadPos = mWritePos = 0; }
+        void                    reset();
+
+        /**
+         * get data() for modify, bytes are copied if shared with slices
+         */
+        char *                  edit();
 
         /**
          * resize this buffer's backend memory
@@ -134,7 +144,7 @@ class ABE_EXPORT Buffer : public SharedObject {
         ABE_INLINE size_t   size() const { return ready(); } ///<  alias for ready()
     
         size_t              read(char *buf, size_t n);
-        sp<Buffer>          read(size_t n);
+        sp<Buffer>          read(size_t n);     ///< same as split(0, n) and skip(n)
 
         // move read pointer forward
         void                skip(size_t n);
@@ -157,6 +167,10 @@ class ABE_EXPORT Buffer : public SharedObject {
         ABE_INLINE void     replace(const Buffer& s, size_t n = 0) { replace(0, s, n); }
 
     public:
+        /**
+         * get a slice of size bytes from pos
+         * @note Linear buffer shares storage with the slice, Ring buffer copies
+         */
         sp<Buffer>          split(size_t pos, size_t size) const;
 
     public:
@@ -180,13 +194,15 @@ class ABE_EXPORT Buffer : public SharedObject {
         ABE_INLINE ssize_t  indexOf(const Buffer& s, size_t n = 0) const { return indexOf(0, s, n); }
 
     private:
+        struct Storage;
+        Buffer(const sp<Storage>&, char *, size_t);
         void                _rewind();
-        void                _alloc();
+        void                _alloc(const sp<Allocator>&);
+        void                _edit();
 
     private:
-        // backend memory provider
-        sp<Allocator>       mAllocator;
-        char *              mData;
+        sp<Storage>         mStorage;   // backend memory, shared with slices
+        char *              mData;      // begin of this buffer in storage
         size_t              mCapacity;
         const eBufferType   mType;
         size_t              mReadPos;
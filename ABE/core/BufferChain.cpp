@@ -0,0 +1,188 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+
+// File:    BufferChain.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20190105     initial version
+//
+
+#define LOG_TAG "BufferChain"
+#include "Log.h"
+#include "BufferChain.h"
+
+#include <string.h>
+
+#define MIN(a, b)   ((a) > (b) ? (b) : (a))
+
+__BEGIN_NAMESPACE_ABE
+
+BufferChain::BufferChain() : SharedObject(), mSize(0) { }
+
+void BufferChain::clear() {
+    mSlices.clear();
+    mSize = 0;
+}
+
+void BufferChain::append(const sp<Buffer>& buffer, size_t pos, size_t n) {
+    CHECK_FALSE(buffer.isNIL());
+    CHECK_LE(pos, buffer->ready());
+    if (n == 0) n = buffer->ready() - pos;
+    CHECK_LE(pos + n, buffer->ready());
+    if (n == 0) return;
+
+    mSlices.push_back(Slice(buffer->split(pos, n)));
+    mSize += n;
+}
+
+void BufferChain::prepend(const sp<Buffer>& buffer, size_t pos, size_t n) {
+    CHECK_FALSE(buffer.isNIL());
+    CHECK_LE(pos, buffer->ready());
+    if (n == 0) n = buffer->ready() - pos;
+    CHECK_LE(pos + n, buffer->ready());
+    if (n == 0) return;
+
+    mSlices.push_front(Slice(buffer->split(pos, n)));
+    mSize += n;
+}
+
+void BufferChain::append(const BufferChain& chain) {
+    CHECK_TRUE(&chain != this);
+    List<Slice>::const_iterator it = chain.mSlices.cbegin();
+    for (; it != chain.mSlices.cend(); ++it) {
+        mSlices.push_back(*it);
+    }
+    mSize += chain.mSize;
+}
+
+void BufferChain::prepend(const BufferChain& chain) {
+    CHECK_TRUE(&chain != this);
+    List<Slice>::const_iterator it = chain.mSlices.crbegin();
+    for (; it != chain.mSlices.crend(); --it) {
+        mSlices.push_front(*it);
+    }
+    mSize += chain.mSize;
+}
+
+size_t BufferChain::read(char * buf, size_t n) {
+    n = MIN(n, mSize);
+    size_t m = peek(buf, n);
+    if (m) skip(m);
+    return m;
+}
+
+size_t BufferChain::read(BufferChain& chain, size_t n) {
+    CHECK_TRUE(&chain != this);
+    n = MIN(n, mSize);
+    size_t remains = n;
+    while (remains) {
+        Slice& first = mSlices.front();
+        if (first.mLength <= remains) {
+            // move whole slice
+            chain.mSlices.push_back(first);
+            chain.mSize += first.mLength;
+            remains     -= first.mLength;
+            mSize       -= first.mLength;
+            mSlices.pop_front();
+        } else {
+            // split slice, both share the buffer
+            chain.mSlices.push_back(Slice(first.mBuffer, first.mData, remains));
+            chain.mSize     += remains;
+            first.mData     += remains;
+            first.mLength   -= remains;
+            mSize           -= remains;
+            remains         = 0;
+        }
+    }
+    return n;
+}
+
+void BufferChain::skip(size_t n) {
+    CHECK_LE(n, mSize);
+    mSize -= n;
+    while (n) {
+        Slice& first = mSlices.front();
+        if (first.mLength <= n) {
+            n -= first.mLength;
+            mSlices.pop_front();
+        } else {
+            first.mData     += n;
+            first.mLength   -= n;
+            n               = 0;
+        }
+    }
+}
+
+size_t BufferChain::peek(char * buf, size_t n, size_t offset) const {
+    if (offset >= mSize) return 0;
+    n = MIN(n, mSize - offset);
+
+    size_t copied = 0;
+    List<Slice>::const_iterator it = mSlices.cbegin();
+    for (; it != mSlices.cend() && copied < n; ++it) {
+        if (offset >= it->mLength) {
+            offset -= it->mLength;
+            continue;
+        }
+        const size_t m = MIN(it->mLength - offset, n - copied);
+        memcpy(buf + copied, it->mData + offset, m);
+        copied  += m;
+        offset  = 0;
+    }
+    return copied;
+}
+
+sp<Buffer> BufferChain::flatten() const {
+    if (mSize == 0) return NULL;
+    sp<Buffer> buffer = new Buffer(mSize);
+    List<Slice>::const_iterator it = mSlices.cbegin();
+    for (; it != mSlices.cend(); ++it) {
+        buffer->write(it->mData, it->mLength);
+    }
+    return buffer;
+}
+
+size_t BufferChain::toIovec(struct iovec * iov, size_t count, size_t offset) const {
+    size_t i = 0;
+    List<Slice>::const_iterator it = mSlices.cbegin();
+    for (; it != mSlices.cend() && i < count; ++it) {
+        if (offset >= it->mLength) {
+            offset -= it->mLength;
+            continue;
+        }
+        iov[i].iov_base = (void *)(it->mData + offset);
+        iov[i].iov_len  = it->mLength - offset;
+        ++i;
+        offset = 0;
+    }
+    return i;
+}
+
+__END_NAMESPACE_ABE
@@ -0,0 +1,162 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+
+// File:    BufferChain.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20190105     initial version
+//
+
+#ifndef ABE_HEADERS_BUFFERCHAIN_H
+#define ABE_HEADERS_BUFFERCHAIN_H
+
+#include <ABE/core/Types.h>
+#include <ABE/core/Buffer.h>
+#include <ABE/core/StringView.h>
+#include <ABE/stl/List.h>
+
+#include <sys/uio.h>    // iovec
+
+__BEGIN_NAMESPACE_ABE
+
+/**
+ * scatter gather list of Buffer slices, for framing without copy.
+ * append & prepend take slices of a Buffer, which share its storage,
+ * so packet headers can be put in front of payloads in O(1).
+ * later writes to the Buffer copy on write, the chain never sees them.
+ * read from the front crosses slices, consumed slices are released.
+ * write to Content with vectored io, or parse with BitReader.
+ * @note slices of a Ring buffer are copies, @see Buffer::split().
+ * @note not thread safe
+ */
+class ABE_EXPORT BufferChain : public SharedObject {
+    private:
+        struct Slice {
+            sp<Buffer>      mBuffer;
+            const char *    mData;
+            size_t          mLength;
+
+            ABE_INLINE Slice(const sp<Buffer>& buffer) :
+                mBuffer(buffer), mData(buffer->data()), mLength(buffer->size()) { }
+            ABE_INLINE Slice(const sp<Buffer>& buffer, const char * data, size_t length) :
+                mBuffer(buffer), mData(data), mLength(length) { }
+        };
+
+    public:
+        // iterate slices in order
+        class const_iterator {
+            public:
+                ABE_INLINE const_iterator() { }
+                ABE_INLINE const_iterator(List<Slice>::const_iterator it) : mIt(it) { }
+                ABE_INLINE const_iterator& operator++()     { ++mIt; return *this;                          }
+                ABE_INLINE StringView operator*()           { return StringView(mIt->mData, mIt->mLength);  }
+                ABE_INLINE bool operator==(const const_iterator& rhs) const { return mIt == rhs.mIt;        }
+                ABE_INLINE bool operator!=(const const_iterator& rhs) const { return mIt != rhs.mIt;        }
+
+            private:
+                List<Slice>::const_iterator mIt;
+        };
+
+    public:
+        BufferChain();
+        ~BufferChain() { }
+
+    public:
+        ABE_INLINE size_t   size() const            { return mSize;             }
+        ABE_INLINE bool     empty() const           { return mSize == 0;        }
+        ABE_INLINE size_t   slices() const          { return mSlices.size();    }
+        void                clear();
+
+        ABE_INLINE const_iterator cbegin() const    { return const_iterator(mSlices.cbegin());  }
+        ABE_INLINE const_iterator cend() const      { return const_iterator(mSlices.cend());    }
+
+    public:
+        /**
+         * slice n ready bytes of buffer from pos, or to the end if n is 0
+         */
+        void                append(const sp<Buffer>& buffer, size_t pos = 0, size_t n = 0);
+        void                prepend(const sp<Buffer>& buffer, size_t pos = 0, size_t n = 0);
+
+        /**
+         * reference all slices of another chain
+         */
+        void                append(const BufferChain& chain);
+        void                prepend(const BufferChain& chain);
+
+    public:
+        /**
+         * copy n bytes at most from the front and step
+         * @return return bytes read
+         */
+        size_t              read(char * buf, size_t n);
+
+        /**
+         * move n bytes at most from the front to the end of chain, no copy
+         * @return return bytes moved
+         */
+        size_t              read(BufferChain& chain, size_t n);
+
+        /**
+         * drop n bytes from the front
+         */
+        void                skip(size_t n);
+
+        /**
+         * copy n bytes at most from offset without step
+         * @return return bytes copied
+         */
+        size_t              peek(char * buf, size_t n, size_t offset = 0) const;
+
+        /**
+         * copy all bytes into one Buffer
+         */
+        sp<Buffer>          flatten() const;
+
+        /**
+         * fill iovec with slices from byte offset, for writev only
+         * @param iov       array of iovec
+         * @param count     max number of iovec
+         * @param offset    skip bytes in front, e.g. after a short write
+         * @return return number of iovec filled
+         * @note slices share bytes with other buffers, never readv into
+         *       iov, read into Buffer::edit() and append it instead.
+         */
+        size_t              toIovec(struct iovec * iov, size_t count, size_t offset = 0) const;
+
+    private:
+        List<Slice>         mSlices;
+        size_t              mSize;
+
+    DISALLOW_EVILS(BufferChain);
+};
+
+__END_NAMESPACE_ABE
+
+#endif // ABE_HEADERS_BUFFERCHAIN_H
@@ -36,6 +36,8 @@
 //#define LOG_NDEBUG 0
 #include "Log.h"
 #include "Content.h"
+#include "Cord.h"
+#include "BufferChain.h"
 
 #include <string.h>  // memcpy
 
@@ -108,12 +110,32 @@ bool Content::writeBlockBack() {
     return true;
 }
 
+size_t Content::Protocol::writevBytes(const struct iovec * iov, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t n = writeBytes(iov[i].iov_base, iov[i].iov_len);
+        total += n;
+        if (n < iov[i].iov_len) break;
+    }
+    return total;
+}
+
+size_t Content::Protocol::readvBytes(const struct iovec * iov, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t n = readBytes(iov[i].iov_base, iov[i].iov_len);
+        total += n;
+        if (n < iov[i].iov_len) break;
+    }
+    return total;
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // static
-sp<Content::Protocol> CreateFile(const String& url, Content::eMode mode);
+sp<Content::Protocol> CreateFile(const StringView& url, Content::eMode mode);
 
-sp<Content> Content::Create(const String& url, eMode mode) {
-    INFO("Open content %s", url.c_str());
+sp<Content> Content::Create(const StringView& url, eMode mode) {
+    INFO("Open content %.*s", (int)url.size(), url.data());
 
     sp<Protocol> proto;
     if (url.startsWithIgnoreCase("file://") || 
@@ -126,7 +148,7 @@ sp<Content> Content::Create(const String& url, eMode mode) {
     }
 
     if (proto.isNIL()) {
-        ERROR("unsupported url %s", url.c_str());
+        ERROR("unsupported url %.*s", (int)url.size(), url.data());
         return NULL;
     }
 
@@ -157,36 +179,80 @@ sp<Buffer> Content::read(size_t size) {
 
     sp<Buffer> data = new Buffer(size);
 
-    //bool eof = false;
-    size_t n = size;
+    struct iovec iov;
+    iov.iov_base    = data->data();
+    iov.iov_len     = size;
+    const size_t n  = read(&iov, 1);
 
-    while (n > 0) {
-        size_t remains = mBlock->ready() - mBlockOffset;
-        char *s = mBlock->data() + mBlockOffset;
-        if (remains > 0) {
-            size_t m = MIN(remains, n);
-            //DEBUG("read %d bytes from cache.", m);
+    if (!n) return NULL;
 
-            data->write(s, m);
+    data->step(n);
+    //DEBUG("%s", PRINTABLE(data->string()));
 
-            mBlockOffset  += m;
-            n -= m;
-        } else {
-            // TODO: read directly from protocol 
-            if (readBlock() == false) {
-                //eof = true;
-                break;
-            }
-        } 
+    return data;
+}
+
+size_t Content::read(const struct iovec * iov, size_t count) {
+    CHECK_TRUE(mode() & Read);
+
+    size_t wanted = 0;
+    for (size_t i = 0; i < count; ++i) wanted += iov[i].iov_len;
+
+    size_t total    = 0;
+    size_t offset   = 0;    // bytes filled in iov[0]
+    while (wanted) {
+        size_t remains = mBlock->ready() - mBlockOffset;
+        if (remains == 0) {
+            // large read goes to protocol directly
+            if (wanted >= mBlock->capacity()) break;
+            if (readBlock() == false) return total;
+            continue;
+        }
+
+        const size_t m = MIN(remains, iov->iov_len - offset);
+        memcpy((char *)iov->iov_base + offset, mBlock->data() + mBlockOffset, m);
+        mBlockOffset    += m;
+        offset          += m;
+        total           += m;
+        wanted          -= m;
+        if (offset == iov->iov_len) {
+            ++iov;
+            --count;
+            offset = 0;
+        }
     }
+    if (wanted == 0) return total;
 
-    n               = size - n;
+    // cache is consumed, drop it
+    writeBlockBack();
 
-    if (!n) return NULL;
+    enum { kMaxVectors = 64 };
+    struct iovec vec[kMaxVectors];
+    while (count) {
+        size_t n = 0;
+        size_t bytes = 0;
+        for (; n < kMaxVectors && n < count; ++n) {
+            vec[n].iov_base = (char *)iov[n].iov_base + offset;
+            vec[n].iov_len  = iov[n].iov_len - offset;
+            bytes   += vec[n].iov_len;
+            offset  = 0;
+        }
 
-    //DEBUG("%s", PRINTABLE(data->string()));
+        const size_t m = mProto->readvBytes(vec, n);
+        mPosition   += m;
+        total       += m;
+        if (m < bytes) break;
+        iov     += n;
+        count   -= n;
+    }
+    return total;
+}
 
-    return data;
+size_t Content::read(BufferChain& chain, size_t size) {
+    sp<Buffer> data = read(size);
+    if (data.isNIL()) return 0;
+    chain.append(data);
+    return data->size();
 }
 
 size_t Content::write(const char *data, size_t size) {
@@ -214,6 +280,65 @@ size_t Content::write(const char *data, size_t size) {
     return size - n;
 }
 
+size_t Content::write(const struct iovec * iov, size_t count) {
+    CHECK_TRUE(mode() & Write);
+    CHECK_FALSE(mode() & Read);
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) total += iov[i].iov_len;
+
+    if (total <= mBlock->empty() - mBlockOffset) {
+        for (size_t i = 0; i < count; ++i) {
+            write((const char *)iov[i].iov_base, iov[i].iov_len);
+        }
+        return total;
+    }
+
+    // keep order: cached bytes first
+    writeBlockBack();
+    const size_t n = mProto->writevBytes(iov, count);
+    mPosition += n;
+    return n;
+}
+
+size_t Content::write(const Cord& cord) {
+    enum { kMaxVectors = 64 };
+    struct iovec iov[kMaxVectors];
+    size_t count = 0;
+    size_t expected = 0;
+    size_t total = 0;
+    for (Cord::const_iterator it = cord.cbegin(); it != cord.cend(); ++it) {
+        const StringView chunk = *it;
+        iov[count].iov_base = (void *)chunk.data();
+        iov[count].iov_len  = chunk.size();
+        expected += chunk.size();
+        if (++count == kMaxVectors) {
+            const size_t n = write(iov, count);
+            total += n;
+            if (n < expected) return total;
+            count = expected = 0;
+        }
+    }
+    if (count) total += write(iov, count);
+    return total;
+}
+
+size_t Content::write(const BufferChain& chain) {
+    enum { kMaxVectors = 64 };
+    struct iovec iov[kMaxVectors];
+    size_t total = 0;
+    while (total < chain.size()) {
+        const size_t count = chain.toIovec(iov, kMaxVectors, total);
+        size_t expected = 0;
+        for (size_t i = 0; i < count; ++i) expected += iov[i].iov_len;
+
+        const size_t n = write(iov, count);
+        total += n;
+        if (n < expected) break;
+    }
+    return total;
+}
+
 int64_t Content::seek(int64_t offset) {
     DEBUG("real offset %" PRId64 ", cache offset %" PRId64 ", seek to %" PRId64, 
             mPosition,
@@ -38,10 +38,16 @@
 
 #include <ABE/core/Types.h>
 #include <ABE/core/Buffer.h>
+#include <ABE/core/StringView.h>
 #include <ABE/tools/Bits.h>
 
+#include <sys/uio.h>    // iovec
+
 __BEGIN_NAMESPACE_ABE
 
+class Cord;
+class BufferChain;
+
 
 /**
  * a content manager
@@ -82,6 +88,24 @@ class ABE_EXPORT Content : public SharedObject {
              * @return return bytes written, otherwise return 0
              */
             virtual size_t  writeBytes(const void * buffer, size_t length) = 0;
+
+            /**
+             * write bytes from multiple buffers, like writev
+             * @param iov   array of buffers
+             * @param count number of buffers
+             * @return return bytes written, otherwise return 0
+             * @note default implementation calls writeBytes one by one
+             */
+            virtual size_t  writevBytes(const struct iovec * iov, size_t count);
+
+            /**
+             * read bytes into multiple buffers, like readv
+             * @param iov   array of buffers
+             * @param count number of buffers
+             * @return return bytes read, otherwise return 0 on eos or error
+             * @note default implementation calls readBytes one by one
+             */
+            virtual size_t  readvBytes(const struct iovec * iov, size_t count);
             
             /**
              * get total bytes of the protocol
@@ -109,7 +133,7 @@ class ABE_EXPORT Content : public SharedObject {
          * @param mode mode of the content object
          * @return return a new content object
          */
-        static sp<Content> Create(const String& url, eMode mode = Default);
+        static sp<Content> Create(const StringView& url, eMode mode = Default);
 
         /**
          * create a content object with custom protocol
@@ -162,6 +186,19 @@ class ABE_EXPORT Content : public SharedObject {
          */
         sp<Buffer>  read(size_t size);
 
+        /**
+         * read bytes into multiple buffers, small reads go through
+         * the cache, large ones go to the protocol in one call.
+         * @return bytes read
+         */
+        size_t          read(const struct iovec * iov, size_t count);
+
+        /**
+         * read bytes and append to chain
+         * @return bytes read
+         */
+        size_t          read(BufferChain& chain, size_t size);
+
         /**
          * write bytes to content
          * @return
@@ -172,6 +209,23 @@ class ABE_EXPORT Content : public SharedObject {
             return write(buffer->data(), buffer->size());
         }
 
+        /**
+         * write bytes from multiple buffers, small writes go through
+         * the cache, large ones go to the protocol in one call.
+         * @return bytes written
+         */
+        size_t          write(const struct iovec * iov, size_t count);
+
+        /**
+         * write chunks of a cord without flatten it
+         */
+        size_t          write(const Cord& cord);
+
+        /**
+         * write slices of a chain without flatten it
+         */
+        size_t          write(const BufferChain& chain);
+
     private:
         bool            readBlock();
         bool            writeBlockBack();
@@ -0,0 +1,224 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+
+// File:    Cord.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181228     initial version
+//
+
+#define LOG_TAG "Cord"
+#include "Log.h"
+#include "Cord.h"
+
+#include <string.h>
+
+#define MIN(a, b)   ((a) > (b) ? (b) : (a))
+#define MAX(a, b)   ((a) > (b) ? (a) : (b))
+
+__BEGIN_NAMESPACE_ABE
+
+// Strings longer than this are shared instead of copied
+enum { kShareLength = 512 };
+
+Cord::Piece::Piece(SharedBuffer * buffer, size_t offset, size_t length) :
+    mBuffer(buffer->RetainBuffer()), mOffset(offset), mLength(length) { }
+
+Cord::Piece::Piece(const Piece& rhs) :
+    mBuffer(rhs.mBuffer->RetainBuffer()), mOffset(rhs.mOffset), mLength(rhs.mLength) { }
+
+Cord::Piece::~Piece() {
+    mBuffer->ReleaseBuffer();
+}
+
+Cord::Piece& Cord::Piece::operator=(const Piece& rhs) {
+    SharedBuffer * buffer = rhs.mBuffer->RetainBuffer();
+    mBuffer->ReleaseBuffer();
+    mBuffer     = buffer;
+    mOffset     = rhs.mOffset;
+    mLength     = rhs.mLength;
+    return *this;
+}
+
+Cord::Cord() : mSize(0) { }
+
+Cord::Cord(const char * s) : mSize(0) {
+    append(s);
+}
+
+Cord::Cord(const StringView& s) : mSize(0) {
+    append(s);
+}
+
+Cord::Cord(const String& s) : mSize(0) {
+    append(s);
+}
+
+void Cord::clear() {
+    mPieces.clear();
+    mSize = 0;
+}
+
+// a chunk is written in place only if no one else holds it, so bytes
+// out of its piece are free. copies of this Cord hold the chunk too,
+// once the list is copied on write.
+Cord& Cord::append(const char * s, size_t n) {
+    if (n == 0) return *this;
+    CHECK_NULL(s);
+    mSize += n;
+
+    if (!mPieces.empty()) {
+        Piece& last = mPieces.back();
+        const size_t end = last.mOffset + last.mLength;
+        if (last.mBuffer->IsBufferNotShared() && end < last.mBuffer->size()) {
+            const size_t m = MIN(n, last.mBuffer->size() - end);
+            memcpy(last.mBuffer->data() + end, s, m);
+            last.mLength += m;
+            s += m;
+            n -= m;
+        }
+    }
+
+    if (n) {
+        // at the head of a new chunk, leave the rest for later appends
+        SharedBuffer * buffer = SharedBuffer::Create(kAllocatorDefault, MAX(n, (size_t)kChunkLength));
+        memcpy(buffer->data(), s, n);
+        mPieces.push_back(Piece(buffer, 0, n));
+        buffer->ReleaseBuffer();
+    }
+    return *this;
+}
+
+Cord& Cord::prepend(const char * s, size_t n) {
+    if (n == 0) return *this;
+    CHECK_NULL(s);
+    mSize += n;
+
+    if (!mPieces.empty()) {
+        Piece& first = mPieces.front();
+        if (first.mBuffer->IsBufferNotShared() && first.mOffset > 0) {
+            const size_t m = MIN(n, first.mOffset);
+            first.mOffset -= m;
+            first.mLength += m;
+            memcpy(first.mBuffer->data() + first.mOffset, s + n - m, m);
+            n -= m;
+        }
+    }
+
+    if (n) {
+        // at the tail of a new chunk, leave the rest for later prepends
+        const size_t length = MAX(n, (size_t)kChunkLength);
+        SharedBuffer * buffer = SharedBuffer::Create(kAllocatorDefault, length);
+        memcpy(buffer->data() + length - n, s, n);
+        mPieces.push_front(Piece(buffer, length - n, n));
+        buffer->ReleaseBuffer();
+    }
+    return *this;
+}
+
+bool Cord::share(const String& s, bool front) {
+    if (s.isInline() || s.isNull() || s.size() < (size_t)kShareLength) return false;
+    Piece piece(s.mHeap.mData, 0, s.mHeap.mSize);
+    if (front)  mPieces.push_front(piece);
+    else        mPieces.push_back(piece);
+    mSize += piece.mLength;
+    return true;
+}
+
+Cord& Cord::append(const String& s) {
+    if (!share(s, false)) append(s.c_str(), s.size());
+    return *this;
+}
+
+Cord& Cord::prepend(const String& s) {
+    if (!share(s, true)) prepend(s.c_str(), s.size());
+    return *this;
+}
+
+Cord& Cord::append(const Cord& s) {
+    if (&s == this) {
+        Cord copy(s);
+        return append(copy);
+    }
+    List<Piece>::const_iterator it = s.mPieces.cbegin();
+    for (; it != s.mPieces.cend(); ++it) {
+        mPieces.push_back(*it);
+    }
+    mSize += s.mSize;
+    return *this;
+}
+
+Cord& Cord::prepend(const Cord& s) {
+    if (&s == this) {
+        Cord copy(s);
+        return prepend(copy);
+    }
+    List<Piece>::const_iterator it = s.mPieces.crbegin();
+    for (; it != s.mPieces.crend(); --it) {
+        mPieces.push_front(*it);
+    }
+    mSize += s.mSize;
+    return *this;
+}
+
+Cord Cord::substring(size_t pos, size_t n) const {
+    CHECK_LE(pos, mSize);
+    if (n == 0 || n > mSize - pos) n = mSize - pos;
+
+    Cord result;
+    List<Piece>::const_iterator it = mPieces.cbegin();
+    for (; n && it != mPieces.cend(); ++it) {
+        const size_t length = it->mLength;
+        if (pos >= length) {
+            pos -= length;
+            continue;
+        }
+        const size_t m = MIN(length - pos, n);
+        result.mPieces.push_back(Piece(it->mBuffer, it->mOffset + pos, m));
+        result.mSize += m;
+        n -= m;
+        pos = 0;
+    }
+    return result;
+}
+
+String Cord::string() const {
+    String result("");
+    char * p = result.edit(mSize);
+    List<Piece>::const_iterator it = mPieces.cbegin();
+    for (; it != mPieces.cend(); ++it) {
+        memcpy(p, it->mBuffer->data() + it->mOffset, it->mLength);
+        p += it->mLength;
+    }
+    result.resize(mSize);
+    return result;
+}
+
+__END_NAMESPACE_ABE
@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+
+// File:    Cord.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181228     initial version
+//
+
+#ifndef ABE_HEADERS_CORD_H
+#define ABE_HEADERS_CORD_H
+
+#include <ABE/core/Types.h>
+#include <ABE/core/SharedBuffer.h>
+#include <ABE/core/String.h>
+#include <ABE/core/StringView.h>
+#include <ABE/stl/List.h>
+
+__BEGIN_NAMESPACE_ABE
+
+/**
+ * rope of shared chunks, for building large strings.
+ * append & prepend never move existing bytes, small pieces are packed
+ * into kChunkLength chunks, large Strings are shared instead of copied.
+ * copy and substring() share chunks with the source.
+ * flatten by string() once at the end, or write chunks directly to
+ * Content with vectored io.
+ * @note not thread safe
+ */
+class ABE_EXPORT Cord : public NonSharedObject {
+    private:
+        struct Piece {
+            SharedBuffer *  mBuffer;
+            size_t          mOffset;
+            size_t          mLength;
+
+            Piece(SharedBuffer * buffer, size_t offset, size_t length);
+            Piece(const Piece&);
+            ~Piece();
+            Piece& operator=(const Piece&);
+        };
+
+    public:
+        enum { kChunkLength = 4096 };
+
+        // iterate chunks in order
+        class const_iterator {
+            public:
+                ABE_INLINE const_iterator(List<Piece>::const_iterator it) : mIt(it) { }
+                ABE_INLINE const_iterator& operator++()     { ++mIt; return *this;                                      }
+                ABE_INLINE StringView operator*()           { return StringView(mIt->mBuffer->data() + mIt->mOffset, mIt->mLength); }
+                ABE_INLINE bool operator==(const const_iterator& rhs) const { return mIt == rhs.mIt;                    }
+                ABE_INLINE bool operator!=(const const_iterator& rhs) const { return mIt != rhs.mIt;                    }
+
+            private:
+                List<Piece>::const_iterator mIt;
+        };
+
+    public:
+        Cord();
+        Cord(const char * s);
+        Cord(const StringView& s);
+        Cord(const String& s);
+        ~Cord() { }
+
+    public:
+        ABE_INLINE size_t   size() const            { return mSize;             }
+        ABE_INLINE bool     empty() const           { return mSize == 0;        }
+        ABE_INLINE size_t   chunks() const          { return mPieces.size();    }
+        void                clear();
+
+        ABE_INLINE const_iterator cbegin() const    { return const_iterator(mPieces.cbegin());  }
+        ABE_INLINE const_iterator cend() const      { return const_iterator(mPieces.cend());    }
+
+    public:
+        Cord&               append(const char * s, size_t n);
+        ABE_INLINE Cord&    append(const char * s)          { return append(StringView(s));         }
+        ABE_INLINE Cord&    append(const StringView& s)     { return append(s.data(), s.size());    }
+        Cord&               append(const String& s);
+        Cord&               append(const Cord& s);
+
+        Cord&               prepend(const char * s, size_t n);
+        ABE_INLINE Cord&    prepend(const char * s)         { return prepend(StringView(s));        }
+        ABE_INLINE Cord&    prepend(const StringView& s)    { return prepend(s.data(), s.size());   }
+        Cord&               prepend(const String& s);
+        Cord&               prepend(const Cord& s);
+
+        /**
+         * n chars from pos, or to the end if n is 0, chunks are shared
+         */
+        Cord                substring(size_t pos, size_t n = 0) const;
+
+        /**
+         * flatten into a String
+         */
+        String              string() const;
+
+    private:
+        bool                share(const String& s, bool front);
+
+        List<Piece>         mPieces;
+        size_t              mSize;
+};
+
+__END_NAMESPACE_ABE
+
+#endif // ABE_HEADERS_CORD_H
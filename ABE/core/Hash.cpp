@@ -0,0 +1,144 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    Hash.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181215     initial version
+//
+
+#include "Types.h"
+#include "System.h"
+#include "Hash.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+__BEGIN_NAMESPACE_ABE
+
+// wyhash: https://github.com/wangyi-fudan/wyhash, written from scratch
+static const uint64_t kSecret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+uint64_t kHashSeed = 0x589965cc75374cc3ULL;  // constant initialized
+
+// 64 x 64 -> 128 bits multiply, a = low, b = high
+static ABE_INLINE void Mum(uint64_t * a, uint64_t * b) {
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    const uint64_t lo = t + (rm1 << 32);
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    *a = lo;
+#endif
+}
+
+// fold high & low
+static ABE_INLINE uint64_t Mix(uint64_t a, uint64_t b) {
+    Mum(&a, &b);
+    return a ^ b;
+}
+
+static ABE_INLINE uint64_t Read8(const uint8_t * p) {
+    uint64_t v; memcpy(&v, p, 8); return v;
+}
+
+static ABE_INLINE uint64_t Read4(const uint8_t * p) {
+    uint32_t v; memcpy(&v, p, 4); return v;
+}
+
+// 1 - 3 bytes
+static ABE_INLINE uint64_t Read3(const uint8_t * p, size_t n) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[n >> 1] << 8) | p[n - 1];
+}
+
+uint64_t HashBytes(const void * data, size_t n, uint64_t seed) {
+    const uint8_t * p = (const uint8_t *)data;
+    uint64_t a, b;
+    seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+    if (ABE_LIKELY(n <= 16)) {
+        if (n >= 4) {
+            // two overlapped reads of 4 bytes from each end
+            const size_t k = (n >> 3) << 2;
+            a = (Read4(p) << 32) | Read4(p + k);
+            b = (Read4(p + n - 4) << 32) | Read4(p + n - 4 - k);
+        } else if (n > 0) {
+            a = Read3(p, n);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = n;
+        if (i > 48) {
+            // three independent lanes
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed  = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+                seed1 = Mix(Read8(p + 16) ^ kSecret[2], Read8(p + 24) ^ seed1);
+                seed2 = Mix(Read8(p + 32) ^ kSecret[3], Read8(p + 40) ^ seed2);
+                p += 48; i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+            p += 16; i -= 16;
+        }
+        // last 16 bytes, may overlap
+        a = Read8(p + i - 16);
+        b = Read8(p + i - 8);
+    }
+
+    a ^= kSecret[1];
+    b ^= seed;
+    Mum(&a, &b);
+    return Mix(a ^ kSecret[0] ^ n, b ^ kSecret[1]);
+}
+
+// before any static constructor, so hashes never change after
+static __attribute__((constructor(101))) void HashSeedInit() {
+    const char * env = getenv("ABE_HASH_SEED");
+    if (env == NULL || *env == '\0') return;
+    if (!strcmp(env, "random")) {
+        uint64_t x = (uint64_t)SystemTimeEpoch() ^ ((uint64_t)getpid() << 32) ^ (uintptr_t)&env;
+        kHashSeed = HashMix(x, kSecret[2]);
+    } else {
+        kHashSeed = strtoull(env, NULL, 0);
+    }
+}
+
+__END_NAMESPACE_ABE
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    Hash.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181215     initial version
+//
+
+#ifndef ABE_HEADERS_HASH_H
+#define ABE_HEADERS_HASH_H
+
+#include <ABE/core/Types.h>
+
+__BEGIN_NAMESPACE_ABE
+
+/**
+ * per process hash seed.
+ * fixed by default, set environment ABE_HASH_SEED=random for a random
+ * seed against adversarial keys, or ABE_HASH_SEED=<number>.
+ * @note it is set before any static constructor, never changes later.
+ */
+ABE_EXPORT extern uint64_t kHashSeed;
+
+/**
+ * integer finalizer, a bijection, so distinct keys never collide
+ * and all bits of output depend on all bits of input.
+ */
+ABE_INLINE uint64_t HashMix(uint64_t x, uint64_t seed = kHashSeed) {
+    x ^= seed;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * hash of n bytes, wyhash alike, 16 bytes per step.
+ * not for cryptography.
+ */
+ABE_EXPORT uint64_t HashBytes(const void * data, size_t n, uint64_t seed = kHashSeed);
+
+__END_NAMESPACE_ABE
+
+#endif // ABE_HEADERS_HASH_H
@@ -127,8 +127,10 @@ ABE_INLINE String __MAKE_CHECK_STRING(const A& a, const B& b) {
 }
 
 __END_NAMESPACE_ABE_PRIVATE
+#endif // __cplusplus
 
-
+// print values of failed check with String, only with full hardening
+#if defined(__cplusplus) && ABE_HARDENING > 1
 #define _CHECK2(a, b, op, ...) do {                                         \
     if (__builtin_expect(!((a) op (b)), 0)) {                               \
         using __NAMESPACE_ABE::String;                                      \
@@ -144,7 +146,7 @@ __END_NAMESPACE_ABE_PRIVATE
     }                                                                       \
 } while(0)
 
-#else // __cplusplus
+#else // __cplusplus && ABE_HARDENING > 1
 // check builtin types, an print result as integer if failed.
 // the check always work, but not the print message.
 #define _CHECK2(a, b, op, ...) do {                                 \
@@ -158,7 +160,7 @@ __END_NAMESPACE_ABE_PRIVATE
                 " CHECK(" #a " " #op " " #b ") failed. ");          \
     }                                                               \
 } while(0)
-#endif // __cplusplus
+#endif // __cplusplus && ABE_HARDENING > 1
 
 #define CHECK_EQ(a, b, ...)     _CHECK2(a, b, ==, __VA_ARGS__)
 #define CHECK_NE(a, b, ...)     _CHECK2(a, b, !=, __VA_ARGS__)
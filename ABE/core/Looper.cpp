@@ -311,6 +311,7 @@ struct LooperDispatcher : public JobDispatcher {
     
     bool                            mTerminated;
     bool                            mRequestExit;
+    sp<ArenaAllocator>              mArena;     // per-job arena
 
     LooperDispatcher(Looper *lp, const String& name, eThreadType type = kThreadDefault) :
         JobDispatcher(name), mThread(this, type),
@@ -405,6 +406,8 @@ struct LooperDispatcher : public JobDispatcher {
                 job.mJob->execution();
                 mLock.lock();
                 mStat.end_profile(job);
+                // release temporary objects of this job at once
+                if (mArena != NULL) mArena->reset();
                 continue;
             }
 
@@ -511,6 +514,19 @@ void Looper::profile(int64_t interval) {
     disp->profile(interval);
 }
 
+void Looper::enableArena(size_t chunkSize) {
+    sp<LooperDispatcher> disp = mJobDisp;
+    AutoLock _l(disp->mLock);
+    if (chunkSize)  disp->mArena = new ArenaAllocator(chunkSize);
+    else            disp->mArena.clear();
+}
+
+sp<ArenaAllocator> Looper::arena() const {
+    sp<LooperDispatcher> disp = mJobDisp;
+    AutoLock _l(disp->mLock);
+    return disp->mArena;
+}
+
 void Looper::post(const sp<Job>& job, int64_t delayUs) {
     mJobDisp->queue(job, delayUs);
 }
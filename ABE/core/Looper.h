@@ -37,6 +37,7 @@
 
 #include <ABE/core/Types.h>
 #include <ABE/core/String.h>
+#include <ABE/core/Allocator.h>
 
 /**
  * thread type
@@ -254,6 +255,21 @@ class ABE_EXPORT Looper : public SharedObject {
          */
         void        profile(int64_t interval = 5 * 1000000LL);
 
+    public:
+        /**
+         * enable a per-job arena, which is reset after each job execution.
+         * @param chunkSize     chunk size of the arena, 0 to disable
+         * @note call it before post jobs.
+         */
+        void        enableArena(size_t chunkSize = 64 * 1024);
+
+        /**
+         * get the per-job arena, for temporary objects inside onJob().
+         * @return return NULL if arena is not enabled.
+         * @note objects allocated from it MUST die before onJob() return.
+         */
+        sp<ArenaAllocator> arena() const;
+
     private:
         virtual void onFirstRetain();
         virtual void onLastRetain();
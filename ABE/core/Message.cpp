@@ -35,6 +35,7 @@
 #define LOG_TAG "Message"
 #include "ABE/core/Log.h"
 #include "Message.h"
+#include "StringBuilder.h"
 #include "ABE/stl/Vector.h"
 
 #include <ctype.h>
@@ -59,9 +60,9 @@ Message::Message(uint32_t what)
 
 sp<Message> Message::dup() const {
     sp<Message> message = new Message;
-    HashTable<String, Entry>::const_iterator it = mEntries.cbegin();
+    HashTable<Atom, Entry>::const_iterator it = mEntries.cbegin();
     for (; it != mEntries.cend(); ++it) {
-        const String& name  = it.key();
+        const Atom& name  = it.key();
         Entry copy          = it.value(); // copy value
         switch (copy.mType) {
             case kTypeString:
@@ -84,7 +85,7 @@ Message::~Message() {
 }
 
 void Message::clear() {
-    HashTable<String, Entry>::iterator it = mEntries.begin();
+    HashTable<Atom, Entry>::iterator it = mEntries.begin();
     for (; it != mEntries.end(); ++it) {
         Entry &e = it.value();
         switch (e.mType) {
@@ -103,12 +104,20 @@ void Message::clear() {
     mEntries.clear();
 }
 
-bool Message::contains(const String& name) const {
-    return mEntries.find(name) != NULL;
+const Message::Entry * Message::_find(const Name& name) const {
+    return name.mExists ? mEntries.find(name.mAtom) : NULL;
 }
 
-bool Message::contains(const String &name, Type type) const {
-    const Entry *e = mEntries.find(name);
+Message::Entry * Message::_find(const Name& name) {
+    return name.mExists ? mEntries.find(name.mAtom) : NULL;
+}
+
+bool Message::contains(const Name& name) const {
+    return _find(name) != NULL;
+}
+
+bool Message::contains(const Name& name, Type type) const {
+    const Entry *e = _find(name);
     if (e != NULL && e->mType == type) {
         return true;
     }
@@ -116,7 +125,7 @@ bool Message::contains(const String &name, Type type) const {
 }
 
 #define BASIC_TYPE(NAME,FIELDNAME,TYPENAME)                                 \
-    void Message::set##NAME(const String& name, TYPENAME value) {           \
+    void Message::set##NAME(const Atom& name, TYPENAME value) {           \
         Entry e;                                                            \
         e.mType         = kType##NAME;                                      \
         e.u.FIELDNAME   = value;                                            \
@@ -125,8 +134,8 @@ bool Message::contains(const String &name, Type type) const {
         }                                                                   \
         mEntries.insert(name, e);                                           \
     }                                                                       \
-    TYPENAME Message::find##NAME(const String& name, TYPENAME def) const {  \
-        const Entry *e  = mEntries.find(name);                              \
+    TYPENAME Message::find##NAME(const Name& name, TYPENAME def) const {  \
+        const Entry *e  = _find(name);                                      \
         if (e && e->mType == kType##NAME) {                                 \
             return e->u.FIELDNAME;                                          \
         }                                                                   \
@@ -150,7 +159,7 @@ static ABE_INLINE char * strndup(const char *s, size_t len) {
 }
 #endif
 
-void Message::setString( const String& name, const char *s, size_t len) {
+void Message::setString( const Atom& name, const char *s, size_t len) {
     if (!len) len = strlen(s);
     Entry e;
     e.mType         = kTypeString;
@@ -161,15 +170,15 @@ void Message::setString( const String& name, const char *s, size_t len) {
     mEntries.insert(name, e);
 }
 
-const char * Message::findString(const String& name, const char *def) const {
-    const Entry *e = mEntries.find(name);
+const char * Message::findString(const Name& name, const char *def) const {
+    const Entry *e = _find(name);
     if (e && e->mType == kTypeString) {
         return (const char *)e->u.ptr;
     }
     return def;
 }
 
-void Message::setObject(const String &name, SharedObject *object) {
+void Message::setObject(const Atom& name, SharedObject *object) {
     Entry e;
     e.mType         = kTypeObject;
     e.u.obj         = object->RetainObject();
@@ -177,15 +186,15 @@ void Message::setObject(const String &name, SharedObject *object) {
     mEntries.insert(name, e);
 }
 
-SharedObject * Message::findObject(const String &name, SharedObject * def) const {
-    const Entry * e = mEntries.find(name);
+SharedObject * Message::findObject(const Name& name, SharedObject * def) const {
+    const Entry * e = _find(name);
     if (e && e->mType == kTypeObject) {
         return e->u.obj;
     }
     return def;
 }
 
-void Message::_setValue(const String &name, SharedObject *object) {
+void Message::_setValue(const Atom& name, SharedObject *object) {
     Entry e;
     e.mType         = kTypeValue;
     e.u.obj         = object->RetainObject();
@@ -193,15 +202,15 @@ void Message::_setValue(const String &name, SharedObject *object) {
     mEntries.insert(name, e);
 }
 
-SharedObject * Message::_findValue(const String &name) const {
-    const Entry * e = mEntries.find(name);
+SharedObject * Message::_findValue(const Name& name) const {
+    const Entry * e = _find(name);
     CHECK_NULL(e);
     CHECK_TRUE(e->mType == kTypeValue);
     return e->u.obj;
 }
 
-bool Message::remove(const String& name) {
-    Entry *e = mEntries.find(name);
+bool Message::remove(const Name& name) {
+    Entry *e = _find(name);
     if (!e) return false;
 
     switch (e->mType) {
@@ -215,75 +224,75 @@ bool Message::remove(const String& name) {
         default:
             break;
     }
-    return mEntries.erase(name);
+    return mEntries.erase(name.mAtom);
 }
 
 String Message::string() const {
-    String s = String::format("Message ");
+    StringBuilder s;
+    s.append("Message ");
 
-    String tmp;
     if (isFourcc(mWhat)) {
-        tmp = String::format(
+        s.appendFormat(
                 "'%c%c%c%c'",
                 (char)(mWhat >> 24),
                 (char)((mWhat >> 16) & 0xff),
                 (char)((mWhat >> 8) & 0xff),
                 (char)(mWhat & 0xff));
     } else {
-        tmp = String::format("0x%08x", mWhat);
+        s.appendFormat("0x%08x", mWhat);
     }
-    s.append(tmp);
 
     s.append(" = {\n");
 
-    HashTable<String, Entry>::const_iterator it = mEntries.cbegin();
+    HashTable<Atom, Entry>::const_iterator it = mEntries.cbegin();
     for (; it != mEntries.cend(); ++it) {
-        const String& name = it.key();
+        const Atom& name = it.key();
         const Entry& e = it.value();
 
+        s.append("  ");
         switch (e.mType) {
             case kTypeInt32:
                 if (isFourcc(e.u.i32))
-                    tmp = String::format("int32_t %s = '%c%c%c%c'",
+                    s.appendFormat("int32_t %s = '%c%c%c%c'",
                             name.c_str(),
                             (char)(e.u.i32 >> 24),
                             (char)((e.u.i32 >> 16) & 0xff),
                             (char)((e.u.i32 >> 8) & 0xff),
                             (char)(e.u.i32 & 0xff));
                 else
-                    tmp = String::format(
+                    s.appendFormat(
                             "int32_t %s = %d", name.c_str(), e.u.i32);
                 break;
             case kTypeInt64:
-                tmp = String::format(
+                s.appendFormat(
                         "int64_t %s = %lld", name.c_str(), e.u.i64);
                 break;
             case kTypeFloat:
-                tmp = String::format(
+                s.appendFormat(
                         "float %s = %f", name.c_str(), e.u.flt);
                 break;
             case kTypeDouble:
-                tmp = String::format(
+                s.appendFormat(
                         "double %s = %f", name.c_str(), e.u.dbl);
                 break;
             case kTypePointer:
-                tmp = String::format(
+                s.appendFormat(
                         "void *%s = %p", name.c_str(), e.u.ptr);
                 break;
             case kTypeString:
-                tmp = String::format(
+                s.appendFormat(
                         "string %s = \"%s\"",
                         name.c_str(),
                         (static_cast<const char*>(e.u.ptr)));
                 break;
             case kTypeObject:
-                tmp = String::format(
+                s.appendFormat(
                         "object %s = %p[%" PRIx32 "]", name.c_str(),
                         e.u.obj,
                         e.u.obj->GetObjectID());
                 break;
             case kTypeValue:
-                tmp = String::format(
+                s.appendFormat(
                          "value %s = %p[%" PRIx32 "]", name.c_str(),
                          e.u.obj,
                          e.u.obj->GetObjectID());
@@ -292,25 +301,22 @@ String Message::string() const {
                 FATAL("should not be here.");
                 break;
         }
-
-        s.append("  ");
-        s.append(tmp);
-        s.append("\n");
+        s.append('\n');
     }
 
     s.append("}");
 
-    return s;
+    return s.toString();
 }
 
 String Message::getEntryNameAt(size_t index, Type *type) const {
     CHECK_LT(index, countEntries());
-    HashTable<String, Entry>::const_iterator it = mEntries.cbegin();
+    HashTable<Atom, Entry>::const_iterator it = mEntries.cbegin();
     for (size_t i = 0; i < index; ++it, ++i) { }
-    const String& name = it.key();
+    const Atom& name = it.key();
     const Entry& e = it.value();
     *type = e.mType;
-    return name;
+    return name.string();
 }
 
 __END_NAMESPACE_ABE
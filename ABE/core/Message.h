@@ -37,12 +37,31 @@
 
 #include <ABE/core/Types.h>
 #include <ABE/core/String.h>
+#include <ABE/core/Atom.h>
 #include <ABE/stl/HashTable.h>
 
 #define MESSAGE_WITH_STL 1
 
 __BEGIN_NAMESPACE_ABE
+/**
+ * a key-value message, keys are atoms.
+ * only set*() intern keys, lookups never grow the atom table.
+ * @note make constant keys static atoms, which saves an intern on each call.
+ */
 class ABE_EXPORT Message : public SharedObject {
+    public:
+        /**
+         * key of lookups, strings are resolved by Atom::Find().
+         */
+        struct Name {
+            Atom    mAtom;
+            bool    mExists;    // false if the string is not interned
+            ABE_INLINE Name(const Atom& atom) : mAtom(atom), mExists(true) { }
+            ABE_INLINE Name(const char * s) : mAtom(Atom::Find(s)), mExists(!mAtom.empty() || *s == '\0') { }
+            ABE_INLINE Name(const String& s) : mAtom(Atom::Find(s)), mExists(!mAtom.empty() || s.empty()) { }
+            ABE_INLINE Name(const StringView& s) : mAtom(Atom::Find(s)), mExists(!mAtom.empty() || s.empty()) { }
+        };
+
     public:
         Message(uint32_t what = 0);
         virtual ~Message();
@@ -68,35 +87,35 @@ class ABE_EXPORT Message : public SharedObject {
         ABE_INLINE size_t      countEntries() const { return mEntries.size(); }
 
         void            clear       ();
-        bool            contains    (const String& name) const;
-        bool            remove      (const String& name);
+        bool            contains    (const Name& name) const;
+        bool            remove      (const Name& name);
         String          string      () const;
-        bool            contains    (const String& name, Type) const;
+        bool            contains    (const Name& name, Type) const;
         String          getEntryNameAt(size_t index, Type *type) const;
 
     public:
         // core types
-        void            setInt32    (const String& name, int32_t value);                    // kTypeInt32
-        void            setInt64    (const String& name, int64_t value);                    // kTypeInt64
-        void            setFloat    (const String& name, float value);                      // kTypeFloat
-        void            setDouble   (const String& name, double value);                     // kTypeDouble
-        void            setPointer  (const String& name, void *value);                      // kTypePointer
-        void            setString   (const String& name, const char *s, size_t len = 0);    // kTypeString
-        void            setObject   (const String& name, SharedObject * object);            // kTypeObject
-
-        template <class T> ABE_INLINE void setObject(const String& name, const sp<T>& o)
+        void            setInt32    (const Atom& name, int32_t value);                    // kTypeInt32
+        void            setInt64    (const Atom& name, int64_t value);                    // kTypeInt64
+        void            setFloat    (const Atom& name, float value);                      // kTypeFloat
+        void            setDouble   (const Atom& name, double value);                     // kTypeDouble
+        void            setPointer  (const Atom& name, void *value);                      // kTypePointer
+        void            setString   (const Atom& name, const char *s, size_t len = 0);    // kTypeString
+        void            setObject   (const Atom& name, SharedObject * object);            // kTypeObject
+
+        template <class T> ABE_INLINE void setObject(const Atom& name, const sp<T>& o)
         { setObject(name, static_cast<SharedObject *>(o.get())); }
 
-        int32_t         findInt32   (const String& name, int32_t def = 0) const;            // kTypeInt32
-        int64_t         findInt64   (const String& name, int64_t def = 0) const;            // kTypeInt64
-        float           findFloat   (const String& name, float def = 0) const;              // kTypeFloat
-        double          findDouble  (const String& name, double def = 0) const;             // kTypeDouble
-        void *          findPointer (const String& name, void * def = NULL) const;          // kTypePointer
-        const char *    findString  (const String& name, const char * def = NULL) const;    // kTypeString
-        SharedObject *  findObject  (const String& name, SharedObject * def = NULL) const;  // kTypeObject
+        int32_t         findInt32   (const Name& name, int32_t def = 0) const;            // kTypeInt32
+        int64_t         findInt64   (const Name& name, int64_t def = 0) const;            // kTypeInt64
+        float           findFloat   (const Name& name, float def = 0) const;              // kTypeFloat
+        double          findDouble  (const Name& name, double def = 0) const;             // kTypeDouble
+        void *          findPointer (const Name& name, void * def = NULL) const;          // kTypePointer
+        const char *    findString  (const Name& name, const char * def = NULL) const;    // kTypeString
+        SharedObject *  findObject  (const Name& name, SharedObject * def = NULL) const;  // kTypeObject
 
         // alias
-        ABE_INLINE void setString(const String& name, const String &s)
+        ABE_INLINE void setString(const Atom& name, const String &s)
         { setString(name, s.c_str()); }
 
     private:
@@ -113,12 +132,15 @@ class ABE_EXPORT Message : public SharedObject {
             } u;
         };
 
-        HashTable<String, Entry>    mEntries;
+        HashTable<Atom, Entry>    mEntries;
+
+        const Entry *   _find(const Name& name) const;
+        Entry *         _find(const Name& name);
 
 #if MESSAGE_WITH_STL
     private:
-        void            _setValue(const String& name, SharedObject * object);
-        SharedObject *  _findValue(const String& name) const;
+        void            _setValue(const Atom& name, SharedObject * object);
+        SharedObject *  _findValue(const Name& name) const;
 
     public:
         template <class TYPE> struct holder : public SharedObject {
@@ -127,11 +149,11 @@ class ABE_EXPORT Message : public SharedObject {
             ABE_INLINE virtual ~holder() { }
         };
 
-        template <class TYPE> ABE_INLINE void set(const String& name, const TYPE& value)
+        template <class TYPE> ABE_INLINE void set(const Atom& name, const TYPE& value)
         { _setValue(name, new holder<TYPE>(value)); }
 
         // assert if not exists
-        template <class TYPE> ABE_INLINE const TYPE& find(const String& name) const
+        template <class TYPE> ABE_INLINE const TYPE& find(const Name& name) const
         { return (static_cast<holder<TYPE> *>(_findValue(name)))->value; }
 #endif
     
@@ -0,0 +1,780 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+
+// File:    Number.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181220     initial version
+//
+
+#define LOG_TAG "Number"
+#include "Log.h"
+#include "Number.h"
+#include "private/ryu_tables.h"
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+// integers: two digits per step with a pair table.
+// floats: Ryu by Ulf Adams, shortest digits that round trip, and
+// its inverse for parsing, both with 128 bits tables.
+// ref: https://github.com/ulfjack/ryu
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define EXACT_FLOAT_MATH    1       // no excess precision, clinger's fast path is exact
+#endif
+
+__BEGIN_NAMESPACE_ABE
+
+static const char kDigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+template <typename U> static ABE_INLINE size_t CountDigits(U v) {
+    size_t n = 1;
+    for (;;) {
+        if (v < 10)     return n;
+        if (v < 100)    return n + 1;
+        if (v < 1000)   return n + 2;
+        if (v < 10000)  return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+// write digits of v backward from end
+template <typename U> static ABE_INLINE void WriteDigits(char * end, U v) {
+    while (v >= 100) {
+        const U q = v / 100;
+        const size_t i = (size_t)(v - q * 100) * 2;
+        v = q;
+        end -= 2;
+        end[0] = kDigitPairs[i];
+        end[1] = kDigitPairs[i + 1];
+    }
+    if (v >= 10) {
+        end[-2] = kDigitPairs[v * 2];
+        end[-1] = kDigitPairs[v * 2 + 1];
+    } else {
+        end[-1] = '0' + (char)v;
+    }
+}
+
+template <typename U> static ABE_INLINE size_t UnsignedToChars(char * buf, U v) {
+    const size_t n = CountDigits(v);
+    WriteDigits(buf + n, v);
+    return n;
+}
+
+template <typename T, typename U> static ABE_INLINE size_t SignedToChars(char * buf, T v) {
+    if (v < 0) {
+        buf[0] = '-';
+        return 1 + UnsignedToChars<U>(buf + 1, (U)0 - (U)v);
+    }
+    return UnsignedToChars<U>(buf, (U)v);
+}
+
+size_t ToChars(char * buf, int32_t v)   { return SignedToChars<int32_t, uint32_t>(buf, v);  }
+size_t ToChars(char * buf, uint32_t v)  { return UnsignedToChars<uint32_t>(buf, v);         }
+size_t ToChars(char * buf, int64_t v)   { return SignedToChars<int64_t, uint64_t>(buf, v);  }
+size_t ToChars(char * buf, uint64_t v)  { return UnsignedToChars<uint64_t>(buf, v);         }
+
+//////////////////////////////////////////////////////////////////////////////
+// Ryu helpers
+#define DOUBLE_MANTISSA_BITS        52
+#define DOUBLE_BIAS                 1023
+#define DOUBLE_POW5_INV_BITCOUNT    125
+#define DOUBLE_POW5_BITCOUNT        125
+#define FLOAT_MANTISSA_BITS         23
+#define FLOAT_BIAS                  127
+#define FLOAT_POW5_INV_BITCOUNT     59
+#define FLOAT_POW5_BITCOUNT         61
+
+// ceil(log2(5^e)) for 0 < e <= 3528, 1 for e == 0
+static ABE_INLINE int32_t Pow5Bits(int32_t e)   { return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;  }
+// floor(log2(5^e))
+static ABE_INLINE int32_t Log2Pow5(int32_t e)   { return (int32_t)(((uint32_t)e * 1217359) >> 19);      }
+// floor(log10(2^e))
+static ABE_INLINE uint32_t Log10Pow2(int32_t e) { return ((uint32_t)e * 78913) >> 18;                   }
+// floor(log10(5^e))
+static ABE_INLINE uint32_t Log10Pow5(int32_t e) { return ((uint32_t)e * 732923) >> 20;                  }
+
+static ABE_INLINE int32_t FloorLog2(uint64_t v) { return 63 - __builtin_clzll(v); }
+
+static ABE_INLINE uint32_t Pow5Factor(uint64_t v) {
+    uint32_t count = 0;
+    for (;;) {
+        const uint64_t q = v / 5;
+        if (v - q * 5 != 0) break;
+        v = q;
+        ++count;
+    }
+    return count;
+}
+
+static ABE_INLINE bool MultipleOfPowerOf5(uint64_t v, uint32_t p) {
+    return Pow5Factor(v) >= p;
+}
+
+static ABE_INLINE bool MultipleOfPowerOf2(uint64_t v, uint32_t p) {
+    return (v & ((1ULL << p) - 1)) == 0;
+}
+
+#if !defined(__SIZEOF_INT128__)
+// 64 x 64 -> 128 bits
+static ABE_INLINE uint64_t Mul128(uint64_t a, uint64_t b, uint64_t * hi) {
+    const uint64_t aLo = (uint32_t)a, aHi = a >> 32;
+    const uint64_t bLo = (uint32_t)b, bHi = b >> 32;
+    const uint64_t b00 = aLo * bLo, b01 = aLo * bHi;
+    const uint64_t b10 = aHi * bLo, b11 = aHi * bHi;
+    const uint64_t mid1 = b10 + (b00 >> 32);
+    const uint64_t mid2 = b01 + (uint32_t)mid1;
+    *hi = b11 + (mid1 >> 32) + (mid2 >> 32);
+    return (mid2 << 32) | (uint32_t)b00;
+}
+#endif
+
+// (m * mul) >> j, mul is 128 bits, 64 < j < 128
+static ABE_INLINE uint64_t MulShift64(uint64_t m, const uint64_t * mul, int32_t j) {
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t b0 = (__uint128_t)m * mul[0];
+    const __uint128_t b2 = (__uint128_t)m * mul[1];
+    return (uint64_t)(((b0 >> 64) + b2) >> (j - 64));
+#else
+    uint64_t high0, high1;
+    Mul128(m, mul[0], &high0);
+    const uint64_t low1 = Mul128(m, mul[1], &high1);
+    const uint64_t sum = high0 + low1;
+    if (sum < high0) ++high1;
+    const int32_t dist = j - 64;
+    return (high1 << (64 - dist)) | (sum >> dist);
+#endif
+}
+
+// (m * factor) >> shift, 32 < shift
+static ABE_INLINE uint32_t MulShift32(uint32_t m, uint64_t factor, int32_t shift) {
+    const uint64_t bits0 = (uint64_t)m * (uint32_t)factor;
+    const uint64_t bits1 = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((bits0 >> 32) + bits1) >> (shift - 32));
+}
+
+static ABE_INLINE uint64_t DoubleToBits(double v)   { uint64_t u; memcpy(&u, &v, 8); return u; }
+static ABE_INLINE double BitsToDouble(uint64_t u)   { double v; memcpy(&v, &u, 8); return v; }
+static ABE_INLINE uint32_t FloatToBits(float v)     { uint32_t u; memcpy(&u, &v, 4); return u; }
+
+// value = mDigits * 10^mExponent
+struct Decimal {
+    uint64_t    mDigits;
+    int32_t     mExponent;
+};
+
+// shortest decimal in the rounding interval of a finite positive double
+static Decimal D2D(uint64_t ieeeMantissa, uint32_t ieeeExponent) {
+    int32_t e2;
+    uint64_t m2;
+    if (ieeeExponent == 0) {
+        e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = ieeeMantissa;
+    } else {
+        e2 = (int32_t)ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = (1ULL << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+    }
+    const bool acceptBounds = (m2 & 1) == 0;
+
+    // interval [mm, mp] around mv, all scaled by 4
+    const uint64_t mv = 4 * m2;
+    const uint32_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+
+    // convert to decimal power base
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    if (e2 >= 0) {
+        const uint32_t q = Log10Pow2(e2) - (e2 > 3);
+        e10 = (int32_t)q;
+        const int32_t k = DOUBLE_POW5_INV_BITCOUNT + Pow5Bits((int32_t)q) - 1;
+        const int32_t i = -e2 + (int32_t)q + k;
+        vr = MulShift64(4 * m2, kDoublePow5InvSplit[q], i);
+        vp = MulShift64(4 * m2 + 2, kDoublePow5InvSplit[q], i);
+        vm = MulShift64(4 * m2 - 1 - mmShift, kDoublePow5InvSplit[q], i);
+        if (q <= 21) {
+            // only one of mp, mv and mm can be a multiple of 5
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = MultipleOfPowerOf5(mv, q);
+            } else if (acceptBounds) {
+                vmIsTrailingZeros = MultipleOfPowerOf5(mv - 1 - mmShift, q);
+            } else {
+                vp -= MultipleOfPowerOf5(mv + 2, q);
+            }
+        }
+    } else {
+        const uint32_t q = Log10Pow5(-e2) - (-e2 > 1);
+        e10 = (int32_t)q + e2;
+        const int32_t i = -e2 - (int32_t)q;
+        const int32_t k = Pow5Bits(i) - DOUBLE_POW5_BITCOUNT;
+        const int32_t j = (int32_t)q - k;
+        vr = MulShift64(4 * m2, kDoublePow5Split[i], j);
+        vp = MulShift64(4 * m2 + 2, kDoublePow5Split[i], j);
+        vm = MulShift64(4 * m2 - 1 - mmShift, kDoublePow5Split[i], j);
+        if (q <= 1) {
+            // mv = 4 * m2 has at least 2 trailing zero bits
+            vrIsTrailingZeros = true;
+            if (acceptBounds) {
+                vmIsTrailingZeros = mmShift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 63) {
+            vrIsTrailingZeros = MultipleOfPowerOf2(mv, q);
+        }
+    }
+
+    // remove digits while vp and vm differ
+    int32_t removed = 0;
+    uint64_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        // general case, rare
+        uint32_t lastRemovedDigit = 0;
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = (uint32_t)(vr % 10);
+            vr /= 10; vp /= 10; vm /= 10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = (uint32_t)(vr % 10);
+                vr /= 10; vp /= 10; vm /= 10;
+                ++removed;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            lastRemovedDigit = 4;   // round half to even
+        }
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        // common case, two digits at once first
+        bool roundUp = false;
+        if (vp / 100 > vm / 100) {
+            roundUp = vr % 100 >= 50;
+            vr /= 100; vp /= 100; vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            roundUp = vr % 10 >= 5;
+            vr /= 10; vp /= 10; vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || roundUp);
+    }
+
+    Decimal d = { output, e10 + removed };
+    return d;
+}
+
+// shortest decimal in the rounding interval of a finite positive float
+static Decimal F2D(uint32_t ieeeMantissa, uint32_t ieeeExponent) {
+    int32_t e2;
+    uint32_t m2;
+    if (ieeeExponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieeeMantissa;
+    } else {
+        e2 = (int32_t)ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+    }
+    const bool acceptBounds = (m2 & 1) == 0;
+
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+    const uint32_t mm = 4 * m2 - 1 - mmShift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    uint32_t lastRemovedDigit = 0;
+    if (e2 >= 0) {
+        const uint32_t q = Log10Pow2(e2);
+        e10 = (int32_t)q;
+        const int32_t k = FLOAT_POW5_INV_BITCOUNT + Pow5Bits((int32_t)q) - 1;
+        const int32_t i = -e2 + (int32_t)q + k;
+        vr = MulShift32(mv, kFloatPow5InvSplit[q], i);
+        vp = MulShift32(mp, kFloatPow5InvSplit[q], i);
+        vm = MulShift32(mm, kFloatPow5InvSplit[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // loop below removes no digit, compute the last removed one with q - 1
+            const int32_t l = FLOAT_POW5_INV_BITCOUNT + Pow5Bits((int32_t)(q - 1)) - 1;
+            lastRemovedDigit = MulShift32(mv, kFloatPow5InvSplit[q - 1], -e2 + (int32_t)q - 1 + l) % 10;
+        }
+        if (q <= 9) {
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = MultipleOfPowerOf5(mv, q);
+            } else if (acceptBounds) {
+                vmIsTrailingZeros = MultipleOfPowerOf5(mm, q);
+            } else {
+                vp -= MultipleOfPowerOf5(mp, q);
+            }
+        }
+    } else {
+        const uint32_t q = Log10Pow5(-e2);
+        e10 = (int32_t)q + e2;
+        const int32_t i = -e2 - (int32_t)q;
+        const int32_t k = Pow5Bits(i) - FLOAT_POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = MulShift32(mv, kFloatPow5Split[i], j);
+        vp = MulShift32(mp, kFloatPow5Split[i], j);
+        vm = MulShift32(mm, kFloatPow5Split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (Pow5Bits(i + 1) - FLOAT_POW5_BITCOUNT);
+            lastRemovedDigit = MulShift32(mv, kFloatPow5Split[i + 1], j) % 10;
+        }
+        if (q <= 1) {
+            vrIsTrailingZeros = true;
+            if (acceptBounds) {
+                vmIsTrailingZeros = mmShift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 31) {
+            vrIsTrailingZeros = MultipleOfPowerOf2(mv, q - 1);
+        }
+    }
+
+    int32_t removed = 0;
+    uint32_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = vr % 10;
+            vr /= 10; vp /= 10; vm /= 10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = vr % 10;
+                vr /= 10; vp /= 10; vm /= 10;
+                ++removed;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            lastRemovedDigit = 4;
+        }
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        while (vp / 10 > vm / 10) {
+            lastRemovedDigit = vr % 10;
+            vr /= 10; vp /= 10; vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || lastRemovedDigit >= 5);
+    }
+
+    Decimal d = { output, e10 + removed };
+    return d;
+}
+
+// javascript style: fixed notation for 1e-7 < |v| < 1e21, otherwise
+// scientific with at least one digit before 'e'.
+static size_t WriteDecimal(char * buf, bool negative, const Decimal& d) {
+    char * p = buf;
+    if (negative) *p++ = '-';
+
+    char digits[20];
+    const int32_t k = (int32_t)UnsignedToChars(digits, d.mDigits);
+    const int32_t n = k + d.mExponent;  // position of decimal point
+
+    if (k <= n && n <= 21) {            // 1200
+        memcpy(p, digits, k);
+        memset(p + k, '0', n - k);
+        p += n;
+    } else if (0 < n && n <= 21) {      // 1.25
+        memcpy(p, digits, n);
+        p[n] = '.';
+        memcpy(p + n + 1, digits + n, k - n);
+        p += k + 1;
+    } else if (-6 < n && n <= 0) {      // 0.00125
+        p[0] = '0';
+        p[1] = '.';
+        memset(p + 2, '0', -n);
+        memcpy(p + 2 - n, digits, k);
+        p += 2 - n + k;
+    } else {                            // 1.25e-7
+        *p++ = digits[0];
+        if (k > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, k - 1);
+            p += k - 1;
+        }
+        *p++ = 'e';
+        const int32_t e = n - 1;
+        *p++ = e < 0 ? '-' : '+';
+        p += UnsignedToChars<uint32_t>(p, e < 0 ? -e : e);
+    }
+    return p - buf;
+}
+
+static size_t WriteSpecial(char * buf, bool negative, bool mantissa, bool exponent) {
+    if (exponent && mantissa) {
+        memcpy(buf, "nan", 3);
+        return 3;
+    }
+    char * p = buf;
+    if (negative) *p++ = '-';
+    if (exponent) {
+        memcpy(p, "inf", 3);
+        p += 3;
+    } else {
+        *p++ = '0';
+    }
+    return p - buf;
+}
+
+size_t ToChars(char * buf, double v) {
+    const uint64_t bits = DoubleToBits(v);
+    const bool negative = bits >> 63;
+    const uint64_t ieeeMantissa = bits & ((1ULL << DOUBLE_MANTISSA_BITS) - 1);
+    const uint32_t ieeeExponent = (uint32_t)(bits >> DOUBLE_MANTISSA_BITS) & 0x7ff;
+    if (ieeeExponent == 0x7ff || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+        return WriteSpecial(buf, negative, ieeeMantissa, ieeeExponent);
+    }
+    return WriteDecimal(buf, negative, D2D(ieeeMantissa, ieeeExponent));
+}
+
+size_t ToChars(char * buf, float v) {
+    const uint32_t bits = FloatToBits(v);
+    const bool negative = bits >> 31;
+    const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & 0xff;
+    if (ieeeExponent == 0xff || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+        return WriteSpecial(buf, negative, ieeeMantissa, ieeeExponent);
+    }
+    return WriteDecimal(buf, negative, F2D(ieeeMantissa, ieeeExponent));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+static ABE_INLINE bool IsDigit(char c) { return (unsigned char)(c - '0') < 10; }
+
+static ABE_INLINE uint64_t Load8(const char * s) {
+    uint64_t v;
+    memcpy(&v, s, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// all 8 chars in '0' - '9'
+static ABE_INLINE bool IsEightDigits(uint64_t v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+// 8 digits to value in 3 multiplies, first char in low byte
+static ABE_INLINE uint32_t ParseEightDigits(uint64_t v) {
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+            (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return (uint32_t)v;
+}
+
+// parse leading digits of s[0, n), return number of chars consumed,
+// overflow is set if the value does not fit in 64 bits.
+static size_t ParseDigits(const char * s, size_t n, uint64_t& value, bool& overflow) {
+    size_t i = 0;
+    while (i < n && s[i] == '0') ++i;
+    const size_t start = i;
+    uint64_t v = 0;
+    // 16 digits at most never overflow
+    while (i + 8 <= n && i - start <= 8) {
+        const uint64_t w = Load8(s + i);
+        if (!IsEightDigits(w)) break;
+        v = v * 100000000ULL + ParseEightDigits(w);
+        i += 8;
+    }
+    for (; i < n && IsDigit(s[i]); ++i) {
+        const uint32_t d = s[i] - '0';
+        const size_t digits = i - start;
+        if (digits < 19 || (digits == 19 && v <= (~0ULL - d) / 10)) {
+            v = v * 10 + d;
+        } else {
+            overflow = true;
+        }
+    }
+    value = v;
+    return i;
+}
+
+template <typename T, typename U> static ABE_INLINE size_t ParseInteger(const char * s, size_t n, T& v) {
+    const bool isSigned = (T)-1 < (T)0;
+    const bool negative = isSigned && n && s[0] == '-';
+    const size_t i = negative ? 1 : 0;
+
+    uint64_t m;
+    bool overflow = false;
+    const size_t digits = ParseDigits(s + i, n - i, m, overflow);
+    if (digits == 0 || overflow) return 0;
+
+    const uint64_t max = isSigned ? (uint64_t)((U)~(U)0 >> 1) + negative : (uint64_t)(U)~(U)0;
+    if (m > max) return 0;
+    v = negative ? (T)((U)0 - (U)m) : (T)m;
+    return i + digits;
+}
+
+size_t FromChars(const char * s, size_t n, int32_t& v)  { return ParseInteger<int32_t, uint32_t>(s, n, v);  }
+size_t FromChars(const char * s, size_t n, uint32_t& v) { return ParseInteger<uint32_t, uint32_t>(s, n, v); }
+size_t FromChars(const char * s, size_t n, int64_t& v)  { return ParseInteger<int64_t, uint64_t>(s, n, v);  }
+size_t FromChars(const char * s, size_t n, uint64_t& v) { return ParseInteger<uint64_t, uint64_t>(s, n, v); }
+
+// decimal text as digits * 10^exponent
+struct DecimalText {
+    bool        mNegative;
+    bool        mSpecial;   // inf or nan
+    bool        mNaN;
+    uint64_t    mDigits;
+    int32_t     mCount;     // significant digits, mDigits is valid if <= 19
+    int32_t     mExponent;
+};
+
+static ABE_INLINE bool MatchIgnoreCase(const char * s, size_t n, const char * word, size_t len) {
+    if (n < len) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if ((s[i] | 0x20) != word[i]) return false;
+    }
+    return true;
+}
+
+static size_t ParseDecimal(const char * s, size_t n, DecimalText& d) {
+    size_t i = 0;
+    d.mNegative = n && s[0] == '-';
+    if (d.mNegative) ++i;
+    d.mSpecial = false;
+
+    if (MatchIgnoreCase(s + i, n - i, "inf", 3)) {
+        d.mSpecial = true;
+        d.mNaN = false;
+        const bool full = MatchIgnoreCase(s + i, n - i, "infinity", 8);
+        return i + (full ? 8 : 3);
+    }
+    if (MatchIgnoreCase(s + i, n - i, "nan", 3)) {
+        d.mSpecial = true;
+        d.mNaN = true;
+        return i + 3;
+    }
+
+    bool any = false;
+    uint64_t m = 0;
+    int32_t count = 0;
+    int32_t e10 = 0;
+    while (i < n && s[i] == '0') { ++i; any = true; }
+    for (; i < n && IsDigit(s[i]); ++i) {
+        any = true;
+        if (++count <= 19) m = m * 10 + (s[i] - '0');
+        else ++e10;
+    }
+    if (i < n && s[i] == '.') {
+        ++i;
+        if (count == 0) {
+            while (i < n && s[i] == '0') { ++i; --e10; any = true; }
+        }
+        for (; i < n && IsDigit(s[i]); ++i) {
+            any = true;
+            if (++count <= 19) {
+                m = m * 10 + (s[i] - '0');
+                --e10;
+            }
+        }
+    }
+    if (!any) return 0;
+
+    // exponent, only if followed by digits
+    if (i < n && (s[i] | 0x20) == 'e') {
+        size_t j = i + 1;
+        bool negative = false;
+        if (j < n && (s[j] == '-' || s[j] == '+')) negative = s[j++] == '-';
+        if (j < n && IsDigit(s[j])) {
+            int32_t e = 0;
+            for (; j < n && IsDigit(s[j]); ++j) {
+                if (e < 100000) e = e * 10 + (s[j] - '0');
+            }
+            e10 += negative ? -e : e;
+            i = j;
+        }
+    }
+
+    // trailing zeros are not significant
+    if (count <= 19 && m) {
+        while (m % 10 == 0) {
+            m /= 10;
+            --count;
+            ++e10;
+        }
+    }
+    d.mDigits = m;
+    d.mCount = m ? count : 0;
+    d.mExponent = e10;
+    return i;
+}
+
+// slow path by libc, s[0, n) is a valid decimal
+template <typename T> static T ParseSlow(const char * s, size_t n) {
+    char tmp[64];
+    char * buf = n < sizeof(tmp) ? tmp : (char *)malloc(n + 1);
+    memcpy(buf, s, n);
+    buf[n] = '\0';
+    const T v = sizeof(T) == sizeof(float) ? strtof(buf, NULL) : strtod(buf, NULL);
+    if (buf != tmp) free(buf);
+    return v;
+}
+
+#if EXACT_FLOAT_MATH
+static const double kDoublePow10[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const float kFloatPow10[11] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+#endif
+
+// m10 * 10^e10 rounded to nearest double, m10 has at most 17 digits
+static double S2D(bool negative, uint64_t m10, int32_t m10digits, int32_t e10) {
+    const uint64_t sign = (uint64_t)negative << 63;
+    if (m10digits + e10 <= -324 || m10 == 0) {
+        return BitsToDouble(sign);
+    }
+    if (m10digits + e10 >= 310) {
+        return BitsToDouble(sign | (0x7ffULL << DOUBLE_MANTISSA_BITS));
+    }
+
+    // m2 * 2^e2 ~ m10 * 10^e10, m2 has 54 or 55 bits
+    int32_t e2;
+    uint64_t m2;
+    bool trailingZeros;
+    if (e10 >= 0) {
+        e2 = FloorLog2(m10) + e10 + Log2Pow5(e10) - (DOUBLE_MANTISSA_BITS + 1);
+        const int32_t j = e2 - e10 - Pow5Bits(e10) + DOUBLE_POW5_BITCOUNT;
+        m2 = MulShift64(m10, kDoublePow5Split[e10], j);
+        trailingZeros = e2 < e10 || (e2 - e10 < 64 && MultipleOfPowerOf2(m10, e2 - e10));
+    } else {
+        e2 = FloorLog2(m10) + e10 - Pow5Bits(-e10) - (DOUBLE_MANTISSA_BITS + 1);
+        const int32_t j = e2 - e10 + Pow5Bits(-e10) - 1 + DOUBLE_POW5_INV_BITCOUNT;
+        m2 = MulShift64(m10, kDoublePow5InvSplit[-e10], j);
+        trailingZeros = MultipleOfPowerOf5(m10, -e10);
+    }
+
+    int32_t ieee_e2 = e2 + DOUBLE_BIAS + FloorLog2(m2);
+    if (ieee_e2 < 0) ieee_e2 = 0;
+    if (ieee_e2 > 0x7fe) {
+        return BitsToDouble(sign | (0x7ffULL << DOUBLE_MANTISSA_BITS));
+    }
+
+    // round half to even
+    const int32_t shift = (ieee_e2 == 0 ? 1 : ieee_e2) - e2 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    trailingZeros &= (m2 & ((1ULL << (shift - 1)) - 1)) == 0;
+    const uint64_t lastRemovedBit = (m2 >> (shift - 1)) & 1;
+    const bool roundUp = lastRemovedBit && (!trailingZeros || ((m2 >> shift) & 1));
+
+    uint64_t ieee_m2 = (m2 >> shift) + roundUp;
+    ieee_m2 &= (1ULL << DOUBLE_MANTISSA_BITS) - 1;
+    if (ieee_m2 == 0 && roundUp) {
+        ++ieee_e2;  // mantissa overflows
+    }
+    return BitsToDouble(sign | ((uint64_t)ieee_e2 << DOUBLE_MANTISSA_BITS) | ieee_m2);
+}
+
+size_t FromChars(const char * s, size_t n, double& v) {
+    DecimalText d;
+    const size_t len = ParseDecimal(s, n, d);
+    if (len == 0) return 0;
+
+    const uint64_t sign = (uint64_t)d.mNegative << 63;
+    if (d.mSpecial) {
+        v = BitsToDouble(sign | (0x7ffULL << DOUBLE_MANTISSA_BITS) | ((uint64_t)d.mNaN << 51));
+    } else if (d.mCount == 0) {
+        v = BitsToDouble(sign);
+    }
+#if EXACT_FLOAT_MATH
+    // both m10 and 10^e10 are exact, one rounding
+    else if (d.mCount <= 19 && d.mDigits <= (1ULL << 53) && d.mExponent >= -22 && d.mExponent <= 22) {
+        double x = (double)d.mDigits;
+        x = d.mExponent < 0 ? x / kDoublePow10[-d.mExponent] : x * kDoublePow10[d.mExponent];
+        v = d.mNegative ? -x : x;
+    }
+#endif
+    else if (d.mCount <= 17) {
+        v = S2D(d.mNegative, d.mDigits, d.mCount, d.mExponent);
+    } else {
+        v = ParseSlow<double>(s, len);
+    }
+    return len;
+}
+
+size_t FromChars(const char * s, size_t n, float& v) {
+    DecimalText d;
+    const size_t len = ParseDecimal(s, n, d);
+    if (len == 0) return 0;
+
+    if (d.mSpecial) {
+        const uint32_t bits = ((uint32_t)d.mNegative << 31) | (0xffu << FLOAT_MANTISSA_BITS) | ((uint32_t)d.mNaN << 22);
+        memcpy(&v, &bits, 4);
+    } else if (d.mCount == 0) {
+        v = d.mNegative ? -0.0f : 0.0f;
+    }
+#if EXACT_FLOAT_MATH
+    else if (d.mCount <= 19 && d.mDigits <= (1u << 24) && d.mExponent >= -10 && d.mExponent <= 10) {
+        float x = (float)d.mDigits;
+        x = d.mExponent < 0 ? x / kFloatPow10[-d.mExponent] : x * kFloatPow10[d.mExponent];
+        v = d.mNegative ? -x : x;
+    }
+#endif
+    else {
+        v = ParseSlow<float>(s, len);
+    }
+    return len;
+}
+
+__END_NAMESPACE_ABE
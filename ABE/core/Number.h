@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+
+// File:    Number.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181220     initial version
+//
+
+#ifndef ABE_HEADERS_NUMBER_H
+#define ABE_HEADERS_NUMBER_H
+
+#include <ABE/core/Types.h>
+
+__BEGIN_NAMESPACE_ABE
+
+/**
+ * number <-> chars without locale and without allocation.
+ */
+enum { kNumberChars = 32 };     // enough for any ToChars()
+
+/**
+ * write decimal chars of v into buf, which has room for kNumberChars.
+ * floats are written in the shortest form that parses back to the same
+ * value, same as javascript: "1e+21", "0.1", "1.5e-7", "nan", "-inf".
+ * @return number of chars written, buf is not null terminated.
+ */
+ABE_EXPORT size_t ToChars(char * buf, int32_t v);
+ABE_EXPORT size_t ToChars(char * buf, uint32_t v);
+ABE_EXPORT size_t ToChars(char * buf, int64_t v);
+ABE_EXPORT size_t ToChars(char * buf, uint64_t v);
+ABE_EXPORT size_t ToChars(char * buf, float v);
+ABE_EXPORT size_t ToChars(char * buf, double v);
+
+/**
+ * parse a decimal number from the head of s[0, n).
+ * accepts an optional '-', no leading spaces and no '+'. floats accept
+ * "1", "1.5", ".5", "1e-7", "inf", "infinity" and "nan", and round to
+ * nearest like strtod.
+ * @return number of chars consumed, or 0 if there is no number or
+ *         an integer overflows, v is not modified in that case.
+ */
+ABE_EXPORT size_t FromChars(const char * s, size_t n, int32_t& v);
+ABE_EXPORT size_t FromChars(const char * s, size_t n, uint32_t& v);
+ABE_EXPORT size_t FromChars(const char * s, size_t n, int64_t& v);
+ABE_EXPORT size_t FromChars(const char * s, size_t n, uint64_t& v);
+ABE_EXPORT size_t FromChars(const char * s, size_t n, float& v);
+ABE_EXPORT size_t FromChars(const char * s, size_t n, double& v);
+
+__END_NAMESPACE_ABE
+
+#endif // ABE_HEADERS_NUMBER_H
@@ -90,12 +90,17 @@ struct ABE_EXPORT SharedBuffer : protected SharedObject {
         ABE_INLINE char *           data()                      { return mData;                             }
         ABE_INLINE const char *     data() const                { return mData;                             }
         ABE_INLINE size_t           size() const                { return mSize;                             }
+        /**
+         * usable bytes, edit() within capacity won't touch allocator
+         */
+        ABE_INLINE size_t           capacity() const            { return mCapacity;                         }
 
     public:
         /**
          * perform edit before you write to this cow buffer
          * @note if this cow is not shared, it does NOTHING. otherwise it perform a cow action
          * @note edit with new size always perform a cow action.
+         * @note edit with new size grows in place if it fits capacity() & not shared.
          * @note edit with new size will assert on failure
          */
         SharedBuffer *              edit();
@@ -105,6 +110,7 @@ struct ABE_EXPORT SharedBuffer : protected SharedObject {
         sp<Allocator>   mAllocator;
         char *          mData;
         size_t          mSize;
+        size_t          mCapacity;
     
     DISALLOW_EVILS(SharedBuffer);
 };
@@ -97,14 +97,60 @@ __END_NAMESPACE_ABE
 #define BUFFER_START_MAGIC  0xbaaddead
 #define BUFFER_END_MAGIC    0xdeadbaad
 
+// guard words before & after data, none without hardening
+#if ABE_HARDENING > 0
+#define BUFFER_GUARD            sizeof(uint32_t)
+#define CHECK_START_GUARD() do {                                    \
+    FATAL_CHECK_EQ(GetObjectID(), OBJECT_ID_SHAREDBUFFER);          \
+    FATAL_CHECK_EQ(((uint32_t *)mData)[-1], BUFFER_START_MAGIC);    \
+} while(0)
+#define CHECK_END_GUARD()       FATAL_CHECK_EQ(*(uint32_t *)(mData + mSize), BUFFER_END_MAGIC)
+#define PUT_END_GUARD(data, sz) *(uint32_t *)((data) + (sz)) = BUFFER_END_MAGIC
+#else
+#define BUFFER_GUARD            0
+#define CHECK_START_GUARD()     do { } while(0)
+#define CHECK_END_GUARD()       do { } while(0)
+#define PUT_END_GUARD(data, sz) do { } while(0)
+#endif
+
+// checks on hot paths, end guard is on another cache line,
+// so fast hardening checks it only on deallocate.
+#if ABE_HARDENING > 1
+#define CHECK_GUARDS()          do { CHECK_START_GUARD(); CHECK_END_GUARD(); } while(0)
+#else
+#define CHECK_GUARDS()          CHECK_START_GUARD()
+#endif
+
+// put guard words around data, return data
+static ABE_INLINE char * PutGuards(void * p, size_t sz) {
+    char * data = (char *)p;
+#if ABE_HARDENING > 0
+    *(uint32_t *)data   = BUFFER_START_MAGIC;
+    data                += sizeof(uint32_t);
+#endif
+    PUT_END_GUARD(data, sz);
+    return data;
+}
+
 __BEGIN_NAMESPACE_ABE
 
 SharedBuffer::SharedBuffer() : SharedObject(OBJECT_ID_SHAREDBUFFER),
-    mAllocator(NULL), mData(NULL), mSize(0) { }
+    mAllocator(NULL), mData(NULL), mSize(0), mCapacity(0) { }
+
+// round allocation length up to size classes: 16 bytes steps up to 128,
+// then 4 classes per power of 2, so waste is less than 25%
+static ABE_INLINE size_t RoundLength(size_t n) {
+    if (n <= 128) return (n + 15) & ~(size_t)15;
+    const size_t bits = sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(n - 1);
+    const size_t step = (size_t)1 << (bits - 2);
+    return (n + step - 1) & ~(step - 1);
+}
+
+#define BUFFER_OVERHEAD     (sizeof(SharedBuffer) + BUFFER_GUARD * 2)
 
     SharedBuffer * SharedBuffer::Create(const sp<Allocator> & _allocator, size_t sz) {
         // FIXME: if allocator is aligned, make sure data is also aligned
-        const size_t allocLength = sizeof(SharedBuffer) + sz + sizeof(uint32_t) * 2;
+        const size_t allocLength = RoundLength(BUFFER_OVERHEAD + sz);
 
         // keep a strong ref local
         sp<Allocator> allocator = _allocator;
@@ -114,22 +160,18 @@ SharedBuffer::SharedBuffer() : SharedObject(OBJECT_ID_SHAREDBUFFER),
 
         shared->mAllocator  = allocator;
         shared->mSize       = sz;
+        shared->mCapacity   = allocator->usable(shared, allocLength) - BUFFER_OVERHEAD;
 
         // put magic guard before and after data
-        char * data = (char *)&shared[1];
-        *(uint32_t *)data           = BUFFER_START_MAGIC;
-        data                        += sizeof(uint32_t);
-        *(uint32_t *)(data + sz)    = BUFFER_END_MAGIC;
-        shared->mData               = data;
+        shared->mData       = PutGuards(&shared[1], sz);
 
         shared->RetainObject();
         return shared;
     }
 
 void SharedBuffer::deallocate() {
-    FATAL_CHECK_EQ(GetObjectID(), OBJECT_ID_SHAREDBUFFER);
-    FATAL_CHECK_EQ(((uint32_t *)mData)[-1], BUFFER_START_MAGIC);
-    FATAL_CHECK_EQ(*(uint32_t *)(mData + mSize), BUFFER_END_MAGIC);
+    CHECK_START_GUARD();
+    CHECK_END_GUARD();
 
     // keep a strong ref local
     sp<Allocator> allocator = mAllocator;
@@ -138,9 +180,7 @@ void SharedBuffer::deallocate() {
 }
 
 size_t SharedBuffer::ReleaseBuffer(bool keep) {
-    FATAL_CHECK_EQ(GetObjectID(), OBJECT_ID_SHAREDBUFFER);
-    FATAL_CHECK_EQ(((uint32_t *)mData)[-1], BUFFER_START_MAGIC);
-    FATAL_CHECK_EQ(*(uint32_t *)(mData + mSize), BUFFER_END_MAGIC);
+    CHECK_GUARDS();
 
     size_t refs = SharedObject::ReleaseObject(true);
     if (refs == 0 && !keep) {
@@ -150,9 +190,7 @@ size_t SharedBuffer::ReleaseBuffer(bool keep) {
 }
 
 SharedBuffer * SharedBuffer::edit() {
-    FATAL_CHECK_EQ(GetObjectID(), OBJECT_ID_SHAREDBUFFER);
-    FATAL_CHECK_EQ(((uint32_t *)mData)[-1], BUFFER_START_MAGIC);
-    FATAL_CHECK_EQ(*(uint32_t *)(mData + mSize), BUFFER_END_MAGIC);
+    CHECK_GUARDS();
     if (IsBufferNotShared()) return this;
 
     SharedBuffer * copy = SharedBuffer::Create(mAllocator, mSize);
@@ -163,27 +201,29 @@ SharedBuffer * SharedBuffer::edit() {
 }
 
 SharedBuffer * SharedBuffer::edit(size_t sz) {
-    FATAL_CHECK_EQ(GetObjectID(), OBJECT_ID_SHAREDBUFFER);
-    FATAL_CHECK_EQ(((uint32_t *)mData)[-1], BUFFER_START_MAGIC);
-    FATAL_CHECK_EQ(*(uint32_t *)(mData + mSize), BUFFER_END_MAGIC);
+    CHECK_GUARDS();
 
     if (IsBufferNotShared() && sz <= mSize) return this;
 
+    if (IsBufferNotShared() && sz <= mCapacity) {
+        // grow in place, move the end guard only
+        mSize               = sz;
+        PUT_END_GUARD(mData, sz);
+        return this;
+    }
+
     if (IsBufferNotShared()) {
         // reallocate
         // keep a strong ref local
         sp<Allocator> allocator = mAllocator;
-        const size_t allocLength = sizeof(SharedBuffer) + sz + 2 * sizeof(uint32_t);
+        const size_t allocLength = RoundLength(BUFFER_OVERHEAD + sz);
         SharedBuffer * shared = (SharedBuffer *)allocator->reallocate(this, allocLength);
         // fix context
         shared->mAllocator  = allocator;
         shared->mSize       = sz;
+        shared->mCapacity   = allocator->usable(shared, allocLength) - BUFFER_OVERHEAD;
 
-        char * data                 = (char *)&shared[1];
-        *(uint32_t *)data           = BUFFER_START_MAGIC;
-        data                        += sizeof(uint32_t);
-        *(uint32_t *)(data + sz)    = BUFFER_END_MAGIC;
-        shared->mData               = data;
+        shared->mData       = PutGuards(&shared[1], sz);
         return shared;
     }
 
@@ -37,16 +37,22 @@
 #define LOG_TAG   "String"
 #include "Log.h"
 #include "String.h"
+#include "Hash.h"
+#include "Number.h"
+#include "StringBuilder.h"
+#include "StringView.h"
+#include "Buffer.h"
 
-#include "private/ConvertUTF.h"
+#include "private/strsimd.h"
 
 #include <ctype.h> // isspace 
-#include <strings.h> 
 #include <string.h> 
 #include <stdio.h>
 #include <inttypes.h>
 #include <stdlib.h>
 
+#define MIN(a, b)   ((a) > (b) ? (b) : (a))
+
 static size_t CStringPrintf(void *str, size_t size, const char *format, ...) {
     va_list ap;
     va_start(ap, format);
@@ -65,107 +71,174 @@ __BEGIN_NAMESPACE_ABE
 
 String String::format(const char *format, ...) {
     va_list ap;
-    char buf[1024];
     va_start(ap, format);
+    StringBuilder builder;
+    builder.appendFormat(format, ap);
+    va_end(ap);
+    return builder.toString();
+}
 
-    size_t len = vsnprintf(buf, 1024, format, ap);
+String String::format(const char *format, va_list ap) {
+    StringBuilder builder;
+    builder.appendFormat(format, ap);
+    return builder.toString();
+}
+
+void String::setNull() {
+    mHeap.mData         = NULL;
+    mHeap.mSize         = 0;
+    mInline[kInlineTag] = (char)kHeapTag;
+}
+
+char * String::edit(size_t n) {
+    if (isInline()) {
+        if (n <= kInlineMax) return mInline;
+        // move to heap
+        const size_t size = (uint8_t)mInline[kInlineTag];
+        SharedBuffer * data = SharedBuffer::Create(kAllocatorDefault, n + 1);
+        memcpy(data->data(), mInline, size + 1);
+        mHeap.mData         = data;
+        mHeap.mSize         = size;
+        mInline[kInlineTag] = (char)kHeapTag;
+        return data->data();
+    }
 
-    va_end(ap);
+    if (mHeap.mData == NULL) {
+        if (n <= kInlineMax) {
+            mInline[0]          = '\0';
+            mInline[kInlineTag] = 0;
+            return mInline;
+        }
+        mHeap.mData = SharedBuffer::Create(kAllocatorDefault, n + 1);
+        mHeap.mData->data()[0] = '\0';
+        return mHeap.mData->data();
+    }
 
-    String result(buf, len);
-    return result;
+    // cow & grow in place if possible
+    mHeap.mData = mHeap.mData->edit(n + 1);
+    return mHeap.mData->data();
 }
 
-String String::format(const char *format, va_list ap) {
-    char buf[1024];
-    size_t len = vsnprintf(buf, 1024, format, ap);
-    String result(buf, len);
-    return result;
+size_t String::capacity() const {
+    if (isInline()) return kInlineMax;
+    if (mHeap.mData == NULL) return 0;
+    return mHeap.mData->capacity() - 1;
 }
 
-String::String() : mData(NULL), mSize(0) { }
+void String::resize(size_t n) {
+    if (isInline()) {
+        mInline[n]          = '\0';
+        mInline[kInlineTag] = (char)n;
+    } else {
+        mHeap.mData->data()[n] = '\0';
+        mHeap.mSize = n;
+    }
+}
+
+String::String() {
+    setNull();
+}
 
 /* static */
 String String::Null;
 
-String::String(const char *s, size_t n) : mData(NULL), mSize(0)
-{
+String::String(const char *s, size_t n) {
     CHECK_NULL(s);
-    if (!n) mSize = strlen(s);
-    else    mSize = strnlen(s, n);
-    mData = SharedBuffer::Create(kAllocatorDefault, mSize + 1);
-    char * buf = mData->data();
-    if (mSize) memcpy(buf, s, mSize);
-    buf[mSize] = '\0';
+    setNull();
+    const size_t size = n ? strnlen(s, n) : strlen(s);
+    char * buf = edit(size);
+    if (size) memcpy(buf, s, size);
+    resize(size);
 }
 
-String::String(const String &rhs) : mData(NULL), mSize(0)
-{
-    if (rhs.mData) mData = rhs.mData->RetainBuffer();
-    mSize   = rhs.mSize;
+String::String(const String &rhs) {
+    // copy the union, and retain the shared buffer
+    memcpy(mInline, rhs.mInline, kInlineLength);
+    if (!isInline() && mHeap.mData) mHeap.mData->RetainBuffer();
 }
 
-String String::UTF16(const char *s, size_t n) {
+// utf16 to utf8 with simd kernels, keep the old behavior of ConvertUTF
+// lenientConversion, which String::UTF16() used.
+static ssize_t UTF16ToUTF8(char * utf8, const char * s, size_t n, int be) {
     CHECK_NULL(s);
-    CHECK_GT(n, 0);
-    
-    // is the size right?
-    const size_t length = n * 4 + 1;
-    char utf8[length];
-    char * buf_start = utf8;
-    char * buf_end = buf_start + length;
-    char * buf = buf_start;
-
-    ConversionResult result = ConvertUTF16toUTF8(
-            (const ::UTF16**)&s, (const ::UTF16*)(s + n),
-            (UTF8**)&buf,
-            (UTF8*)buf_end,
-            lenientConversion);
-    if (result != conversionOK) {
-        ERROR("ConvertUTF16toUTF8 failed, ret = %d.", result);
-        return String::Null;
+    const ssize_t length = str_utf16_to_utf8(s, n / 2, utf8, be);
+    if (length < 0) {
+        ERROR("utf16 to utf8 failed, truncated surrogate pair.");
     }
+    return length;
+}
 
-    return String(utf8, buf - buf_start);
+String String::UTF16(const char *s, size_t n) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return UTF16BE(s, n);
+#else
+    return UTF16LE(s, n);
+#endif
 }
 
-#define STRING_FROM_NUMBER(TYPE, SIZE, PRI)                                 \
-    String::String(const TYPE v) : mData(NULL), mSize(0) {                  \
-        mData = SharedBuffer::Create(kAllocatorDefault, SIZE + 1);          \
-        char * buf = mData->data();                                         \
+#define STRING_FROM_UTF16(NAME, BE)                                         \
+    String String::NAME(const char *s, size_t n) {                          \
+        String utf8;                                                        \
+        const ssize_t length = UTF16ToUTF8(utf8.edit(3 * (n / 2)), s, n, BE); \
+        if (length < 0) return String::Null;                                \
+        utf8.resize(length);                                                \
+        return utf8;                                                        \
+    }
+
+STRING_FROM_UTF16(UTF16LE, 0);
+STRING_FROM_UTF16(UTF16BE, 1);
+#undef STRING_FROM_UTF16
+
+#define STRING_FROM_FORMAT(TYPE, SIZE, PRI)                                 \
+    String::String(const TYPE v) {                                          \
+        setNull();                                                          \
+        char buf[SIZE + 1];                                                 \
         int result = CStringPrintf(buf, SIZE, "%" PRI, v);                  \
         CHECK_GT(result, 0); CHECK_LE(result, SIZE);                        \
-        mSize               = result;                                       \
-        buf[mSize]          = '\0';                                         \
+        memcpy(edit(result), buf, result);                                  \
+        resize(result);                                                     \
+    }
+
+STRING_FROM_FORMAT(char,        2,      "c");
+STRING_FROM_FORMAT(void *,      32,     "xp");
+#undef STRING_FROM_FORMAT
+
+// no printf, shortest round trip chars for floats
+#define STRING_FROM_NUMBER(TYPE, AS)                                        \
+    String::String(const TYPE v) {                                          \
+        setNull();                                                          \
+        char buf[kNumberChars];                                             \
+        const size_t n = ToChars(buf, (AS)v);                               \
+        memcpy(edit(n), buf, n);                                            \
+        resize(n);                                                          \
     }
 
-STRING_FROM_NUMBER(char,        2,      "c");
-STRING_FROM_NUMBER(uint8_t,     4,      PRIu8);
-STRING_FROM_NUMBER(int8_t,      4,      PRId8);
-STRING_FROM_NUMBER(uint16_t,    6,      PRIu16);
-STRING_FROM_NUMBER(int16_t,     6,      PRId16);
-STRING_FROM_NUMBER(uint32_t,    16,     PRIu32);
-STRING_FROM_NUMBER(int32_t,     16,     PRId32);
-STRING_FROM_NUMBER(uint64_t,    32,     PRIu64);
-STRING_FROM_NUMBER(int64_t,     32,     PRId64);
-STRING_FROM_NUMBER(float,       32,     "f");
-STRING_FROM_NUMBER(double,      64,     "f");
+STRING_FROM_NUMBER(uint8_t,     uint32_t);
+STRING_FROM_NUMBER(int8_t,      int32_t);
+STRING_FROM_NUMBER(uint16_t,    uint32_t);
+STRING_FROM_NUMBER(int16_t,     int32_t);
+STRING_FROM_NUMBER(uint32_t,    uint32_t);
+STRING_FROM_NUMBER(int32_t,     int32_t);
+STRING_FROM_NUMBER(uint64_t,    uint64_t);
+STRING_FROM_NUMBER(int64_t,     int64_t);
+STRING_FROM_NUMBER(float,       float);
+STRING_FROM_NUMBER(double,      double);
 #if defined(__clang__)
-STRING_FROM_NUMBER(size_t,      32,     "zu");
+STRING_FROM_NUMBER(size_t,      uint64_t);
 #endif
 #if defined(__clang__)
-STRING_FROM_NUMBER(ssize_t,     32,     "zd");
+STRING_FROM_NUMBER(ssize_t,     int64_t);
 #endif
-STRING_FROM_NUMBER(void *,      32,     "xp");
+#undef STRING_FROM_NUMBER
 
 String::~String() {
     clear();
 }
 
 String String::basename() const {
-    if (mData == NULL) return String::Null;
+    if (isNull()) return String::Null;
     
-    char * buf = mData->data();
+    const char * buf = c_str();
     const char *last = strrchr(buf, '/');
     if (last) {
         const char *dot = strrchr(last, '.');
@@ -180,180 +253,178 @@ String String::basename() const {
     }
 }
 
+bool String::isUTF8() const {
+    return str_utf8_valid(c_str(), size());
+}
+
+static sp<Buffer> UTF8ToUTF16(const String& s, int be) {
+    sp<Buffer> utf16 = new Buffer(2 * s.size() + 2);
+    const ssize_t units = str_utf8_to_utf16(s.c_str(), s.size(), utf16->data(), be);
+    if (units < 0) return NULL;
+    if (units) utf16->step(2 * units);
+    return utf16;
+}
+
+sp<Buffer> String::toUTF16LE() const {
+    return UTF8ToUTF16(*this, 0);
+}
+
+sp<Buffer> String::toUTF16BE() const {
+    return UTF8ToUTF16(*this, 1);
+}
+
 String String::dirname() const {
-    FATAL("TODO: add implementation");
-    return String("");
+    if (isNull()) return String::Null;
+    return StringView(*this).dirname().string();
 }
 
 const char& String::operator[](size_t index) const {
-    CHECK_NULL(mData);
+    CHECK_FALSE(isNull());
     CHECK_LE(index, size());
-    char * buf = mData->data();
-    return buf[index];
+    return c_str()[index];
 }
 
 char& String::operator[](size_t index) {
-    CHECK_NULL(mData);
+    CHECK_FALSE(isNull());
     CHECK_LE(index, size());
-    mData = mData->edit();
-    char * buf = mData->data();
+    char * buf = edit(size());
     return buf[index];
 }
 
 String& String::set(const String& s) {
-    if (mData) mData->ReleaseBuffer();
-    mData   = s.mData->RetainBuffer();
-    mSize   = s.mSize;
+    if (this == &s) return *this;
+    clear();
+    memcpy(mInline, s.mInline, kInlineLength);
+    if (!isInline() && mHeap.mData) mHeap.mData->RetainBuffer();
     return *this;
 }
 
 String& String::set(const char * s, size_t n) {
     if (!n) n = strlen(s);
-    if (mData && mData->size() > n) {
-        // no need to release buffer
-    } else {
-        if (mData) mData->ReleaseBuffer();
-        mData = SharedBuffer::Create(kAllocatorDefault, n + 1);
+    if (!isInline() && mHeap.mData && mHeap.mData->IsBufferShared()) {
+        clear();
     }
-    memcpy(mData->data(), s, n);
-    mSize = n;
+    // reuse buffer, no allocation if it fits inline or capacity
+    char * buf = edit(n);
+    memmove(buf, s, n);
+    resize(n);
     return *this;
 }
 
 String& String::append(const String& s) {
-    if (!s.mSize) return *this; // append empty string ?
-    if (!mSize) return set(s);
-
-    size_t m = mSize + s.mSize + 1;
-    mData = mData->edit(m);
-
-    // plus 1 for '\0'
-    char * buf = mData->data();
-    strncpy(buf + mSize, s.mData->data(), s.mSize + 1);
-    mSize += s.mSize;
+    const size_t n = s.size();
+    if (!n) return *this; // append empty string ?
+    const size_t m = size();
+    if (!m) return set(s);
+
+    char * buf = edit(m + n);
+    memcpy(buf + m, s.c_str(), n);
+    resize(m + n);
     return *this;
 }
 
 String& String::append(const char * s, size_t n) {
     if (!n) n = strlen(s);
     if (!n) return *this;   // append empty string
-    if (!mSize) return set(s, n);
+    const size_t m = size();
+    if (!m) return set(s, n);
     
-    size_t m = mSize + n + 1;   // plus 1 for '\0'
-    mData = mData->edit(m);
-    strncpy(mData->data() + mSize, s, n + 1);   // plus 1 for '\0';
-    mSize += n;
+    char * buf = edit(m + n);
+    memcpy(buf + m, s, n);
+    resize(m + n);
     return *this;
 }
 
 String& String::insert(size_t pos, const String& s) {
-    CHECK_LE(pos, mSize);
-    if (!s.mSize) return *this; // insert an empty string ???
-
-    if (!mSize) return set(s);
-    if (pos == mSize) return append(s);
-
-    size_t m = mSize + s.mSize + 1;
-    mData = mData->edit(m);
-
-    // +1 to move the terminating null byte
-    char * buf = mData->data();
-    memmove(buf + pos + s.mSize, buf + pos, mSize - pos + 1);
-    strncpy(buf + pos, s.mData->data(), s.mSize);
-    mSize   += s.mSize;
+    const size_t m = size();
+    const size_t n = s.size();
+    CHECK_LE(pos, m);
+    if (!n) return *this; // insert an empty string ???
+
+    if (!m) return set(s);
+    if (pos == m) return append(s);
+
+    char * buf = edit(m + n);
+    memmove(buf + pos + n, buf + pos, m - pos);
+    memcpy(buf + pos, s.c_str(), n);
+    resize(m + n);
     return *this;
 }
 
 String& String::insert(size_t pos, const char *s, size_t n) {
-    CHECK_LE(pos, mSize);
+    const size_t m = size();
+    CHECK_LE(pos, m);
     if (!n) n = strlen(s);
     if (!n) return *this; // insert empty string
     
-    if (!mSize) return set(s, n);
-    if (pos == mSize) return append(s, n);
-    
-    size_t m = mSize + n + 1;
-    mData = mData->edit(m);
+    if (!m) return set(s, n);
+    if (pos == m) return append(s, n);
     
-    char * buf = mData->data();
-    memmove(buf + pos + n, buf + pos, mSize - pos + 1); // plus 1 for '\0'
-    strncpy(buf + pos, s, n);
-    mSize += n;
+    char * buf = edit(m + n);
+    memmove(buf + pos + n, buf + pos, m - pos);
+    memcpy(buf + pos, s, n);
+    resize(m + n);
     return *this;
 }
 
 void String::clear() {
-    if (mData == NULL) return;
-    mData->ReleaseBuffer();
-    mData = NULL;
-    mSize = 0;
+    if (!isInline() && mHeap.mData) mHeap.mData->ReleaseBuffer();
+    setNull();
 }
 
 size_t String::hash() const {
-    if (mData == NULL) return 0;
-    size_t x = 0;
-    const char *s = mData->data();
-    for (size_t i = 0; i < mSize; ++i) {
-        x = (x * 31) + s[i];
-    }
-    return x;
+    if (isNull()) return 0;
+    return HashBytes(c_str(), size());
 }
 
 String& String::trim() {
-    if (mSize == 0) return *this;
-
-    mData = mData->edit();
+    const size_t m = size();
+    if (m == 0) return *this;
 
-    char *s = mData->data();
+    const char * s = c_str();
     size_t i = 0;
-    while (i < mSize && isspace(s[i])) {
+    while (i < m && isspace(s[i])) {
         ++i;
     }
 
-    size_t j = mSize;
+    size_t j = m;
     while (j > i && isspace(s[j - 1])) {
         --j;
     }
+    if (i == 0 && j == m) return *this;
 
-    memmove(s, &s[i], j - i);
-    mSize = j - i;
-    s[mSize] = '\0';
+    char * buf = edit(m);
+    memmove(buf, &buf[i], j - i);
+    resize(j - i);
     return *this;
 }
 
 String& String::erase(size_t pos, size_t n) {
-    CHECK_TRUE(pos < mSize);
-    CHECK_TRUE(pos + n <= mSize);
+    const size_t m = size();
+    CHECK_TRUE(pos < m);
+    CHECK_TRUE(pos + n <= m);
 
-    mData = mData->edit();
-    char * buf = mData->data();
-
-    if (pos + n < mSize) {
-        memmove(buf + pos, buf + pos + n, mSize - (pos + n));
+    char * buf = edit(m);
+    if (pos + n < m) {
+        memmove(buf + pos, buf + pos + n, m - (pos + n));
     }
-    mSize -= n;
-    buf[mSize] = '\0';
+    resize(m - n);
     return *this;
 }
 
 String& String::replace(const char * s0, const char * s1) {
+    ssize_t index = indexOf(s0);
+    if (index < 0) return *this;
+
     const size_t n0 = strlen(s0);
     const size_t n1 = strlen(s1);
-    const size_t newSize = mSize - n0 + n1;
-    if (newSize > mSize)
-        mData = mData->edit(newSize + 1);
-    else
-        mData = mData->edit();
-
-    ssize_t index = indexOf(s0);
-    char * buf = mData->data();
-    if (index >= 0) {
-        if (n0 != n1) {
-            memmove(buf + index + n1, buf + index + n0, mSize - index - n0 + 1);
-        }
-        memcpy(buf + index, s1, n1);
-        mSize = mSize - n0 + n1;
+    const size_t m = size();
+    char * buf = edit(n1 > n0 ? m - n0 + n1 : m);
+    if (n0 != n1) {
+        memmove(buf + index + n1, buf + index + n0, m - index - n0);
     }
+    memcpy(buf + index, s1, n1);
+    resize(m - n0 + n1);
     return *this;
 }
 
@@ -370,142 +441,119 @@ String& String::replaceAll(const char * s0, const char * s1) {
 }
 
 ssize_t String::indexOf(size_t start, const char * s) const {
-    const char *sub = strstr(mData->data() + start, s);
-    if (!sub) return -1;
-    return sub - mData->data();
+    const size_t m = size();
+    if (start > m) return -1;
+    const ssize_t index = str_find(c_str() + start, m - start, s, strlen(s));
+    if (index < 0) return -1;
+    return start + index;
 }
 
+// including the terminating null, same as strchr
 ssize_t String::indexOf(size_t fromIndex, int c) const {
-    char * buf = mData->data();
-    const char *sub = strchr(buf + fromIndex, c);
-    if (!sub) return -1;
-    return sub - buf;
+    const size_t m = size();
+    if (fromIndex > m) return -1;
+    const ssize_t index = str_find_char(c_str() + fromIndex, m - fromIndex + 1, c);
+    if (index < 0) return -1;
+    return fromIndex + index;
 }
 
 ssize_t String::lastIndexOf(const char *s) const {
-    const size_t n = strlen(s);
-    if (n > mSize)  return -1;
-    
-    const char * buf = mData->data();
-    for (size_t i = 0; i < mSize - n; ++i) {
-        
-        size_t j = 0;
-        for (; j < n; j++) {
-            if (buf[mSize - n - i + j] != s[j]) {
-                break;
-            }
-        }
-        
-        if (j == n) return mSize - n - i;
-    }
-    return -1;
+    return str_rfind(c_str(), size(), s, strlen(s));
 }
 
 ssize_t String::lastIndexOf(int c) const {
-    char * buf = mData->data();
-    const char *sub = strrchr(buf, c);
-    if (!sub) return -1;
-    return sub - buf;
+    return str_rfind_char(c_str(), size() + 1, c);
 }
 
 int String::compare(const String& s) const {
-    if (mData == s.mData) return 0;
-    if (s.mData == NULL) return 1;
-    if (mData == NULL) return -1;
+    if (!isInline() && !s.isInline() && mHeap.mData == s.mHeap.mData) return 0;
+    if (s.isNull()) return 1;
+    if (isNull()) return -1;
     
-    return strcmp(mData->data(), s.mData->data());
+    return strcmp(c_str(), s.c_str());
 }
 
 int String::compare(const char *s) const {
-    if (mData == NULL) return -1;
-    return strcmp(mData->data(), s);
+    if (isNull()) return -1;
+    return strcmp(c_str(), s);
 }
 
 int String::compareIgnoreCase(const String& s) const {
-    if (s.mData == NULL) return 1;
-    if (mData == NULL) return -1;
+    if (s.isNull()) return 1;
+    if (isNull()) return -1;
     
-    return strcasecmp(mData->data(), s.mData->data());
+    // compare the terminating null too
+    return str_casecmp(c_str(), s.c_str(), MIN(size(), s.size()) + 1);
 }
 
 int String::compareIgnoreCase(const char *s) const {
-    if (mData == NULL) return -1;
-    return strcasecmp(mData->data(), s);
+    if (isNull()) return -1;
+    return str_casecmp(c_str(), s, strnlen(s, size()) + 1);
 }
 
 String& String::lower() {
-    mData = mData->edit();
-    char * buf = mData->data();
-    for (size_t i = 0; i < mSize; ++i) {
-        buf[i] = ::tolower(buf[i]);
-    }
+    const size_t m = size();
+    str_lower(edit(m), m);
     return *this;
 }
 
 String& String::upper() {
-    mData = mData->edit();
-    char * buf = mData->data();
-    for (size_t i = 0; i < mSize; ++i) {
-        buf[i] = ::toupper(buf[i]);
-    }
+    const size_t m = size();
+    str_upper(edit(m), m);
     return *this;
 }
 
 bool String::startsWith(const char * s, size_t n) const {
     if (!n) n = strlen(s);
-    if (n > mSize) return false;
-    return !strncmp(mData->data(), s, n);
+    if (n > size()) return false;
+    return !strncmp(c_str(), s, n);
 }
 
 bool String::startsWithIgnoreCase(const char * s, size_t n) const {
     if (!n) n = strlen(s);
-    if (n > mSize) return false;
-    return !strncasecmp(mData->data(), s, n);
+    if (n > size()) return false;
+    return !str_casecmp(c_str(), s, n);
 }
 
 bool String::endsWith(const char * s, size_t n) const {
     if (!n) n = strlen(s);
-    if (n > mSize) return false;
-    return !strcmp(mData->data() + mSize - n, s);
+    if (n > size()) return false;
+    return !strcmp(c_str() + size() - n, s);
 }
 
 bool String::endsWithIgnoreCase(const char * s, size_t n) const {
     if (!n) n = strlen(s);
-    if (n > mSize) return false;
-    return !strcasecmp(mData->data() + mSize - n, s);
+    if (n > size()) return false;
+    return !str_casecmp(c_str() + size() - n, s, n + 1);
 }
 
 String String::substring(size_t pos, size_t n) const {
-    CHECK_TRUE(pos < mSize);
-    char * buf = mData->data();
-    return String(buf + pos, n);
+    CHECK_TRUE(pos < size());
+    return String(c_str() + pos, n);
 }
 
 int32_t String::toInt32() const {
-    return strtol(mData->data(), NULL, 10);
+    return StringView(*this).toInt32();
 }
 
 int64_t String::toInt64() const {
-    return strtoll(mData->data(), NULL, 10);
+    return StringView(*this).toInt64();
 }
 
 float String::toFloat() const {
-    return strtof(mData->data(), NULL);
+    return StringView(*this).toFloat();
 }
 
 double String::toDouble() const {
-    return strtod(mData->data(), NULL);
+    return StringView(*this).toDouble();
 }
 
 void String::swap(String& s) {
-    if (mData == s.mData) return;
-    size_t size         = mSize;
-    SharedBuffer* data  = mData;
-
-    mSize       = s.mSize;
-    mData       = s.mData;
-    s.mSize     = size;
-    s.mData     = data;
+    if (this == &s) return;
+    char tmp[kInlineLength];
+    memcpy(tmp, mInline, kInlineLength);
+    memcpy(mInline, s.mInline, kInlineLength);
+    memcpy(s.mInline, tmp, kInlineLength);
 }
 
 __END_NAMESPACE_ABE
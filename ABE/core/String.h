@@ -41,8 +41,12 @@
 
 __BEGIN_NAMESPACE_ABE
 
+class Buffer;
+
 /**
  * a utf8 string object with cow support
+ * @note short strings are stored inline without allocation, longer
+ *       strings are stored in a cow SharedBuffer.
  */
 class ABE_EXPORT String : public NonSharedObject {
     public:
@@ -81,8 +85,13 @@ class ABE_EXPORT String : public NonSharedObject {
          * create a utf8 string from utf16 string.
          * @param s     pointer to a c-style string, may be null terminated
          * @param n     number bytes of this utf16 string excluding terminating null
+         * @return return String::Null if s ends with a high surrogate
+         * @note UTF16() is in native byte order
+         * @note unpaired surrogates are kept as is
          */
         static String UTF16(const char *s, size_t n);
+        static String UTF16LE(const char *s, size_t n);
+        static String UTF16BE(const char *s, size_t n);
 
         /**
          * create string from basic types
@@ -131,8 +140,8 @@ class ABE_EXPORT String : public NonSharedObject {
         void        clear();
         String      substring(size_t pos, size_t n = 0) const;
         void        swap(String& s);
-        String&     lower();
-        String&     upper();
+        String&     lower();    // ascii only
+        String&     upper();    // ascii only
 
     public:
         ABE_INLINE String& operator=(const String &s)     { set(s); return *this;                 }
@@ -157,9 +166,9 @@ class ABE_EXPORT String : public NonSharedObject {
          * @note always non-null, even size() == 0, except String::Null
          * @note no non-const version of c_str()
          */
-        ABE_INLINE const char * c_str() const   { return mData->data(); }
-        ABE_INLINE size_t       size() const    { return mSize;         }
-        ABE_INLINE bool         empty() const   { return mSize == 0;    }
+        ABE_INLINE const char * c_str() const   { return isInline() ? mInline : mHeap.mData->data();                    }
+        ABE_INLINE size_t       size() const    { return isInline() ? (uint8_t)mInline[kInlineTag] : mHeap.mSize;       }
+        ABE_INLINE bool         empty() const   { return size() == 0;                                                   }
 
     public:
         ssize_t     indexOf(size_t start, const char * s) const;
@@ -181,7 +190,7 @@ class ABE_EXPORT String : public NonSharedObject {
     public:
         int         compare(const char * s) const;
         int         compare(const String &s) const;
-        int         compareIgnoreCase(const char * s) const;
+        int         compareIgnoreCase(const char * s) const;      // ascii only
         int         compareIgnoreCase(const String &s) const;
     
     public:
@@ -224,9 +233,42 @@ ABE_INLINE bool operator op(const char * rhs) const { return compare(rhs) op 0;
         String      dirname() const;
         String      basename() const;
 
+    public:
+        /**
+         * is this string well-formed utf8
+         */
+        bool        isUTF8() const;
+        /**
+         * convert to utf16 without terminating null
+         * @return return NULL if this string is not well-formed utf8
+         */
+        sp<Buffer>  toUTF16LE() const;
+        sp<Buffer>  toUTF16BE() const;
+
     private:
-        SharedBuffer *  mData;
-        size_t          mSize;
+        // the last byte of inline storage is size of inline string,
+        // or kHeapTag for string in SharedBuffer, mData is NULL for Null.
+        enum { kInlineLength = 24, kInlineTag = kInlineLength - 1 };
+        enum { kInlineMax = kInlineLength - 2 };    // exclude '\0' & tag
+        enum { kHeapTag = 0xff };
+
+        ABE_INLINE bool isInline() const    { return (uint8_t)mInline[kInlineTag] <= kInlineMax;            }
+        ABE_INLINE bool isNull() const      { return !isInline() && mHeap.mData == NULL;                    }
+        void            setNull();
+        char *          edit(size_t n);     // writable buffer for n chars, keep contents
+        void            resize(size_t n);   // set size & terminating null
+        size_t          capacity() const;   // chars fit without grow, excluding '\0'
+        friend class    StringBuilder;
+        friend class    Cord;
+
+        struct Heap {
+            SharedBuffer *  mData;
+            size_t          mSize;
+        };
+        union {
+            Heap            mHeap;
+            char            mInline[kInlineLength];
+        };
 };
 
 ///////////////////////////////////////////////////////////////////////////
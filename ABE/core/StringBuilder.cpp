@@ -0,0 +1,146 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    StringBuilder.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181220     initial version
+//
+
+#define LOG_TAG "StringBuilder"
+#include "Log.h"
+#include "StringBuilder.h"
+#include "Number.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef va_copy     // c++98
+#define va_copy(d, s)   __va_copy(d, s)
+#endif
+
+#define MAX(a, b)   ((a) > (b) ? (a) : (b))
+
+__BEGIN_NAMESPACE_ABE
+
+StringBuilder::StringBuilder(size_t capacity) : mString(""), mCapacity(0) {
+    mCapacity = mString.capacity();
+    reserve(capacity);
+}
+
+void StringBuilder::reserve(size_t n) {
+    if (n <= mCapacity) return;
+    mString.edit(n);
+    mCapacity = mString.capacity();
+}
+
+// writable room for n chars at the end
+char * StringBuilder::room(size_t n) {
+    const size_t size = mString.size();
+    if (size + n > mCapacity) {
+        // geometric growth, amortized O(1) for each char
+        reserve(MAX(size + n, mCapacity * 2));
+    }
+    return mString.edit(mCapacity) + size;
+}
+
+StringBuilder& StringBuilder::append(const char * s) {
+    CHECK_NULL(s);
+    return append(s, strlen(s));
+}
+
+StringBuilder& StringBuilder::append(const char * s, size_t n) {
+    if (n == 0) return *this;
+    const size_t size = mString.size();
+    memcpy(room(n), s, n);
+    mString.resize(size + n);
+    return *this;
+}
+
+StringBuilder& StringBuilder::append(char c) {
+    const size_t size = mString.size();
+    room(1)[0] = c;
+    mString.resize(size + 1);
+    return *this;
+}
+
+#define APPEND_NUMBER(TYPE)                                                 \
+    StringBuilder& StringBuilder::append(TYPE v) {                          \
+        const size_t size = mString.size();                                 \
+        const size_t n = ToChars(room(kNumberChars), v);                    \
+        mString.resize(size + n);                                           \
+        return *this;                                                       \
+    }
+
+APPEND_NUMBER(int32_t);
+APPEND_NUMBER(uint32_t);
+APPEND_NUMBER(int64_t);
+APPEND_NUMBER(uint64_t);
+APPEND_NUMBER(float);
+APPEND_NUMBER(double);
+#undef APPEND_NUMBER
+
+StringBuilder& StringBuilder::appendFormat(const char * format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    appendFormat(format, ap);
+    va_end(ap);
+    return *this;
+}
+
+// format into spare capacity, retry once with exact size if it is short
+StringBuilder& StringBuilder::appendFormat(const char * format, va_list ap) {
+    const size_t size = mString.size();
+    va_list copy;
+    va_copy(copy, ap);
+
+    char * buf = room(0);
+    int len = vsnprintf(buf, mCapacity - size + 1, format, ap);
+    if (len > 0 && size + len > mCapacity) {
+        buf = room(len);
+        len = vsnprintf(buf, len + 1, format, copy);
+    }
+    va_end(copy);
+
+    // restore terminating null on error
+    mString.resize(len > 0 ? size + len : size);
+    return *this;
+}
+
+void StringBuilder::clear() {
+    mString.resize(0);
+}
+
+String StringBuilder::toString() {
+    String result("");
+    result.swap(mString);
+    mCapacity = mString.capacity();
+    return result;
+}
+
+__END_NAMESPACE_ABE
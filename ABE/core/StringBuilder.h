@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    StringBuilder.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181220     initial version
+//
+
+#ifndef ABE_HEADERS_STRING_BUILDER_H
+#define ABE_HEADERS_STRING_BUILDER_H
+
+#include <ABE/core/Types.h>
+#include <ABE/core/String.h>
+
+__BEGIN_NAMESPACE_ABE
+
+/**
+ * build a string by appending in place.
+ * storage grows geometrically, so append is amortized O(1), and
+ * toString() hands the storage to the String without copy.
+ * @note short results stay in String's inline storage.
+ */
+class ABE_EXPORT StringBuilder : public NonSharedObject {
+    public:
+        /**
+         * @param capacity  initial capacity in chars
+         */
+        StringBuilder(size_t capacity = 0);
+        ~StringBuilder() { }
+
+    public:
+        StringBuilder&  append(const char * s);
+        StringBuilder&  append(const char * s, size_t n);
+        StringBuilder&  append(char c);
+        ABE_INLINE StringBuilder& append(const String& s)   { return append(s.c_str(), s.size());   }
+        /**
+         * append number in decimal, no printf, floats in shortest
+         * round trip form, same as String(v).
+         */
+        StringBuilder&  append(int32_t v);
+        StringBuilder&  append(uint32_t v);
+        StringBuilder&  append(int64_t v);
+        StringBuilder&  append(uint64_t v);
+        StringBuilder&  append(float v);
+        StringBuilder&  append(double v);
+#if defined(__clang__)
+        ABE_INLINE StringBuilder& append(size_t v)          { return append((uint64_t)v);           }
+        ABE_INLINE StringBuilder& append(ssize_t v)         { return append((int64_t)v);            }
+#endif
+        /**
+         * append formatted string, no limit on length
+         */
+        StringBuilder&  appendFormat(const char * format, ...);
+        StringBuilder&  appendFormat(const char * format, va_list ap);
+
+    public:
+        /**
+         * make sure capacity for n chars
+         */
+        void            reserve(size_t n);
+        void            clear();
+        ABE_INLINE size_t       size() const        { return mString.size();    }
+        ABE_INLINE bool         empty() const       { return size() == 0;       }
+        ABE_INLINE size_t       capacity() const    { return mCapacity;         }
+        ABE_INLINE const char * c_str() const       { return mString.c_str();   }
+
+        /**
+         * take the result, this builder is empty after
+         */
+        String          toString();
+
+    private:
+        char *          room(size_t n);
+
+        String          mString;
+        size_t          mCapacity;
+
+    private:
+        DISALLOW_EVILS(StringBuilder);
+};
+
+__END_NAMESPACE_ABE
+
+#endif // ABE_HEADERS_STRING_BUILDER_H
@@ -0,0 +1,201 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    StringView.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181225     initial version
+//
+
+#define LOG_TAG "StringView"
+#include "Log.h"
+#include "StringView.h"
+#include "Hash.h"
+#include "Number.h"
+
+#include "private/strsimd.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+
+#define MIN(a, b)   ((a) > (b) ? (b) : (a))
+
+__BEGIN_NAMESPACE_ABE
+
+StringView StringView::substring(size_t pos, size_t n) const {
+    CHECK_LE(pos, mSize);
+    if (n == 0 || n > mSize - pos) n = mSize - pos;
+    return StringView(mData + pos, n);
+}
+
+StringView StringView::trim() const {
+    size_t i = 0;
+    while (i < mSize && isspace((uint8_t)mData[i])) ++i;
+    size_t j = mSize;
+    while (j > i && isspace((uint8_t)mData[j - 1])) --j;
+    return StringView(mData + i, j - i);
+}
+
+StringView StringView::dirname() const {
+    const ssize_t slash = lastIndexOf('/');
+    if (slash < 0) return StringView();
+    // keep the root
+    return StringView(mData, slash ? slash : 1);
+}
+
+StringView StringView::basename() const {
+    const ssize_t slash = lastIndexOf('/');
+    if (slash < 0) return *this;
+    StringView last(mData + slash + 1, mSize - slash - 1);
+    const ssize_t dot = last.lastIndexOf('.');
+    if (dot < 0) return last;
+    return StringView(last.mData, dot);
+}
+
+ssize_t StringView::indexOf(size_t start, const StringView& s) const {
+    if (start > mSize) return -1;
+    const ssize_t index = str_find(mData + start, mSize - start, s.mData, s.mSize);
+    if (index < 0) return -1;
+    return start + index;
+}
+
+ssize_t StringView::indexOf(size_t start, int c) const {
+    if (start > mSize) return -1;
+    const ssize_t index = str_find_char(mData + start, mSize - start, c);
+    if (index < 0) return -1;
+    return start + index;
+}
+
+ssize_t StringView::lastIndexOf(const StringView& s) const {
+    return str_rfind(mData, mSize, s.mData, s.mSize);
+}
+
+ssize_t StringView::lastIndexOf(int c) const {
+    return str_rfind_char(mData, mSize, c);
+}
+
+int StringView::compare(const StringView& s) const {
+    const int diff = memcmp(mData, s.mData, MIN(mSize, s.mSize));
+    if (diff) return diff;
+    return mSize == s.mSize ? 0 : (mSize < s.mSize ? -1 : 1);
+}
+
+int StringView::compareIgnoreCase(const StringView& s) const {
+    const int diff = str_casecmp(mData, s.mData, MIN(mSize, s.mSize));
+    if (diff) return diff;
+    return mSize == s.mSize ? 0 : (mSize < s.mSize ? -1 : 1);
+}
+
+bool StringView::startsWith(const StringView& s) const {
+    return s.mSize <= mSize && !memcmp(mData, s.mData, s.mSize);
+}
+
+bool StringView::startsWithIgnoreCase(const StringView& s) const {
+    return s.mSize <= mSize && !str_casecmp(mData, s.mData, s.mSize);
+}
+
+bool StringView::endsWith(const StringView& s) const {
+    return s.mSize <= mSize && !memcmp(mData + mSize - s.mSize, s.mData, s.mSize);
+}
+
+bool StringView::endsWithIgnoreCase(const StringView& s) const {
+    return s.mSize <= mSize && !str_casecmp(mData + mSize - s.mSize, s.mData, s.mSize);
+}
+
+size_t StringView::hash() const {
+    return HashBytes(mData, mSize);
+}
+
+int32_t StringView::toInt32() const {
+    return (int32_t)toInt64();
+}
+
+// base 10, saturate on overflow like strtoll
+int64_t StringView::toInt64() const {
+    size_t i = 0;
+    while (i < mSize && isspace((uint8_t)mData[i])) ++i;
+
+    bool negative = false;
+    if (i < mSize && (mData[i] == '-' || mData[i] == '+')) {
+        negative = mData[i++] == '-';
+    }
+
+    const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t value = 0;
+    if (FromChars(mData + i, mSize - i, value) == 0 && i < mSize && isdigit((uint8_t)mData[i])) {
+        value = limit;  // more than 64 bits
+    }
+    if (value > limit) value = limit;
+    return negative ? (int64_t)(0 - value) : (int64_t)value;
+}
+
+// leading spaces and '+' like strtod, position of the number
+static ABE_INLINE size_t SkipFloatPrefix(const char * s, size_t n) {
+    size_t i = 0;
+    while (i < n && isspace((uint8_t)s[i])) ++i;
+    if (i + 1 < n && s[i] == '+' && s[i + 1] != '-') ++i;
+    return i;
+}
+
+// hex floats are rare, leave them to strtod
+static ABE_INLINE bool IsHexFloat(const char * s, size_t n) {
+    if (n && s[0] == '-') { ++s; --n; }
+    return n >= 2 && s[0] == '0' && (s[1] | 0x20) == 'x';
+}
+
+template <typename T> static T ParseHexFloat(const char * s, size_t n) {
+    char buf[64];
+    if (n < sizeof(buf)) {
+        memcpy(buf, s, n);
+        buf[n] = '\0';
+        return (T)strtod(buf, NULL);
+    }
+    return (T)strtod(String(s, n).c_str(), NULL);
+}
+
+float StringView::toFloat() const {
+    const size_t i = SkipFloatPrefix(mData, mSize);
+    if (IsHexFloat(mData + i, mSize - i)) {
+        return ParseHexFloat<float>(mData + i, mSize - i);
+    }
+    float v = 0;
+    FromChars(mData + i, mSize - i, v);
+    return v;
+}
+
+double StringView::toDouble() const {
+    const size_t i = SkipFloatPrefix(mData, mSize);
+    if (IsHexFloat(mData + i, mSize - i)) {
+        return ParseHexFloat<double>(mData + i, mSize - i);
+    }
+    double v = 0;
+    FromChars(mData + i, mSize - i, v);
+    return v;
+}
+
+__END_NAMESPACE_ABE
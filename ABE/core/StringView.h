@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    StringView.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181225     initial version
+//
+
+#ifndef ABE_HEADERS_STRING_VIEW_H
+#define ABE_HEADERS_STRING_VIEW_H
+
+#include <ABE/core/Types.h>
+#include <ABE/core/String.h>
+
+#include <string.h>
+
+__BEGIN_NAMESPACE_ABE
+
+/**
+ * a non-owning view of chars, pointer plus length.
+ * substring, trim & parse without allocation. String converts to it
+ * implicitly, so it can be passed wherever a read only string is wanted.
+ * @note the viewed chars MUST outlive the view.
+ * @note it is not null-terminated, there is no c_str().
+ */
+class ABE_EXPORT StringView : public NonSharedObject {
+    public:
+        ABE_INLINE StringView() : mData(""), mSize(0) { }
+        ABE_INLINE StringView(const char * s) : mData(s), mSize(strlen(s)) { }
+        ABE_INLINE StringView(const char * s, size_t n) : mData(s), mSize(n) { }
+        ABE_INLINE StringView(const String& s) : mData(s.c_str()), mSize(s.size()) { }
+
+    public:
+        ABE_INLINE const char * data() const                { return mData;         }
+        ABE_INLINE size_t       size() const                { return mSize;         }
+        ABE_INLINE bool         empty() const               { return mSize == 0;    }
+        ABE_INLINE const char&  operator[](size_t i) const  { return mData[i];      }
+        /**
+         * copy to a String
+         */
+        ABE_INLINE String       string() const              { return String(mData, mSize);  }
+
+    public:
+        /**
+         * @param n     n chars from pos, 0 to the end, same as String
+         */
+        StringView      substring(size_t pos, size_t n = 0) const;
+        StringView      trim() const;
+        StringView      dirname() const;    // without the last '/', "/" for root
+        StringView      basename() const;   // without dir & extension, same as String
+
+    public:
+        ssize_t         indexOf(size_t start, const StringView& s) const;
+        ssize_t         indexOf(size_t start, int c) const;
+        ssize_t         lastIndexOf(const StringView& s) const;
+        ssize_t         lastIndexOf(int c) const;
+
+        ABE_INLINE ssize_t indexOf(const StringView& s) const   { return indexOf(0, s); }
+        ABE_INLINE ssize_t indexOf(int c) const                 { return indexOf(0, c); }
+
+    public:
+        int             compare(const StringView& s) const;
+        int             compareIgnoreCase(const StringView& s) const;   // ascii only
+        bool            startsWith(const StringView& s) const;
+        bool            startsWithIgnoreCase(const StringView& s) const;
+        bool            endsWith(const StringView& s) const;
+        bool            endsWithIgnoreCase(const StringView& s) const;
+
+        ABE_INLINE bool equals(const StringView& s) const           { return !compare(s);           }
+        ABE_INLINE bool equalsIgnoreCase(const StringView& s) const { return !compareIgnoreCase(s); }
+
+    public:
+        /**
+         * same as String::hash() of same chars
+         */
+        size_t          hash() const;
+
+    public:
+        // same as strtol & strtod, parse from the beginning, stop at first invalid char
+        int32_t         toInt32() const;
+        int64_t         toInt64() const;
+        float           toFloat() const;
+        double          toDouble() const;
+
+    private:
+        const char *    mData;
+        size_t          mSize;
+};
+
+#define OPERATOR(op)                                                                            \
+ABE_INLINE bool operator op(const StringView& lhs, const StringView& rhs) { return lhs.compare(rhs) op 0; }
+OPERATOR(==)
+OPERATOR(!=)
+OPERATOR(<)
+OPERATOR(<=)
+OPERATOR(>)
+OPERATOR(>=)
+#undef OPERATOR
+
+__END_NAMESPACE_ABE
+
+#endif // ABE_HEADERS_STRING_VIEW_H
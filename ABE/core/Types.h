@@ -133,6 +133,12 @@
 #define ABE_DEPRECATED                  __attribute__ ((deprecated))
 #endif
 
+// hardening level, set by cmake option HARDENING
+// 2: full checks, 1: cheap checks only, 0: no redundant checks
+#ifndef ABE_HARDENING
+#define ABE_HARDENING                   2
+#endif
+
 #if defined(_MSC_VER)
 #define ABE_LIKELY(x)                   (x)
 #define ABE_UNLIKELY(x)                 !(x)
@@ -0,0 +1,344 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    heapprof.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20161012     initial version
+//
+// sampling heap profiler for production use.
+// unlike malloc.cpp, which records every block, only about one block every
+// N bytes is sampled, the interval is drawn from an exponential distribution,
+// so every byte has the same chance to be sampled. each sample is weighted
+// by size / (1 - exp(-size / N)) to estimate the real bytes.
+//
+// fast path of malloc: a counter decrement in thread local storage.
+// fast path of free: one load of a counting filter on sampled pointers.
+//
+// https://github.com/google/tcmalloc/blob/master/docs/sampling.md
+
+#ifdef HEAP_PROFILER
+#define LOG_TAG  "heapprof"
+#include "core/Log.h"
+
+#include "core/Types.h"
+#include "heapprof.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+// glibc only
+extern "C" {
+    extern __typeof (malloc)    __libc_malloc;
+    extern __typeof (calloc)    __libc_calloc;
+    extern __typeof (realloc)   __libc_realloc;
+    extern __typeof (free)      __libc_free;
+}
+
+#define MAX_DEPTH       (32)
+#define MAX_SITES       (4096)      // power of 2
+#define MAX_SAMPLES     (65536)     // power of 2, max live samples
+#define FILTER_SIZE     (65536)     // power of 2
+#define SKIP_FRAMES     (2)         // Record() & malloc()
+
+// tls used inside malloc MUST not allocate
+#define TLS             static __thread __attribute__((tls_model("initial-exec")))
+
+struct Site {
+    uint64_t    hash;       // 0: empty
+    size_t      count;
+    size_t      bytes;
+    size_t      live_count;
+    size_t      live_bytes;
+    size_t      depth;
+    bt_stack_t  stack[MAX_DEPTH];
+};
+
+struct Sample {
+    void *      ptr;        // NULL: empty
+    size_t      bytes;      // estimated bytes
+    Site *      site;
+};
+
+// all tables are static, memory is never allocated by profiler itself
+static pthread_mutex_t  g_lock = PTHREAD_MUTEX_INITIALIZER;
+static Site             g_sites[MAX_SITES];
+static Sample           g_samples[MAX_SAMPLES];
+static size_t           g_dropped;
+static volatile size_t  g_sample_bytes;         // 0: stopped
+static volatile size_t  g_live;                 // number of live samples
+static volatile uint32_t g_filter[FILTER_SIZE]; // counting filter of live samples
+
+TLS int64_t     tls_until;      // bytes until next sample
+TLS uint64_t    tls_seed;
+TLS int         tls_busy;       // avoid recursion
+
+static ABE_INLINE size_t HashPtr(const void * p) {
+    uint64_t x = (uint64_t)(uintptr_t)p;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (size_t)x;
+}
+
+static ABE_INLINE uint64_t HashStack(const bt_stack_t stack[], size_t n) {
+    uint64_t h = 14695981039346656037ULL;   // FNV-1a
+    for (size_t i = 0; i < n; ++i) {
+        h ^= (uint64_t)stack[i];
+        h *= 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+// exponential distribution with mean g_sample_bytes
+static int64_t NextInterval() {
+    if (tls_seed == 0) tls_seed = HashPtr(&tls_seed) | 1;
+    // xorshift64
+    tls_seed ^= tls_seed << 13;
+    tls_seed ^= tls_seed >> 7;
+    tls_seed ^= tls_seed << 17;
+    const double u = ((tls_seed >> 11) + 1) * (1.0 / 9007199254740993.0);  // (0, 1]
+    return (int64_t)(-log(u) * ABE_ATOMIC_LOAD(&g_sample_bytes)) + 1;
+}
+
+// with lock held
+static Site * FindSite(const bt_stack_t stack[], size_t depth) {
+    const uint64_t hash = HashStack(stack, depth);
+    for (size_t i = 0; i < MAX_SITES; ++i) {
+        Site * site = &g_sites[(hash + i) & (MAX_SITES - 1)];
+        if (site->hash == hash) return site;
+        if (site->hash == 0) {
+            site->hash  = hash;
+            site->depth = depth;
+            memcpy(site->stack, stack, depth * sizeof(bt_stack_t));
+            return site;
+        }
+    }
+    return NULL;
+}
+
+// with lock held, add a live sample
+static void Insert(const Sample& sample) {
+    size_t i = HashPtr(sample.ptr) & (MAX_SAMPLES - 1);
+    while (g_samples[i].ptr) i = (i + 1) & (MAX_SAMPLES - 1);
+    g_samples[i]                = sample;
+    sample.site->live_count     += 1;
+    sample.site->live_bytes     += sample.bytes;
+    ABE_ATOMIC_ADD(&g_filter[HashPtr(sample.ptr) & (FILTER_SIZE - 1)], 1);
+    ABE_ATOMIC_ADD(&g_live, 1);
+}
+
+static __attribute__((noinline)) void Record(void * ptr, size_t n) {
+    bt_stack_t stack[MAX_DEPTH + SKIP_FRAMES];
+    size_t depth = backtrace_stack(stack, MAX_DEPTH + SKIP_FRAMES);
+    depth = depth > SKIP_FRAMES ? depth - SKIP_FRAMES : 0;
+
+    const double mean = ABE_ATOMIC_LOAD(&g_sample_bytes);
+    const size_t bytes = n ? (size_t)(n / (1 - exp(-(double)n / mean))) : 0;
+
+    pthread_mutex_lock(&g_lock);
+    Site * site = FindSite(stack + SKIP_FRAMES, depth);
+    if (site == NULL || ABE_ATOMIC_LOAD(&g_live) >= MAX_SAMPLES / 2) {
+        ++g_dropped;
+    } else {
+        Sample sample = { ptr, bytes, site };
+        Insert(sample);
+        site->count         += 1;
+        site->bytes         += bytes;
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+// put back a sample removed by Unrecord()
+static void Restore(const Sample& sample) {
+    pthread_mutex_lock(&g_lock);
+    Insert(sample);
+    pthread_mutex_unlock(&g_lock);
+}
+
+// remove ptr from samples, if it is there, and copy it to removed.
+static void Unrecord(void * ptr, Sample * removed) {
+    pthread_mutex_lock(&g_lock);
+    size_t i = HashPtr(ptr) & (MAX_SAMPLES - 1);
+    for (; g_samples[i].ptr; i = (i + 1) & (MAX_SAMPLES - 1)) {
+        if (g_samples[i].ptr == ptr) break;
+    }
+    if (g_samples[i].ptr) {
+        if (removed) *removed = g_samples[i];
+        Site * site = g_samples[i].site;
+        site->live_count    -= 1;
+        site->live_bytes    -= g_samples[i].bytes;
+        g_samples[i].ptr    = NULL;
+        ABE_ATOMIC_SUB(&g_filter[HashPtr(ptr) & (FILTER_SIZE - 1)], 1);
+        ABE_ATOMIC_SUB(&g_live, 1);
+
+        // backward shift deletion, keep probe chains without tombstones
+        size_t j = i;
+        for (;;) {
+            j = (j + 1) & (MAX_SAMPLES - 1);
+            if (g_samples[j].ptr == NULL) break;
+            const size_t k = HashPtr(g_samples[j].ptr) & (MAX_SAMPLES - 1);
+            // move j to i if its home k is not in (i, j]
+            if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;
+            g_samples[i]        = g_samples[j];
+            g_samples[j].ptr    = NULL;
+            i = j;
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+static ABE_INLINE void MaybeRecord(void * ptr, size_t n) {
+    if (__builtin_expect(ABE_ATOMIC_LOAD(&g_sample_bytes) == 0 || ptr == NULL, 1)) return;
+    tls_until -= n;
+    if (__builtin_expect(tls_until > 0, 1)) return;
+    if (tls_busy) return;
+
+    ++tls_busy;
+    // first allocation of each thread only initializes the interval
+    if (tls_seed) Record(ptr, n);
+    tls_until = NextInterval();
+    --tls_busy;
+}
+
+static ABE_INLINE void MaybeUnrecord(void * ptr, Sample * removed = NULL) {
+    if (__builtin_expect(ABE_ATOMIC_LOAD(&g_live) == 0 || ptr == NULL, 1)) return;
+    if (ABE_ATOMIC_LOAD(&g_filter[HashPtr(ptr) & (FILTER_SIZE - 1)]) == 0) return;
+    Unrecord(ptr, removed);
+}
+
+__BEGIN_DECLS
+
+ABE_EXPORT void * malloc(size_t n) {
+    void * ptr = __libc_malloc(n);
+    MaybeRecord(ptr, n);
+    return ptr;
+}
+
+ABE_EXPORT void * calloc(size_t count, size_t n) {
+    void * ptr = __libc_calloc(count, n);
+    MaybeRecord(ptr, count * n);
+    return ptr;
+}
+
+ABE_EXPORT void * realloc(void * ptr, size_t n) {
+    // unrecord before the old block is released, as free() does,
+    // or a malloc of the same address by other thread loses its sample
+    Sample old = { NULL, 0, NULL };
+    MaybeUnrecord(ptr, &old);
+    void * _ptr = __libc_realloc(ptr, n);
+    if (_ptr == NULL && n) {
+        // on failure the old block is still alive, put its sample back
+        if (old.ptr) Restore(old);
+        return NULL;
+    }
+    MaybeRecord(_ptr, n);
+    return _ptr;
+}
+
+ABE_EXPORT void free(void * ptr) {
+    MaybeUnrecord(ptr);
+    __libc_free(ptr);
+}
+
+void heap_profile_start(size_t sample_bytes) {
+    if (sample_bytes == 0) return heap_profile_stop();
+    INFO("heap profile start, sample every %zu bytes", sample_bytes);
+    ABE_ATOMIC_STORE(&g_sample_bytes, sample_bytes);
+}
+
+void heap_profile_stop() {
+    ABE_ATOMIC_STORE(&g_sample_bytes, (size_t)0);
+}
+
+size_t heap_profile_report(heap_profile_site_t sites[], size_t max) {
+    size_t n = 0;
+    pthread_mutex_lock(&g_lock);
+    for (size_t i = 0; i < MAX_SITES; ++i) {
+        const Site& site = g_sites[i];
+        if (site.hash == 0) continue;
+
+        // insertion sort by live bytes
+        size_t j = n < max ? n++ : max;
+        while (j > 0 && sites[j - 1].live_bytes < site.live_bytes) {
+            if (j < max) sites[j] = sites[j - 1];
+            --j;
+        }
+        if (j >= max) continue;
+        sites[j].count      = site.count;
+        sites[j].bytes      = site.bytes;
+        sites[j].live_count = site.live_count;
+        sites[j].live_bytes = site.live_bytes;
+        sites[j].depth      = site.depth;
+        memcpy(sites[j].stack, site.stack, site.depth * sizeof(bt_stack_t));
+    }
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
+
+void heap_profile_dump(size_t max) {
+    heap_profile_site_t * sites = (heap_profile_site_t *)malloc(max * sizeof(heap_profile_site_t));
+    const size_t n = heap_profile_report(sites, max);
+    size_t live = 0;
+    INFO("===============================================================");
+    INFO("== heap profile, sample every %zu bytes, %zu samples dropped",
+            ABE_ATOMIC_LOAD(&g_sample_bytes), g_dropped);
+    for (size_t i = 0; i < n; ++i) {
+        INFO("== #%zu: %zu bytes in use (%zu), %zu bytes allocated (%zu)",
+                i, sites[i].live_bytes, sites[i].live_count, sites[i].bytes, sites[i].count);
+        backtrace_symbols(sites[i].stack, sites[i].depth);
+        live += sites[i].live_bytes;
+    }
+    INFO("== total %zu bytes in use by top %zu sites", live, n);
+    INFO("===============================================================");
+    free(sites);
+}
+
+__END_DECLS
+
+// start by environment
+static __attribute__((constructor)) void heap_profile_init() {
+    const char * env = getenv("ABE_HEAP_PROFILE");
+    // log system may not ready yet
+    if (env && atol(env) > 0) ABE_ATOMIC_STORE(&g_sample_bytes, (size_t)atol(env));
+}
+
+#else
+
+#include "core/Types.h"
+#include "heapprof.h"
+__BEGIN_DECLS
+void heap_profile_start(size_t) { }
+void heap_profile_stop(void) { }
+size_t heap_profile_report(heap_profile_site_t *, size_t) { return 0; }
+void heap_profile_dump(size_t) { }
+__END_DECLS
+
+#endif
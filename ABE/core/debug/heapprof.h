@@ -0,0 +1,71 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    heapprof.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20161012     initial version
+//
+
+#ifndef __toolkit_heapprof_h
+#define __toolkit_heapprof_h
+
+#include <ABE/core/debug/backtrace.h>
+
+__BEGIN_DECLS
+
+// sampling heap profiler, linux only, built with -DHEAP_PROFILER=ON.
+// allocations are sampled about one every sample_bytes bytes, and
+// aggregated by call stack. set environment ABE_HEAP_PROFILE=<bytes>
+// to start it at load time.
+
+typedef struct heap_profile_site {
+    size_t      count;          // sampled allocations
+    size_t      bytes;          // estimated bytes allocated
+    size_t      live_count;     // sampled allocations not freed yet
+    size_t      live_bytes;     // estimated bytes in use
+    size_t      depth;
+    bt_stack_t  stack[32];
+} heap_profile_site_t;
+
+// start sampling, sample_bytes is the mean interval in bytes, 0 to stop.
+// 2M bytes is a good start, each sample costs a stack unwind.
+ABE_EXPORT void     heap_profile_start(size_t sample_bytes);
+
+// stop sampling, frees of sampled blocks are still tracked
+ABE_EXPORT void     heap_profile_stop(void);
+
+// copy at most max call sites, sorted by live bytes, return number of sites
+ABE_EXPORT size_t   heap_profile_report(heap_profile_site_t sites[], size_t max);
+
+// print top max call sites into log system
+ABE_EXPORT void     heap_profile_dump(size_t max);
+
+__END_DECLS
+
+#endif // __toolkit_heapprof_h
@@ -0,0 +1,343 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    strsimd.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181210     initial version
+//
+
+#include "Config.h"
+#include "core/System.h"
+#include "strsimd.h"
+#include "strsimd_kernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_NEON   1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+#if defined(__SSE2__)
+    struct SSE2 {
+        typedef __m128i type;
+        enum { kWidth = 16, kBitsPerByte = 1, kShuffle = 0 };
+        static const uint64_t kAll = 0xffff;
+
+        STR_INLINE type load(const char * p)     { return _mm_loadu_si128((const __m128i *)p);  }
+        STR_INLINE void store(char * p, type v)  { _mm_storeu_si128((__m128i *)p, v);           }
+        STR_INLINE type set1(char c)             { return _mm_set1_epi8(c);                     }
+        STR_INLINE type eq(type a, type b)       { return _mm_cmpeq_epi8(a, b);                 }
+        STR_INLINE type and_(type a, type b)     { return _mm_and_si128(a, b);                  }
+        STR_INLINE type add(type a, type b)      { return _mm_add_epi8(a, b);                   }
+        // no unsigned compare in sse2, move [lo, lo + n) to [-128, -128 + n)
+        struct Range {
+            type shift, limit;
+            Range(char lo, char n) : shift(_mm_set1_epi8((char)(0x80 - lo))),
+                    limit(_mm_set1_epi8((char)(-128 + n))) { }
+        };
+        STR_INLINE type in(type v, const Range& r) {
+            return _mm_cmplt_epi8(_mm_add_epi8(v, r.shift), r.limit);
+        }
+        STR_INLINE uint64_t bits(type m)         { return (uint32_t)_mm_movemask_epi8(m);       }
+
+        STR_INLINE bool ascii(type v)            { return !_mm_movemask_epi8(v);                }
+        template <bool BE> STR_INLINE void widen(char * p, type v) {
+            const type zero = _mm_setzero_si128();
+            store(p,      BE ? _mm_unpacklo_epi8(zero, v) : _mm_unpacklo_epi8(v, zero));
+            store(p + 16, BE ? _mm_unpackhi_epi8(zero, v) : _mm_unpackhi_epi8(v, zero));
+        }
+        template <bool BE> STR_INLINE bool narrow(char * p, const char * s) {
+            type a = load(s);
+            type b = load(s + 16);
+            if (BE) {
+                a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+                b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+            }
+            const type high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16((short)0xFF80));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF) return false;
+            store(p, _mm_packus_epi16(a, b));
+            return true;
+        }
+    };
+#endif
+
+#if defined(HAVE_NEON)
+    struct NEON {
+        typedef uint8x16_t type;
+#if defined(__aarch64__)
+        enum { kWidth = 16, kBitsPerByte = 4, kShuffle = 1 };
+#else
+        enum { kWidth = 16, kBitsPerByte = 4, kShuffle = 0 };
+#endif
+        static const uint64_t kAll = 0x8888888888888888ULL;
+
+        STR_INLINE type load(const char * p)     { return vld1q_u8((const uint8_t *)p);         }
+        STR_INLINE void store(char * p, type v)  { vst1q_u8((uint8_t *)p, v);                   }
+        STR_INLINE type set1(char c)             { return vdupq_n_u8((uint8_t)c);               }
+        STR_INLINE type eq(type a, type b)       { return vceqq_u8(a, b);                       }
+        STR_INLINE type and_(type a, type b)     { return vandq_u8(a, b);                       }
+        STR_INLINE type add(type a, type b)      { return vaddq_u8(a, b);                       }
+        struct Range {
+            type lo, n;
+            Range(char _lo, char _n) : lo(vdupq_n_u8((uint8_t)_lo)), n(vdupq_n_u8((uint8_t)_n)) { }
+        };
+        STR_INLINE type in(type v, const Range& r) {
+            return vcltq_u8(vsubq_u8(v, r.lo), r.n);
+        }
+        // no movemask in neon, narrow each byte to a nibble
+        STR_INLINE uint64_t bits(type m) {
+            uint8x8_t x = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+            return vget_lane_u64(vreinterpret_u64_u8(x), 0) & kAll;
+        }
+
+        STR_INLINE bool any(type v) {
+            uint64x2_t x = vreinterpretq_u64_u8(v);
+            return (vgetq_lane_u64(x, 0) | vgetq_lane_u64(x, 1)) != 0;
+        }
+        STR_INLINE bool ascii(type v)            { return !any(vandq_u8(v, vdupq_n_u8(0x80)));  }
+        template <bool BE> STR_INLINE void widen(char * p, type v) {
+            uint8x16x2_t x;
+            x.val[BE ? 1 : 0] = v;
+            x.val[BE ? 0 : 1] = vdupq_n_u8(0);
+            vst2q_u8((uint8_t *)p, x);
+        }
+        template <bool BE> STR_INLINE bool narrow(char * p, const char * s) {
+            uint8x16x2_t x = vld2q_u8((const uint8_t *)s);
+            const type low = x.val[BE ? 1 : 0];
+            if (any(vorrq_u8(x.val[BE ? 0 : 1], vandq_u8(low, vdupq_n_u8(0x80))))) return false;
+            store(p, low);
+            return true;
+        }
+
+#if defined(__aarch64__)
+        STR_INLINE type or_(type a, type b)      { return vorrq_u8(a, b);                       }
+        STR_INLINE type xor_(type a, type b)     { return veorq_u8(a, b);                       }
+        STR_INLINE type subs(type a, type b)     { return vqsubq_u8(a, b);                      }
+        STR_INLINE type shr4(type v)             { return vshrq_n_u8(v, 4);                     }
+        STR_INLINE type table(const uint8_t * t) { return vld1q_u8(t);                          }
+        STR_INLINE type lookup(type t, type i)   { return vqtbl1q_u8(t, i);                     }
+        // bytes of v shifted by N, with last N bytes of p shifted in
+        template <int N> STR_INLINE type prev(type v, type p) { return vextq_u8(p, v, 16 - N);  }
+#endif
+    };
+#endif
+
+    // plain c fallback
+    static ssize_t ScalarFindChar(const char * s, size_t n, int c) {
+        const char * p = (const char *)memchr(s, c, n);
+        return p ? p - s : -1;
+    }
+
+    static ssize_t ScalarRFindChar(const char * s, size_t n, int c) {
+        while (n--) {
+            if (s[n] == (char)c) return n;
+        }
+        return -1;
+    }
+
+    static ssize_t ScalarFind(const char * s, size_t n, const char * p, size_t m) {
+        if (m == 0) return 0;
+        for (size_t i = 0; i + m <= n; ++i) {
+            if (s[i] == p[0] && !memcmp(s + i, p, m)) return i;
+        }
+        return -1;
+    }
+
+    static ssize_t ScalarRFind(const char * s, size_t n, const char * p, size_t m) {
+        if (m == 0) return n;
+        if (m > n) return -1;
+        for (size_t i = n - m + 1; i--; ) {
+            if (s[i] == p[0] && !memcmp(s + i, p, m)) return i;
+        }
+        return -1;
+    }
+
+    static int ScalarCaseCmp(const char * a, const char * b, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            const int diff = ToLower((uint8_t)a[i]) - ToLower((uint8_t)b[i]);
+            if (diff) return diff;
+        }
+        return 0;
+    }
+
+    static void ScalarLower(char * s, size_t n) {
+        for (size_t i = 0; i < n; ++i) s[i] = ToLower((uint8_t)s[i]);
+    }
+
+    static void ScalarUpper(char * s, size_t n) {
+        for (size_t i = 0; i < n; ++i) s[i] = ToUpper((uint8_t)s[i]);
+    }
+
+    static int ScalarUtf8Valid(const char * s, size_t n) {
+        return n == 0 || Utf8Skip((const uint8_t *)s, n, 0, n) != 0;
+    }
+
+    template <bool BE> static ssize_t ScalarUtf8ToUtf16(const char * s, size_t n, char * out) {
+        if (!ScalarUtf8Valid(s, n)) return -1;
+        char * p = out;
+        for (size_t i = 0; i < n; ) p = Utf8ToUtf16One<BE>((const uint8_t *)s, i, p);
+        return (p - out) / 2;
+    }
+
+    template <bool BE> static ssize_t ScalarUtf16ToUtf8(const char * s, size_t n, char * out) {
+        char * p = out;
+        for (size_t i = 0; i < n; ) {
+            if ((p = Utf16ToUtf8One<BE>(s, n, i, p)) == NULL) return -1;
+        }
+        return p - out;
+    }
+
+    static ssize_t ScalarUtf8ToUtf16(const char * s, size_t n, char * out, int be) {
+        return be ? ScalarUtf8ToUtf16<true>(s, n, out) : ScalarUtf8ToUtf16<false>(s, n, out);
+    }
+
+    static ssize_t ScalarUtf16ToUtf8(const char * s, size_t n, char * out, int be) {
+        return be ? ScalarUtf16ToUtf8<true>(s, n, out) : ScalarUtf16ToUtf8<false>(s, n, out);
+    }
+
+    static const StrKernels kScalar = {
+        ScalarFindChar, ScalarRFindChar, ScalarFind, ScalarRFind,
+        ScalarCaseCmp, ScalarLower, ScalarUpper,
+        ScalarUtf8Valid, ScalarUtf8ToUtf16, ScalarUtf16ToUtf8
+    };
+
+    // NULL if level is not supported
+    static const StrKernels * KernelsOf(int level) {
+        switch (level) {
+            case STR_SIMD_NONE:
+                return &kScalar;
+#if defined(__SSE2__)
+            case STR_SIMD_SSE2:
+                return Kernels<SSE2>();
+#endif
+#if defined(HAVE_AVX2)
+            case STR_SIMD_AVX2:
+                __builtin_cpu_init();   // may run before constructors
+                return __builtin_cpu_supports("avx2") ? StrKernelsAVX2() : NULL;
+#endif
+#if defined(HAVE_NEON)
+            case STR_SIMD_NEON:
+                return Kernels<NEON>();
+#endif
+            default:
+                return NULL;
+        }
+    }
+
+    static const char * kLevelNames[] = { "none", "sse2", "avx2", "neon" };
+
+    static str_simd_level_t         gLevel      = STR_SIMD_NONE;
+    static const StrKernels *       gKernels    = NULL;
+
+    static const StrKernels * Select() {
+        int level = STR_SIMD_NONE;
+        const char * name = GetEnvironmentValue("ABE_SIMD");
+        for (int i = STR_SIMD_NONE; i <= STR_SIMD_NEON; ++i) {
+            if (!strcmp(name, kLevelNames[i]) && KernelsOf(i)) {
+                level = i;
+                break;
+            }
+            // best one
+            if (!*name && KernelsOf(i)) level = i;
+        }
+
+        const StrKernels * kernels = KernelsOf(level);
+        gLevel = (str_simd_level_t)level;
+        ABE_ATOMIC_STORE(&gKernels, kernels);
+        return kernels;
+    }
+
+    static inline const StrKernels * Current() {
+        const StrKernels * kernels = ABE_ATOMIC_LOAD(&gKernels);
+        if (kernels == NULL) kernels = Select();
+        return kernels;
+    }
+
+}
+
+__BEGIN_DECLS
+
+str_simd_level_t str_simd_level(void) {
+    Current();
+    return gLevel;
+}
+
+str_simd_level_t str_simd_set_level(str_simd_level_t level) {
+    const StrKernels * kernels = KernelsOf(level);
+    if (kernels) {
+        gLevel = level;
+        ABE_ATOMIC_STORE(&gKernels, kernels);
+    }
+    return str_simd_level();
+}
+
+ssize_t str_find_char(const char * s, size_t n, int c) {
+    return Current()->find_char(s, n, c);
+}
+
+ssize_t str_rfind_char(const char * s, size_t n, int c) {
+    return Current()->rfind_char(s, n, c);
+}
+
+ssize_t str_find(const char * s, size_t n, const char * p, size_t m) {
+    return Current()->find(s, n, p, m);
+}
+
+ssize_t str_rfind(const char * s, size_t n, const char * p, size_t m) {
+    return Current()->rfind(s, n, p, m);
+}
+
+int str_casecmp(const char * a, const char * b, size_t n) {
+    return Current()->casecmp(a, b, n);
+}
+
+void str_lower(char * s, size_t n) {
+    Current()->lower(s, n);
+}
+
+void str_upper(char * s, size_t n) {
+    Current()->upper(s, n);
+}
+
+int str_utf8_valid(const char * s, size_t n) {
+    return Current()->utf8_valid(s, n);
+}
+
+ssize_t str_utf8_to_utf16(const char * s, size_t n, char * out, int be) {
+    return Current()->utf8_to_utf16(s, n, out, be);
+}
+
+ssize_t str_utf16_to_utf8(const char * s, size_t n, char * out, int be) {
+    return Current()->utf16_to_utf8(s, n, out, be);
+}
+
+__END_DECLS
@@ -0,0 +1,91 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    strsimd.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181210     initial version
+//
+
+#ifndef __toolkit_strsimd_h
+#define __toolkit_strsimd_h
+
+#include <ABE/core/Types.h>
+
+__BEGIN_DECLS
+
+// string kernels for String, with sse2/avx2/neon implementations
+// selected at runtime by cpu features, plain c code as fallback.
+// set environment ABE_SIMD=none|sse2|avx2|neon to force a level.
+// strings are given by pointer & length, '\0' is not special.
+
+typedef enum str_simd_level {
+    STR_SIMD_NONE,
+    STR_SIMD_SSE2,
+    STR_SIMD_AVX2,
+    STR_SIMD_NEON
+} str_simd_level_t;
+
+// current level
+ABE_EXPORT str_simd_level_t str_simd_level(void);
+
+// switch to level if supported by cpu, return the level in use.
+// for test & benchmark, not thread safe with kernels.
+ABE_EXPORT str_simd_level_t str_simd_set_level(str_simd_level_t level);
+
+// index of first/last c in s[0, n), or -1
+ABE_EXPORT ssize_t  str_find_char(const char * s, size_t n, int c);
+ABE_EXPORT ssize_t  str_rfind_char(const char * s, size_t n, int c);
+
+// index of first/last p[0, m) in s[0, n), or -1
+ABE_EXPORT ssize_t  str_find(const char * s, size_t n, const char * p, size_t m);
+ABE_EXPORT ssize_t  str_rfind(const char * s, size_t n, const char * p, size_t m);
+
+// compare n bytes ignoring ascii case, return difference of first
+// mismatched bytes after lower, like strncasecmp in "C" locale.
+ABE_EXPORT int      str_casecmp(const char * a, const char * b, size_t n);
+
+// ascii lower & upper in place
+ABE_EXPORT void     str_lower(char * s, size_t n);
+ABE_EXPORT void     str_upper(char * s, size_t n);
+
+// return 1 if s[0, n) is well-formed utf8
+ABE_EXPORT int      str_utf8_valid(const char * s, size_t n);
+
+// utf8 s[0, n) to utf16 LE or BE by be, out holds at least n units.
+// return units written, or -1 if s is not well-formed utf8.
+ABE_EXPORT ssize_t  str_utf8_to_utf16(const char * s, size_t n, char * out, int be);
+
+// utf16 s[0, n units) to utf8, out holds at least 3 * n bytes.
+// unpaired surrogates are encoded as is, like lenient ConvertUTF.
+// return bytes written, or -1 if s ends with a high surrogate.
+ABE_EXPORT ssize_t  str_utf16_to_utf8(const char * s, size_t n, char * out, int be);
+
+__END_DECLS
+
+#endif // __toolkit_strsimd_h
@@ -0,0 +1,108 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    strsimd_avx2.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181210     initial version
+//
+
+// built with -mavx2, only called when cpu supports avx2.
+// DO NOT include ABE headers here, see strsimd_kernels.h
+#include "strsimd_kernels.h"
+
+#include <immintrin.h>
+
+namespace {
+
+    struct AVX2 {
+        typedef __m256i type;
+        enum { kWidth = 32, kBitsPerByte = 1, kShuffle = 1 };
+        static const uint64_t kAll = 0xffffffff;
+
+        STR_INLINE type load(const char * p)     { return _mm256_loadu_si256((const __m256i *)p);   }
+        STR_INLINE void store(char * p, type v)  { _mm256_storeu_si256((__m256i *)p, v);            }
+        STR_INLINE type set1(char c)             { return _mm256_set1_epi8(c);                      }
+        STR_INLINE type eq(type a, type b)       { return _mm256_cmpeq_epi8(a, b);                  }
+        STR_INLINE type and_(type a, type b)     { return _mm256_and_si256(a, b);                   }
+        STR_INLINE type add(type a, type b)      { return _mm256_add_epi8(a, b);                    }
+        // signed compare only, move [lo, lo + n) to [-128, -128 + n)
+        struct Range {
+            type shift, limit;
+            Range(char lo, char n) : shift(_mm256_set1_epi8((char)(0x80 - lo))),
+                    limit(_mm256_set1_epi8((char)(-128 + n))) { }
+        };
+        STR_INLINE type in(type v, const Range& r) {
+            return _mm256_cmpgt_epi8(r.limit, _mm256_add_epi8(v, r.shift));
+        }
+        STR_INLINE uint64_t bits(type m)         { return (uint32_t)_mm256_movemask_epi8(m);        }
+
+        STR_INLINE bool ascii(type v)            { return !_mm256_movemask_epi8(v);                 }
+        // unpack & pack work in 128 bits lanes, fix the order by permute
+        template <bool BE> STR_INLINE void widen(char * p, type v) {
+            const type zero = _mm256_setzero_si256();
+            const type lo = BE ? _mm256_unpacklo_epi8(zero, v) : _mm256_unpacklo_epi8(v, zero);
+            const type hi = BE ? _mm256_unpackhi_epi8(zero, v) : _mm256_unpackhi_epi8(v, zero);
+            store(p,      _mm256_permute2x128_si256(lo, hi, 0x20));
+            store(p + 32, _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+        template <bool BE> STR_INLINE bool narrow(char * p, const char * s) {
+            type a = load(s);
+            type b = load(s + 32);
+            if (BE) {
+                a = _mm256_or_si256(_mm256_slli_epi16(a, 8), _mm256_srli_epi16(a, 8));
+                b = _mm256_or_si256(_mm256_slli_epi16(b, 8), _mm256_srli_epi16(b, 8));
+            }
+            const type high = _mm256_and_si256(_mm256_or_si256(a, b), _mm256_set1_epi16((short)0xFF80));
+            if (!_mm256_testz_si256(high, high)) return false;
+            store(p, _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+            return true;
+        }
+
+        STR_INLINE type or_(type a, type b)      { return _mm256_or_si256(a, b);                    }
+        STR_INLINE type xor_(type a, type b)     { return _mm256_xor_si256(a, b);                   }
+        STR_INLINE type subs(type a, type b)     { return _mm256_subs_epu8(a, b);                   }
+        STR_INLINE bool any(type v)              { return !_mm256_testz_si256(v, v);                }
+        STR_INLINE type shr4(type v) {
+            return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+        }
+        STR_INLINE type table(const uint8_t * t) {
+            return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)t));
+        }
+        STR_INLINE type lookup(type t, type i)   { return _mm256_shuffle_epi8(t, i);               }
+        // bytes of v shifted by N, with last N bytes of p shifted in
+        template <int N> STR_INLINE type prev(type v, type p) {
+            return _mm256_alignr_epi8(v, _mm256_permute2x128_si256(p, v, 0x21), 16 - N);
+        }
+    };
+
+}
+
+const StrKernels * StrKernelsAVX2() {
+    return Kernels<AVX2>();
+}
@@ -0,0 +1,541 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+// File:    strsimd_kernels.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20181210     initial version
+//
+
+// kernels of strsimd, included by each implementation with a
+// vector traits V, which is compiled with its own cpu flags:
+//  V::kWidth           bytes of a vector
+//  V::kBitsPerByte     bits of V::bits() for each byte, only the top one is set
+//  V::kAll             V::bits() of all bytes
+//  V::load/store/set1/eq/and_/add
+//  V::Range(lo, n)     vectors for V::in(), prepared once per call
+//  V::in(v, range)     mask of bytes in [lo, lo + n)
+//  V::bits(mask)       bitmask of a compare mask, byte 0 at lsb
+//  V::ascii(v)         true if all bytes < 0x80
+//  V::widen<BE>(p, v)  store bytes as 2 * kWidth bytes of utf16
+//  V::narrow<BE>(p, s) store kWidth utf16 units as bytes if all < 0x80
+//  V::kShuffle         has the following for utf8 validation:
+//  V::table/lookup/shr4/prev<N>/subs/or_/xor_/any
+// private to strsimd, DO NOT include it elsewhere.
+
+#ifndef __toolkit_strsimd_kernels_h
+#define __toolkit_strsimd_kernels_h
+
+// no ABE headers here, inline functions of them may be emitted with
+// the cpu flags of an implementation and picked by linker.
+#include <stdint.h>
+#include <sys/types.h>
+#include <string.h>
+
+// inline even without optimization, or each vector op is a call
+#if defined(_MSC_VER)
+#define STR_INLINE  static __forceinline
+#else
+#define STR_INLINE  static inline __attribute__((__always_inline__))
+#endif
+
+struct StrKernels {
+    ssize_t (*find_char)(const char *, size_t, int);
+    ssize_t (*rfind_char)(const char *, size_t, int);
+    ssize_t (*find)(const char *, size_t, const char *, size_t);
+    ssize_t (*rfind)(const char *, size_t, const char *, size_t);
+    int     (*casecmp)(const char *, const char *, size_t);
+    void    (*lower)(char *, size_t);
+    void    (*upper)(char *, size_t);
+    int     (*utf8_valid)(const char *, size_t);
+    ssize_t (*utf8_to_utf16)(const char *, size_t, char *, int);
+    ssize_t (*utf16_to_utf8)(const char *, size_t, char *, int);
+};
+
+// implemented by strsimd_avx2.cpp, built with HAVE_AVX2
+const StrKernels * StrKernelsAVX2();
+
+// anonymous namespace: each implementation has its own copy
+namespace {
+
+    STR_INLINE int ToLower(int c) { return (c >= 'A' && c <= 'Z') ? c + 0x20 : c; }
+    STR_INLINE int ToUpper(int c) { return (c >= 'a' && c <= 'z') ? c - 0x20 : c; }
+
+    template <class V> STR_INLINE size_t First(uint64_t bits) {
+        return __builtin_ctzll(bits) / V::kBitsPerByte;
+    }
+
+    template <class V> STR_INLINE size_t Last(uint64_t bits) {
+        return (63 - __builtin_clzll(bits)) / V::kBitsPerByte;
+    }
+
+    template <class V> STR_INLINE uint64_t ClearLast(uint64_t bits) {
+        return bits & ~(1ULL << (63 - __builtin_clzll(bits)));
+    }
+
+    // add delta to letters from lo
+    template <class V> struct CaseFold {
+        typename V::Range   range;
+        typename V::type    delta;
+        CaseFold(char lo, char d) : range(lo, 26), delta(V::set1(d)) { }
+    };
+
+    template <class V> STR_INLINE typename V::type Fold(typename V::type v, const CaseFold<V>& fold) {
+        return V::add(v, V::and_(V::in(v, fold.range), fold.delta));
+    }
+
+    template <class V> static ssize_t FindChar(const char * s, size_t n, int c) {
+        const typename V::type k = V::set1((char)c);
+        size_t i = 0;
+        for (; i + V::kWidth <= n; i += V::kWidth) {
+            uint64_t bits = V::bits(V::eq(V::load(s + i), k));
+            if (bits) return i + First<V>(bits);
+        }
+        for (; i < n; ++i) {
+            if (s[i] == (char)c) return i;
+        }
+        return -1;
+    }
+
+    template <class V> static ssize_t RFindChar(const char * s, size_t n, int c) {
+        const typename V::type k = V::set1((char)c);
+        size_t i = n;
+        while (i >= V::kWidth) {
+            i -= V::kWidth;
+            uint64_t bits = V::bits(V::eq(V::load(s + i), k));
+            if (bits) return i + Last<V>(bits);
+        }
+        while (i--) {
+            if (s[i] == (char)c) return i;
+        }
+        return -1;
+    }
+
+    // compare first & last byte of p at kWidth positions at once,
+    // then verify candidates with memcmp.
+    template <class V> static ssize_t Find(const char * s, size_t n, const char * p, size_t m) {
+        if (m == 0) return 0;
+        if (m > n) return -1;
+        if (m == 1) return FindChar<V>(s, n, p[0]);
+
+        const typename V::type first = V::set1(p[0]);
+        const typename V::type last = V::set1(p[m - 1]);
+        size_t i = 0;
+        for (; i + m - 1 + V::kWidth <= n; i += V::kWidth) {
+            uint64_t bits = V::bits(V::and_(V::eq(V::load(s + i), first),
+                        V::eq(V::load(s + i + m - 1), last)));
+            while (bits) {
+                const size_t j = i + First<V>(bits);
+                if (!memcmp(s + j + 1, p + 1, m - 2)) return j;
+                bits &= bits - 1;
+            }
+        }
+        for (; i + m <= n; ++i) {
+            if (s[i] == p[0] && !memcmp(s + i + 1, p + 1, m - 1)) return i;
+        }
+        return -1;
+    }
+
+    template <class V> static ssize_t RFind(const char * s, size_t n, const char * p, size_t m) {
+        if (m == 0) return n;
+        if (m > n) return -1;
+        if (m == 1) return RFindChar<V>(s, n, p[0]);
+
+        const typename V::type first = V::set1(p[0]);
+        const typename V::type last = V::set1(p[m - 1]);
+        size_t i = n - m + 1;   // candidates in [0, i)
+        while (i >= V::kWidth) {
+            i -= V::kWidth;
+            uint64_t bits = V::bits(V::and_(V::eq(V::load(s + i), first),
+                        V::eq(V::load(s + i + m - 1), last)));
+            while (bits) {
+                const size_t j = i + Last<V>(bits);
+                if (!memcmp(s + j + 1, p + 1, m - 2)) return j;
+                bits = ClearLast<V>(bits);
+            }
+        }
+        while (i--) {
+            if (s[i] == p[0] && !memcmp(s + i + 1, p + 1, m - 1)) return i;
+        }
+        return -1;
+    }
+
+    template <class V> static int CaseCmp(const char * a, const char * b, size_t n) {
+        const CaseFold<V> lower('A', 0x20);
+        size_t i = 0;
+        for (; i + V::kWidth <= n; i += V::kWidth) {
+            uint64_t bits = V::bits(V::eq(Fold<V>(V::load(a + i), lower),
+                        Fold<V>(V::load(b + i), lower))) ^ V::kAll;
+            if (bits) {
+                i += First<V>(bits);
+                return ToLower((uint8_t)a[i]) - ToLower((uint8_t)b[i]);
+            }
+        }
+        for (; i < n; ++i) {
+            const int diff = ToLower((uint8_t)a[i]) - ToLower((uint8_t)b[i]);
+            if (diff) return diff;
+        }
+        return 0;
+    }
+
+    template <class V> static void LowerString(char * s, size_t n) {
+        const CaseFold<V> lower('A', 0x20);
+        size_t i = 0;
+        for (; i + V::kWidth <= n; i += V::kWidth) {
+            V::store(s + i, Fold<V>(V::load(s + i), lower));
+        }
+        for (; i < n; ++i) s[i] = ToLower((uint8_t)s[i]);
+    }
+
+    template <class V> static void UpperString(char * s, size_t n) {
+        const CaseFold<V> upper('a', (char)0xe0);   // -0x20
+        size_t i = 0;
+        for (; i + V::kWidth <= n; i += V::kWidth) {
+            V::store(s + i, Fold<V>(V::load(s + i), upper));
+        }
+        for (; i < n; ++i) s[i] = ToUpper((uint8_t)s[i]);
+    }
+
+    // utf16 unit at p, unaligned
+    template <bool BE> STR_INLINE uint32_t Load16(const char * p) {
+        const uint8_t * u = (const uint8_t *)p;
+        return BE ? (u[0] << 8) | u[1] : u[0] | (u[1] << 8);
+    }
+
+    template <bool BE> STR_INLINE void Store16(char * p, uint32_t v) {
+        p[BE ? 0 : 1] = (char)(v >> 8);
+        p[BE ? 1 : 0] = (char)v;
+    }
+
+    // length of the well-formed sequence at s, or 0. Unicode Table 3-7,
+    // same as isLegalUTF8 of ConvertUTF.
+    STR_INLINE size_t Utf8Length(const uint8_t * s, size_t n) {
+        const uint8_t c = s[0];
+        if (c < 0x80) return 1;
+        if (c < 0xC2) return 0;
+        if (c < 0xE0) return (n >= 2 && (s[1] & 0xC0) == 0x80) ? 2 : 0;
+        if (c < 0xF0) {
+            const uint8_t lo = c == 0xE0 ? 0xA0 : 0x80;
+            const uint8_t hi = c == 0xED ? 0x9F : 0xBF;
+            return (n >= 3 && s[1] >= lo && s[1] <= hi && (s[2] & 0xC0) == 0x80) ? 3 : 0;
+        }
+        if (c < 0xF5) {
+            const uint8_t lo = c == 0xF0 ? 0x90 : 0x80;
+            const uint8_t hi = c == 0xF4 ? 0x8F : 0xBF;
+            return (n >= 4 && s[1] >= lo && s[1] <= hi &&
+                    (s[2] & 0xC0) == 0x80 && (s[3] & 0xC0) == 0x80) ? 4 : 0;
+        }
+        return 0;
+    }
+
+    // validate sequences starting in [i, end), return position after them or 0
+    STR_INLINE size_t Utf8Skip(const uint8_t * s, size_t n, size_t i, size_t end) {
+        while (i < end) {
+            const size_t length = Utf8Length(s + i, n - i);
+            if (length == 0) return 0;
+            i += length;
+        }
+        return i;
+    }
+
+    // decode one code point of well-formed utf8 to utf16
+    template <bool BE> STR_INLINE char * Utf8ToUtf16One(const uint8_t * s, size_t& i, char * p) {
+        const uint32_t c = s[i];
+        if (c < 0x80) {
+            Store16<BE>(p, c);
+            i += 1;
+        } else if (c < 0xE0) {
+            Store16<BE>(p, ((c & 0x1F) << 6) | (s[i + 1] & 0x3F));
+            i += 2;
+        } else if (c < 0xF0) {
+            Store16<BE>(p, ((c & 0x0F) << 12) | ((s[i + 1] & 0x3F) << 6) | (s[i + 2] & 0x3F));
+            i += 3;
+        } else {
+            const uint32_t x = (((c & 0x07) << 18) | ((s[i + 1] & 0x3F) << 12) |
+                    ((s[i + 2] & 0x3F) << 6) | (s[i + 3] & 0x3F)) - 0x10000;
+            Store16<BE>(p, 0xD800 + (x >> 10));
+            Store16<BE>(p + 2, 0xDC00 + (x & 0x3FF));
+            i += 4;
+            return p + 4;
+        }
+        return p + 2;
+    }
+
+    // encode one code point of utf16 to utf8, return NULL if truncated.
+    // unpaired surrogates are encoded as is, same as lenientConversion
+    // of ConvertUTF.
+    template <bool BE> STR_INLINE char * Utf16ToUtf8One(const char * s, size_t n, size_t& i, char * p) {
+        uint32_t c = Load16<BE>(s + 2 * i++);
+        if (c < 0x80) {
+            *p++ = (char)c;
+            return p;
+        }
+        if (c < 0x800) {
+            *p++ = (char)(0xC0 | (c >> 6));
+            *p++ = (char)(0x80 | (c & 0x3F));
+            return p;
+        }
+        if (c >= 0xD800 && c < 0xDC00) {
+            if (i == n) return NULL;
+            const uint32_t c2 = Load16<BE>(s + 2 * i);
+            if (c2 >= 0xDC00 && c2 < 0xE000) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (c2 - 0xDC00);
+                ++i;
+                *p++ = (char)(0xF0 | (c >> 18));
+                *p++ = (char)(0x80 | ((c >> 12) & 0x3F));
+                *p++ = (char)(0x80 | ((c >> 6) & 0x3F));
+                *p++ = (char)(0x80 | (c & 0x3F));
+                return p;
+            }
+        }
+        *p++ = (char)(0xE0 | (c >> 12));
+        *p++ = (char)(0x80 | ((c >> 6) & 0x3F));
+        *p++ = (char)(0x80 | (c & 0x3F));
+        return p;
+    }
+
+    // utf8 validation: skip ascii vectors, check others one sequence
+    // at a time, for vectors without byte shuffle.
+    template <class V, bool SHUFFLE = (bool)V::kShuffle> struct Utf8Validator {
+        static int valid(const char * s, size_t n) {
+            const uint8_t * u = (const uint8_t *)s;
+            size_t i = 0;
+            while (i + V::kWidth <= n) {
+                if (V::ascii(V::load(s + i))) {
+                    i += V::kWidth;
+                } else if ((i = Utf8Skip(u, n, i, i + V::kWidth)) == 0) {
+                    return 0;
+                }
+            }
+            return i >= n || Utf8Skip(u, n, i, n) != 0;
+        }
+    };
+
+    // error bits of a byte pair, Keiser & Lemire, "Validating UTF-8 In
+    // Less Than One Instruction Per Byte"
+    enum {
+        kTooShort       = 1 << 0,   // 11______ 0_______ or 11______ 11______
+        kTooLong        = 1 << 1,   // 0_______ 10______
+        kOverlong3      = 1 << 2,   // 11100000 100_____
+        kTooLarge       = 1 << 3,   // 11110100 1001____ ...
+        kSurrogate      = 1 << 4,   // 11101101 101_____
+        kOverlong2      = 1 << 5,   // 1100000_ 10______
+        kTooLarge1000   = 1 << 6,   // 11110101 1000____ ...
+        kOverlong4      = 1 << 6,   // 11110000 1000____
+        kTwoConts       = 1 << 7,   // 10______ 10______
+        kCarry          = kTooShort | kTooLong | kTwoConts
+    };
+
+    // classify each byte with its previous byte by table lookup,
+    // and check lengths of 3 & 4 bytes sequences by shifted bytes.
+    template <class V> struct Utf8Validator<V, true> {
+        typedef typename V::type type;
+
+        static int valid(const char * s, size_t n) {
+            static const uint8_t kByte1High[16] = {
+                // 0_______ ________
+                kTooLong, kTooLong, kTooLong, kTooLong,
+                kTooLong, kTooLong, kTooLong, kTooLong,
+                // 10______ ________
+                kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+                // 1100____ ________
+                kTooShort | kOverlong2,
+                // 1101____ ________
+                kTooShort,
+                // 1110____ ________
+                kTooShort | kOverlong3 | kSurrogate,
+                // 1111____ ________
+                kTooShort | kTooLarge | kTooLarge1000 | kOverlong4
+            };
+            static const uint8_t kByte1Low[16] = {
+                // ____0000 ________
+                kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+                // ____0001 ________
+                kCarry | kOverlong2,
+                // ____001_ ________
+                kCarry, kCarry,
+                // ____0100 ________
+                kCarry | kTooLarge,
+                // ____0101 ________ ~ ____1100 ________
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                // ____1101 ________
+                kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+                // ____111_ ________
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000
+            };
+            static const uint8_t kByte2High[16] = {
+                // ________ 0_______
+                kTooShort, kTooShort, kTooShort, kTooShort,
+                kTooShort, kTooShort, kTooShort, kTooShort,
+                // ________ 1000____
+                kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+                // ________ 1001____
+                kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+                // ________ 101_____
+                kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+                kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+                // ________ 11______
+                kTooShort, kTooShort, kTooShort, kTooShort
+            };
+            // max value of the last 3 bytes of a complete vector
+            static const uint8_t kMaxValue[64] = {
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+            };
+
+            Context c;
+            c.byte1High = V::table(kByte1High);
+            c.byte1Low  = V::table(kByte1Low);
+            c.byte2High = V::table(kByte2High);
+            c.maxValue  = V::load((const char *)kMaxValue + sizeof(kMaxValue) - V::kWidth);
+            c.low4      = V::set1(0x0F);
+            c.third     = V::set1(0xE0 - 0x80);
+            c.fourth    = V::set1(0xF0 - 0x80);
+            c.high      = V::set1((char)0x80);
+            c.error     = V::set1(0);
+            c.prev      = V::set1(0);
+            c.incomplete = V::set1(0);
+
+            size_t i = 0;
+            for (; i + V::kWidth <= n; i += V::kWidth) {
+                check(c, V::load(s + i));
+            }
+            if (i < n) {
+                // pad with ascii
+                char block[V::kWidth];
+                memset(block, 0, V::kWidth);
+                memcpy(block, s + i, n - i);
+                check(c, V::load(block));
+            }
+            return !V::any(V::or_(c.error, c.incomplete));
+        }
+
+    private:
+        struct Context {
+            type byte1High, byte1Low, byte2High, maxValue;
+            type low4, third, fourth, high;
+            type error, prev, incomplete;
+        };
+
+        STR_INLINE void check(Context& c, type input) {
+            if (V::ascii(input)) {
+                c.error = V::or_(c.error, c.incomplete);
+                c.incomplete = V::set1(0);
+            } else {
+                const type prev1 = V::template prev<1>(input, c.prev);
+                const type special = V::and_(V::and_(
+                            V::lookup(c.byte1High, V::shr4(prev1)),
+                            V::lookup(c.byte1Low, V::and_(prev1, c.low4))),
+                        V::lookup(c.byte2High, V::shr4(input)));
+                // 3rd & 4th bytes of a sequence MUST be continuation
+                const type must23 = V::or_(
+                        V::subs(V::template prev<2>(input, c.prev), c.third),
+                        V::subs(V::template prev<3>(input, c.prev), c.fourth));
+                c.error = V::or_(c.error, V::xor_(V::and_(must23, c.high), special));
+                c.incomplete = V::subs(input, c.maxValue);
+            }
+            c.prev = input;
+        }
+    };
+
+    template <class V> static int Utf8Valid(const char * s, size_t n) {
+        return Utf8Validator<V>::valid(s, n);
+    }
+
+    template <class V, bool BE> static ssize_t Utf8ToUtf16(const char * s, size_t n, char * out) {
+        if (!Utf8Validator<V>::valid(s, n)) return -1;
+
+        const uint8_t * u = (const uint8_t *)s;
+        char * p = out;
+        size_t i = 0;
+        while (i + V::kWidth <= n) {
+            const typename V::type v = V::load(s + i);
+            if (V::ascii(v)) {
+                V::template widen<BE>(p, v);
+                p += 2 * V::kWidth;
+                i += V::kWidth;
+            } else {
+                // the rest of this vector
+                const size_t end = i + V::kWidth;
+                while (i < end) p = Utf8ToUtf16One<BE>(u, i, p);
+            }
+        }
+        while (i < n) p = Utf8ToUtf16One<BE>(u, i, p);
+        return (p - out) / 2;
+    }
+
+    template <class V, bool BE> static ssize_t Utf16ToUtf8(const char * s, size_t n, char * out) {
+        char * p = out;
+        size_t i = 0;
+        while (i + V::kWidth <= n) {
+            if (V::template narrow<BE>(p, s + 2 * i)) {
+                p += V::kWidth;
+                i += V::kWidth;
+            } else {
+                const size_t end = i + V::kWidth;
+                while (i < end) {
+                    if ((p = Utf16ToUtf8One<BE>(s, n, i, p)) == NULL) return -1;
+                }
+            }
+        }
+        while (i < n) {
+            if ((p = Utf16ToUtf8One<BE>(s, n, i, p)) == NULL) return -1;
+        }
+        return p - out;
+    }
+
+    template <class V> static ssize_t Utf8ToUtf16(const char * s, size_t n, char * out, int be) {
+        return be ? Utf8ToUtf16<V, true>(s, n, out) : Utf8ToUtf16<V, false>(s, n, out);
+    }
+
+    template <class V> static ssize_t Utf16ToUtf8(const char * s, size_t n, char * out, int be) {
+        return be ? Utf16ToUtf8<V, true>(s, n, out) : Utf16ToUtf8<V, false>(s, n, out);
+    }
+
+    template <class V> static const StrKernels * Kernels() {
+        static const StrKernels kernels = {
+            FindChar<V>, RFindChar<V>, Find<V>, RFind<V>,
+            CaseCmp<V>, LowerString<V>, UpperString<V>,
+            Utf8Valid<V>, Utf8ToUtf16<V>, Utf16ToUtf8<V>
+        };
+        return &kernels;
+    }
+
+}
+
+#endif // __toolkit_strsimd_kernels_h
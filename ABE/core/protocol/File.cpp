@@ -41,6 +41,8 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <limits.h>
 #include <string.h>
 #include <errno.h> 
 
@@ -52,6 +54,10 @@
 #define O_BINARY    (0)
 #endif
 
+#ifndef IOV_MAX
+#define IOV_MAX     (16)
+#endif
+
 #ifndef HAVE_LSEEK64
 #define lseek64 lseek
 #endif
@@ -67,18 +73,19 @@ struct File : public Content::Protocol {
     int64_t         mLength;
     int64_t         mPosition;
     
-    File(const String& url, Content::eMode mode) : Content::Protocol(),
-    mUrl(url), mMode(mode), mFd(-1),
+    File(const StringView& url, Content::eMode mode) : Content::Protocol(),
+    mUrl(url.string()), mMode(mode), mFd(-1),
     mOffset(0), mLength(0), mPosition(0)
     {
         if (url.startsWithIgnoreCase("pipe://")) {
             int64_t offset, length;
             
-            int index0 = url.indexOf(7, "+");
+            // parse with views, no temporary strings
+            ssize_t index0 = url.indexOf(7, '+');
             if (index0 < 7) return; // "+" not found.
             mFd     = url.substring(7, index0 - 7).toInt32();
             
-            int index1 = url.indexOf(index0 + 1, "+");
+            ssize_t index1 = url.indexOf(index0 + 1, '+');
             mOffset = url.substring(index0 + 1, index1 - index0 - 1).toInt64();
             mLength = url.substring(index1 + 1).toInt64();
             
@@ -113,7 +120,7 @@ struct File : public Content::Protocol {
                 //flags |= O_TRUNC; // it's better to let client do this.
             }
             
-            const char *pathname = url.c_str();
+            const char *pathname = mUrl.c_str();    // null-terminated
             if (url.startsWithIgnoreCase("file://"))    pathname += 6;
             
             if (flags & O_CREAT)
@@ -122,7 +129,7 @@ struct File : public Content::Protocol {
                 mFd = ::open(pathname, flags);
             
             if (mFd < 0) {
-                ERROR("open %s failed. errno = %d(%s)", url.c_str(), errno, strerror(errno));
+                ERROR("open %s failed. errno = %d(%s)", mUrl.c_str(), errno, strerror(errno));
                 return;
             }
             
@@ -191,6 +198,66 @@ struct File : public Content::Protocol {
         return (size_t)bytesWritten;
     }
     
+    virtual size_t writevBytes(const struct iovec * iov, size_t count) {
+        size_t total = 0;
+        while (count) {
+            const size_t n = count > IOV_MAX ? IOV_MAX : count;
+            size_t bytes = 0;
+            for (size_t i = 0; i < n; ++i) bytes += iov[i].iov_len;
+
+            ssize_t bytesWritten = ::writev(mFd, iov, n);
+            if (bytesWritten < 0) {
+                ERROR("writev return error %d. errno = %d %s", bytesWritten,
+                      errno, strerror(errno));
+                break;
+            }
+
+            mPosition += (int64_t)bytesWritten;
+            if (mPosition > mLength) {
+                mLength = mPosition;
+            }
+
+            total += bytesWritten;
+            if ((size_t)bytesWritten < bytes) break;    // short write
+            iov     += n;
+            count   -= n;
+        }
+        return total;
+    }
+
+    virtual size_t readvBytes(const struct iovec * iov, size_t count) {
+        enum { kMaxVectors = 64 };
+        struct iovec vec[kMaxVectors];
+        size_t total = 0;
+        while (count) {
+            // clamp to remains, same as readBytes
+            const size_t remains = mLength - mPosition;
+            size_t n = 0;
+            size_t bytes = 0;
+            for (; n < count && n < kMaxVectors && n < IOV_MAX && bytes < remains; ++n) {
+                vec[n] = iov[n];
+                if (vec[n].iov_len > remains - bytes) vec[n].iov_len = remains - bytes;
+                bytes += vec[n].iov_len;
+            }
+            if (bytes == 0) break;
+
+            ssize_t bytesRead = ::readv(mFd, vec, n);
+            if (bytesRead < 0) {
+                ERROR("readv@%lld return error(%d|%s) %d/%d", mPosition,
+                      errno, strerror(errno),
+                      bytesRead, bytes);
+                break;
+            }
+
+            mPosition += bytesRead;
+            total += bytesRead;
+            if ((size_t)bytesRead < bytes) break;   // eos or short read
+            iov     += n;
+            count   -= n;
+        }
+        return total;
+    }
+
     virtual int64_t seekBytes(int64_t offset) {
         offset += mOffset;
         
@@ -216,7 +283,7 @@ struct File : public Content::Protocol {
     }
 };
 
-sp<Content::Protocol> CreateFile(const String& url, Content::eMode mode) {
+sp<Content::Protocol> CreateFile(const StringView& url, Content::eMode mode) {
     return new File(url, mode);
 }
 __END_NAMESPACE_ABE
@@ -249,12 +249,13 @@ void HashTableImpl::shrink() {
     // TODO: implement buckets shrink
 }
 
-void * HashTableImpl::find(const void * k, size_t hash) {
+void * HashTableImpl::find(const void * k, size_t hash, type_compare_t compare) {
+    if (compare == NULL) compare = mKeyCompare;
     const size_t index = hash % mTableLength;
     Element ** buck = _edit();
     Element * p     = buck[index];
     while (p) {
-        if (hash == p->mHash && mKeyCompare(k, p->mKey)) {
+        if (hash == p->mHash && compare(k, p->mKey)) {
             return p->mValue;
         }
         p = p->mNext;
@@ -262,12 +263,13 @@ void * HashTableImpl::find(const void * k, size_t hash) {
     return NULL;
 }
 
-const void * HashTableImpl::find(const void * k, size_t hash) const {
+const void * HashTableImpl::find(const void * k, size_t hash, type_compare_t compare) const {
+    if (compare == NULL) compare = mKeyCompare;
     const size_t index = hash % mTableLength;
     Element ** buck = (Element **)mStorage->data();
     Element * p     = buck[index];
     while (p) {
-        if (hash == p->mHash && mKeyCompare(k, p->mKey)) {
+        if (hash == p->mHash && compare(k, p->mKey)) {
             return p->mValue;
         }
         p = p->mNext;
@@ -35,6 +35,9 @@
 #ifndef ABE_HEADERS_HT_H
 #define ABE_HEADERS_HT_H
 
+#include <ABE/core/Hash.h>
+#include <ABE/core/StringView.h>
+#include <ABE/core/Atom.h>
 #include <ABE/stl/TypeHelper.h>
 #include <ABE/stl/Vector.h>
 
@@ -71,9 +74,9 @@ class ABE_EXPORT HashTableImpl {
         void            clear       ();
 
     protected:
-        // return NULL if not exists
-        void *          find        (const void *k, size_t hash);
-        const void *    find        (const void *k, size_t hash) const;
+        // return NULL if not exists, compare k with keys by compare or key compare
+        void *          find        (const void *k, size_t hash, type_compare_t compare = NULL);
+        const void *    find        (const void *k, size_t hash, type_compare_t compare = NULL) const;
         // assert if not exists
         void *          access      (const void *k, size_t hash);
         const void *    access      (const void *k, size_t hash) const;
@@ -113,41 +116,62 @@ template <typename TYPE> static ABE_INLINE size_t hash(const TYPE& value) {
     return value.hash();
 };
 
-#define HASH_BASIC_TYPES32(TYPE)                                                        \
-    template <> ABE_INLINE size_t hash(const TYPE& v) { return size_t(v); }
-#define HASH_BASIC_TYPES64(TYPE)                                                        \
-    template <> ABE_INLINE size_t hash(const TYPE& v) { return size_t((v >> 32) ^ v); }
+// integers are mixed, or strided keys collide under hash % tableLength
+#define HASH_INTEGER_TYPES(TYPE)                                                        \
+    template <> ABE_INLINE size_t hash(const TYPE& v) { return size_t(HashMix(uint64_t(v))); }
 #define HASH_BASIC_TYPES(TYPE)                                                          \
-    template <> ABE_INLINE size_t hash(const TYPE& v) {                               \
-        size_t x = 0;                                                                   \
-        const uint8_t *u8 = reinterpret_cast<const uint8_t*>(&v);                       \
-        for (size_t i = 0; i < sizeof(TYPE); ++i) x = x * 31 + u8[i];                   \
-        return x;                                                                       \
-    };
-
-HASH_BASIC_TYPES32  (uint8_t);
-HASH_BASIC_TYPES32  (int8_t);
-HASH_BASIC_TYPES32  (uint16_t);
-HASH_BASIC_TYPES32  (int16_t);
-HASH_BASIC_TYPES32  (uint32_t);
-HASH_BASIC_TYPES32  (int32_t);
-HASH_BASIC_TYPES64  (uint64_t);
-HASH_BASIC_TYPES64  (int64_t);
+    template <> ABE_INLINE size_t hash(const TYPE& v) { return size_t(HashBytes(&v, sizeof(TYPE))); }
+
+HASH_INTEGER_TYPES  (uint8_t);
+HASH_INTEGER_TYPES  (int8_t);
+HASH_INTEGER_TYPES  (uint16_t);
+HASH_INTEGER_TYPES  (int16_t);
+HASH_INTEGER_TYPES  (uint32_t);
+HASH_INTEGER_TYPES  (int32_t);
+HASH_INTEGER_TYPES  (uint64_t);
+HASH_INTEGER_TYPES  (int64_t);
 HASH_BASIC_TYPES    (float);
 HASH_BASIC_TYPES    (double);
 
 #if !defined(__GLIBC__) && !defined(__MINGW32__)
-HASH_BASIC_TYPES32(size_t);
-HASH_BASIC_TYPES32(ssize_t);
+HASH_INTEGER_TYPES(size_t);
+HASH_INTEGER_TYPES(ssize_t);
 #endif
 #undef HASH_BASIC_TYPES
-#undef HASH_BASIC_TYPES32
-#undef HASH_BASIC_TYPES64
+#undef HASH_INTEGER_TYPES
 
 template <typename TYPE> ABE_INLINE size_t hash(TYPE * const& p) {
     return hash<uintptr_t>(uintptr_t(p));
 };
 
+// lookup KEY by a VIEW type without a temporary key, only for pairs
+// that VIEW has the same hash() as KEY, and KEY == VIEW.
+template <typename KEY, typename VIEW> struct hash_view { };
+template <> struct hash_view<String, StringView> { typedef void type; };
+
+// lookup KEY by a VIEW which has to be resolved to KEY, but never
+// creates a KEY, e.g. Atom::Find() instead of interning a StringView.
+// key() returns false if no such KEY exists.
+template <typename KEY, typename VIEW> struct find_view { };
+template <> struct find_view<Atom, StringView> {
+    typedef void type;
+    static ABE_INLINE bool key(const StringView& s, Atom * atom) {
+        *atom = Atom::Find(s);
+        return !atom->empty() || s.empty();
+    }
+};
+template <> struct find_view<Atom, String> {
+    typedef void type;
+    static ABE_INLINE bool key(const String& s, Atom * atom) {
+        *atom = Atom::Find(s);
+        return !atom->empty() || s.empty();
+    }
+};
+
+template <typename KEY, typename VIEW> static ABE_INLINE bool type_compare_view(const void * lhs, const void * rhs) {
+    return *static_cast<const KEY *>(rhs) == *static_cast<const VIEW *>(lhs);
+}
+
 template <typename KEY, typename VALUE> class HashTable : private __NAMESPACE_ABE_PRIVATE::HashTableImpl, public NonSharedObject {
     private:
         // increment only iterator
@@ -206,6 +230,16 @@ template <typename KEY, typename VALUE> class HashTable : private __NAMESPACE_AB
         // return NULL if not exists
         ABE_INLINE VALUE *         find(const KEY& k)                  { return static_cast<VALUE*>(HashTableImpl::find(&k, hash(k)));             }
         ABE_INLINE const VALUE*    find(const KEY& k) const            { return static_cast<const VALUE*>(HashTableImpl::find(&k, hash(k)));       }
+        // find by view, e.g. StringView for String keys
+        template <typename VIEW> ABE_INLINE VALUE * find(const VIEW& k, typename hash_view<KEY, VIEW>::type * = NULL)
+        { return static_cast<VALUE*>(HashTableImpl::find(&k, k.hash(), type_compare_view<KEY, VIEW>)); }
+        template <typename VIEW> ABE_INLINE const VALUE * find(const VIEW& k, typename hash_view<KEY, VIEW>::type * = NULL) const
+        { return static_cast<const VALUE*>(HashTableImpl::find(&k, k.hash(), type_compare_view<KEY, VIEW>)); }
+        // find by a resolved view, e.g. StringView for Atom keys, never creates a key
+        template <typename VIEW> ABE_INLINE VALUE * find(const VIEW& k, typename find_view<KEY, VIEW>::type * = NULL)
+        { KEY key; return find_view<KEY, VIEW>::key(k, &key) ? find(key) : NULL; }
+        template <typename VIEW> ABE_INLINE const VALUE * find(const VIEW& k, typename find_view<KEY, VIEW>::type * = NULL) const
+        { KEY key; return find_view<KEY, VIEW>::key(k, &key) ? find(key) : NULL; }
         // assert if not exists
         ABE_INLINE VALUE&          operator[](const KEY& k)            { return *static_cast<VALUE*>(HashTableImpl::access(&k, hash(k)));          }
         ABE_INLINE const VALUE&    operator[](const KEY& k) const      { return *static_cast<const VALUE*>(HashTableImpl::access(&k, hash(k)));    }
@@ -37,7 +37,17 @@
 #include "core/Log.h"
 
 #include "Queue.h"
+#include "core/System.h"
+#include "Config.h"
 #include <stdlib.h>
+#include <sched.h>
+
+#if HAVE_LINUX_FUTEX_H
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#endif
 
 // single producer & single consumer
 // https://github.com/cameron314/readerwriterqueue
@@ -55,46 +65,51 @@ struct LockFreeQueueImpl::NodeImpl {
 };
 
 LockFreeQueueImpl::LockFreeQueueImpl(const TypeHelper& helper) :
-    mTypeHelper(helper), mHead(NULL), mTail(NULL), mLength(0) {
+    mTypeHelper(helper), mHead(0), mTail(NULL), mLength(0) {
         // use a dummy node
         // to avoid modify both mHead and mTail at push() or pop()
-        mHead = mTail = allocateNode();
-        mHead->mData = NULL;
+        mTail = allocateNode();
+        mTail->mData = NULL;
+        mHead = TaggedPack((NodeImpl *)mTail, 0);
     }
 
 LockFreeQueueImpl::~LockFreeQueueImpl() {
     clear();
-    freeNode((NodeImpl *)mHead);    // free dummy node
-    mHead = mTail = NULL;
+    free(TaggedPtr(mHead));         // free dummy node
+    mHead = 0;
+    mTail = NULL;
+
+    LockFree::FreeList::Node * node = mFreeNodes.popAll();
+    while (node) {
+        LockFree::FreeList::Node * next = node->mNext;
+        free(node);
+        node = next;
+    }
 }
 
 void LockFreeQueueImpl::clear() {
-    volatile NodeImpl *head = ABE_ATOMIC_LOAD(&mHead);
-    while (ABE_ATOMIC_LOAD(&mLength)) {
-        if (ABE_ATOMIC_CAS(&mHead, &head, mHead->mNext)) {
-            ABE_ATOMIC_SUB(&mLength, 1);
-
-            atomic_fence();
-            mTypeHelper.do_destruct(head->mNext->mData, 1);
-            freeNode((NodeImpl *)head);
-        }
-    }
+    while (popBulk(NULL, ABE_ATOMIC_LOAD(&mLength))) { }
 }
 
 size_t LockFreeQueueImpl::size() const {
     return ABE_ATOMIC_LOAD(&mLength);
 }
 
+// reuse freed nodes first, and the memory of nodes is not released
+// until the queue is destroyed, so consumers can always read mNext
 LockFreeQueueImpl::NodeImpl * LockFreeQueueImpl::allocateNode() {
-    const size_t length = sizeof(NodeImpl) + mTypeHelper.size();
-    NodeImpl * node = static_cast<NodeImpl*>(malloc(length));
+    NodeImpl * node = reinterpret_cast<NodeImpl *>(mFreeNodes.pop());
+    if (node == NULL) {
+        const size_t length = sizeof(NodeImpl) + mTypeHelper.size();
+        node = static_cast<NodeImpl*>(malloc(length));
+    }
     node->mNext = NULL;
     node->mData = node + 1;
     return node;
 }
 
 void LockFreeQueueImpl::freeNode(NodeImpl * node) {
-    free(node);
+    mFreeNodes.push(reinterpret_cast<LockFree::FreeList::Node *>(node));
 }
 
 // node = allocateNode();
@@ -135,12 +150,14 @@ void LockFreeQueueImpl::pushN(const void * what) {
 // freeNode();
 bool LockFreeQueueImpl::pop1(void * where) {
     if (ABE_ATOMIC_LOAD(&mLength)) {
-        volatile NodeImpl * head = ABE_ATOMIC_LOAD(&mHead);
-        ABE_ATOMIC_STORE(&mHead, mHead->mNext);
+        const uint64_t top = ABE_ATOMIC_LOAD(&mHead);
+        volatile NodeImpl * head = (NodeImpl *)TaggedPtr(top);
+        ABE_ATOMIC_STORE(&mHead, TaggedPack((NodeImpl *)head->mNext, TaggedTag(top) + 1));
         ABE_ATOMIC_SUB(&mLength, 1);
 
         atomic_fence();
         if (where) {
+            mTypeHelper.do_destruct(where, 1);
             mTypeHelper.do_move(where, head->mNext->mData, 1);
         } else {
             mTypeHelper.do_destruct(head->mNext->mData, 1);
@@ -153,29 +170,272 @@ bool LockFreeQueueImpl::pop1(void * where) {
 }
 
 bool LockFreeQueueImpl::popN(void * where) {
-    bool success = false;
-    volatile NodeImpl *head = ABE_ATOMIC_LOAD(&mHead);
-    while (ABE_ATOMIC_LOAD(&mLength)) {
-        // mHead = mHead->mNext
-        if (ABE_ATOMIC_CAS(&mHead, &head, mHead->mNext)) {
-            ABE_ATOMIC_SUB(&mLength, 1);
-            success = true;
-            break;
+    return popBulk(where, 1) == 1;
+}
+
+// build the chain locally, then link it with a single CAS on mTail:
+// first = allocateNode(); ... last = allocateNode();
+// mTail->mNext = first;
+// mTail = last;
+void LockFreeQueueImpl::pushBulk(const void * what, size_t n) {
+    if (n == 0) return;
+    const char * from = static_cast<const char *>(what);
+
+    NodeImpl *first = allocateNode();
+    mTypeHelper.do_copy(first->mData, from, 1);
+    NodeImpl *last = first;
+    for (size_t i = 1; i < n; ++i) {
+        from += mTypeHelper.size();
+        NodeImpl *node = allocateNode();
+        mTypeHelper.do_copy(node->mData, from, 1);
+        last->mNext = node;
+        last = node;
+    }
+
+    atomic_fence();
+    volatile NodeImpl *tail = ABE_ATOMIC_LOAD(&mTail);  // old tail
+    // mTail = last;
+    while (!ABE_ATOMIC_CAS(&mTail, &tail, last)) { }
+    // fix next: tail->mNext = first
+    ABE_ATOMIC_STORE(&tail->mNext, first);
+    ABE_ATOMIC_ADD(&mLength, n);
+}
+
+// reserve at most n items from mLength, return number of items reserved.
+// reserve before touch mHead, so consumers never run over the tail
+size_t LockFreeQueueImpl::reserve(size_t n) {
+    size_t length = ABE_ATOMIC_LOAD(&mLength);
+    size_t m;
+    do {
+        if (length == 0) return 0;
+        m = length < n ? length : n;
+    } while (!ABE_ATOMIC_CAS(&mLength, &length, length - m));
+    return m;
+}
+
+// detach n reserved nodes with a single CAS on mHead, return the old head.
+// the n-th node becomes the new dummy node.
+// a detached node may be recycled and become the head again while others
+// still walking from it, the tag fails their CAS.
+LockFreeQueueImpl::NodeImpl * LockFreeQueueImpl::detach(size_t n) {
+    uint64_t top = ABE_ATOMIC_LOAD(&mHead);
+    for (;;) {
+        volatile NodeImpl *head = (NodeImpl *)TaggedPtr(top);
+        volatile NodeImpl *last = head;
+        for (size_t i = 0; last && i < n; ++i) {
+            volatile NodeImpl *next;
+            // producer may have moved mTail but not fixed mNext yet
+            while ((next = ABE_ATOMIC_LOAD(&last->mNext)) == NULL) {
+                // head was detached by others, start over
+                if (ABE_ATOMIC_LOAD(&mHead) != top) break;
+            }
+            last = next;
         }
+        // mHead = last
+        if (last == NULL) top = ABE_ATOMIC_LOAD(&mHead);
+        else if (ABE_ATOMIC_CAS(&mHead, &top, TaggedPack((NodeImpl *)last, TaggedTag(top) + 1))) break;
     }
+    return (NodeImpl *)TaggedPtr(top);
+}
+
+// reserve(); head = detach();
+// do_move & freeNode() for each node;
+size_t LockFreeQueueImpl::popBulk(void * where, size_t max) {
+    const size_t n = reserve(max);
+    if (n == 0) return 0;
+
+    NodeImpl *node = detach(n);
+
+    // the old head is the last node of previous consumer, it may still
+    // moving data out of it. wait before we free it.
+    while (ABE_ATOMIC_LOAD(&node->mData) != NULL) sched_yield();
 
     atomic_fence();
-    if (success) {
-        if (where) {
-            mTypeHelper.do_move(where, head->mNext->mData, 1);
+    char * to = static_cast<char *>(where);
+    for (size_t i = 0; i < n; ++i) {
+        NodeImpl *next = node->mNext;
+        if (to) {
+            // the target is a constructed object
+            mTypeHelper.do_destruct(to, 1);
+            mTypeHelper.do_move(to, next->mData, 1);
+            to += mTypeHelper.size();
         } else {
-            mTypeHelper.do_destruct(head->mNext->mData, 1);
+            mTypeHelper.do_destruct(next->mData, 1);
         }
-        head->mNext->mData = NULL;
-        freeNode((NodeImpl *)head);
-        return true;
+        ABE_ATOMIC_STORE(&next->mData, NULL);
+        freeNode(node);
+        node = next;
+    }
+    return n;
+}
+
+// each producer thread owns a sub-queue, which is single producer
+// & multi consumer, so push1() can be used without CAS on mTail.
+struct ConcurrentQueueImpl::SubQueue : public LockFreeQueueImpl {
+    const void *    mOwner;
+    SubQueue *      mNext;
+
+    SubQueue(const TypeHelper& helper, const void * owner) :
+        LockFreeQueueImpl(helper), mOwner(owner), mNext(NULL) { }
+
+    ABE_INLINE void push(const void * what)     { push1(what);                          }
+    ABE_INLINE bool pop(void * what)            { return popN(what);                    }
+    ABE_INLINE size_t size() const              { return LockFreeQueueImpl::size();     }
+};
+
+// address of this variable is unique for each alive thread,
+// a new thread may take over the sub-queue of an exited thread.
+static __thread char        tls_owner;
+// cache the sub-queue of last used queue
+static __thread uint64_t    tls_queue_id    = 0;
+static __thread void *      tls_sub_queue   = NULL;
+static volatile uint64_t    g_queue_id      = 0;
+
+ConcurrentQueueImpl::ConcurrentQueueImpl(const TypeHelper& helper) :
+    mTypeHelper(helper), mId(ABE_ATOMIC_ADD(&g_queue_id, 1)),
+    mQueues(NULL), mNextPop(NULL) {
+    }
+
+ConcurrentQueueImpl::~ConcurrentQueueImpl() {
+    SubQueue * queue = mQueues;
+    while (queue) {
+        SubQueue * next = queue->mNext;
+        delete queue;
+        queue = next;
+    }
+    mQueues = mNextPop = NULL;
+}
+
+ConcurrentQueueImpl::SubQueue * ConcurrentQueueImpl::token() {
+    if (tls_queue_id == mId) return static_cast<SubQueue *>(tls_sub_queue);
+
+    SubQueue * queue = ABE_ATOMIC_LOAD(&mQueues);
+    while (queue && queue->mOwner != &tls_owner) queue = queue->mNext;
+
+    if (queue == NULL) {
+        // only current thread add its own sub-queue, no duplicate
+        queue = new SubQueue(mTypeHelper, &tls_owner);
+        SubQueue * head = ABE_ATOMIC_LOAD(&mQueues);
+        do {
+            queue->mNext = head;
+        } while (!ABE_ATOMIC_CAS(&mQueues, &head, queue));
+    }
+
+    tls_queue_id    = mId;
+    tls_sub_queue   = queue;
+    return queue;
+}
+
+size_t ConcurrentQueueImpl::size() const {
+    size_t n = 0;
+    SubQueue * queue = ABE_ATOMIC_LOAD(&mQueues);
+    for (; queue; queue = queue->mNext) n += queue->size();
+    return n;
+}
+
+void ConcurrentQueueImpl::clear() {
+    while (pop(NULL)) { }
+}
+
+void ConcurrentQueueImpl::push(const void * what) {
+    token()->push(what);
+}
+
+// start from the cursor, try each non-empty sub-queue once
+bool ConcurrentQueueImpl::pop(void * where) {
+    SubQueue * first = ABE_ATOMIC_LOAD(&mNextPop);
+    if (first == NULL) first = ABE_ATOMIC_LOAD(&mQueues);
+
+    SubQueue * queue = first;
+    while (queue) {
+        if (queue->size() && queue->pop(where)) {
+            // move the cursor, let next consumer try another sub-queue
+            ABE_ATOMIC_STORE(&mNextPop, queue->mNext);
+            return true;
+        }
+        queue = queue->mNext;
+        if (queue == NULL) queue = ABE_ATOMIC_LOAD(&mQueues);
+        if (queue == first) break;
     }
     return false;
 }
 
+BlockingQueueImpl::BlockingQueueImpl(const TypeHelper& helper) :
+    LockFreeQueueImpl(helper), mSequence(0), mWaiters(0) {
+    }
+
+BlockingQueueImpl::~BlockingQueueImpl() {
+    CHECK_EQ(ABE_ATOMIC_LOAD(&mWaiters), 0);
+}
+
+// pushN();
+// mSequence++;
+// if (mWaiters) wake();
+void BlockingQueueImpl::push(const void * what) {
+    LockFreeQueueImpl::pushN(what);
+    ABE_ATOMIC_ADD(&mSequence, 1);
+    if (ABE_ATOMIC_LOAD(&mWaiters)) wake();
+}
+
+// seq = mSequence;
+// mWaiters++;
+// if (popN()) return;  // check again after register as waiter
+// wait(seq);           // return immediately if mSequence != seq
+// mWaiters--;
+bool BlockingQueueImpl::pop(void * where, int64_t timeout) {
+    if (LockFreeQueueImpl::popN(where)) return true;
+    if (timeout == 0) return false;
+
+    const int64_t deadline = timeout > 0 ? SystemTimeUs() + timeout : 0;
+    for (;;) {
+        const int seq = ABE_ATOMIC_LOAD(&mSequence);
+        ABE_ATOMIC_ADD(&mWaiters, 1);
+        if (LockFreeQueueImpl::popN(where)) {
+            ABE_ATOMIC_SUB(&mWaiters, 1);
+            return true;
+        }
+
+        int64_t remains = -1;
+        if (timeout > 0) {
+            remains = deadline - SystemTimeUs();
+            if (remains <= 0) {
+                ABE_ATOMIC_SUB(&mWaiters, 1);
+                return false;
+            }
+        }
+        wait(seq, remains);
+        ABE_ATOMIC_SUB(&mWaiters, 1);
+
+        if (LockFreeQueueImpl::popN(where)) return true;
+    }
+}
+
+#if HAVE_LINUX_FUTEX_H
+void BlockingQueueImpl::wait(int seq, int64_t timeout) {
+    struct timespec ts;
+    ts.tv_sec   = timeout / 1000000LL;
+    ts.tv_nsec  = (timeout % 1000000LL) * 1000LL;
+    // EAGAIN if mSequence != seq, EINTR & ETIMEDOUT are handled by caller
+    syscall(SYS_futex, &mSequence, FUTEX_WAIT_PRIVATE, seq,
+            timeout < 0 ? NULL : &ts, NULL, 0);
+}
+
+void BlockingQueueImpl::wake() {
+    syscall(SYS_futex, &mSequence, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+#else
+// mSequence is checked & signaled with mLock held, so no wakeup is lost
+void BlockingQueueImpl::wait(int seq, int64_t timeout) {
+    AutoLock _l(mLock);
+    if (ABE_ATOMIC_LOAD(&mSequence) != seq) return;
+    if (timeout < 0)    mWait.wait(mLock);
+    else                mWait.waitRelative(mLock, timeout * 1000LL);
+}
+
+void BlockingQueueImpl::wake() {
+    AutoLock _l(mLock);
+    mWait.signal();
+}
+#endif
+
 __END_NAMESPACE_ABE_PRIVATE
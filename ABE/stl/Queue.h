@@ -34,6 +34,8 @@
 #ifndef ABE_HEADERS_STL_QUEUE_H
 #define ABE_HEADERS_STL_QUEUE_H
 #include <ABE/stl/TypeHelper.h>
+#include <ABE/stl/Stack.h>
+#include <ABE/core/Mutex.h>
 __BEGIN_NAMESPACE_ABE_PRIVATE
 /**
  * a lock free queue implement
@@ -48,6 +50,8 @@ class ABE_EXPORT LockFreeQueueImpl {
         void            pushN(const void * what);   // for multi producer
         bool            pop1(void * what);          // for single consumer
         bool            popN(void * what);          // for multi consumer
+        void            pushBulk(const void * what, size_t n);  // for multi producer
+        size_t          popBulk(void * what, size_t max);       // for multi consumer
         size_t          size() const;
         void            clear();
 
@@ -55,15 +59,78 @@ class ABE_EXPORT LockFreeQueueImpl {
         struct NodeImpl;
         NodeImpl *      allocateNode();
         void            freeNode(NodeImpl *);
+        size_t          reserve(size_t n);
+        NodeImpl *      detach(size_t n);
 
         TypeHelper          mTypeHelper;
-        volatile NodeImpl * mHead;
+        volatile uint64_t   mHead;      // dummy node | tag, tag avoid ABA of detach()
         volatile NodeImpl * mTail;
         volatile size_t     mLength;
+        LockFree::FreeList  mFreeNodes; // popped nodes, reused by push()
 
     private:
         DISALLOW_EVILS(LockFreeQueueImpl);
 };
+
+/**
+ * a lock free queue with a sub-queue for each producer thread,
+ * producers never contend with each other, and consumers pop
+ * from sub-queues in round robin. FIFO only per producer.
+ * size() sums all sub-queues, it is not a snapshot.
+ * @note sub-queue of an exited thread is not freed until the queue
+ *       is destroyed, a new thread may take it over.
+ */
+class ABE_EXPORT ConcurrentQueueImpl {
+    public:
+        ConcurrentQueueImpl(const TypeHelper& helper);
+        ~ConcurrentQueueImpl();
+
+    protected:
+        void            push(const void * what);    // for multi producer
+        bool            pop(void * what);           // for multi consumer
+        size_t          size() const;
+        void            clear();
+
+    private:
+        struct SubQueue;
+        SubQueue *      token();    // sub-queue of current thread
+
+        TypeHelper          mTypeHelper;
+        const uint64_t      mId;        // unique id, key of thread local cache
+        SubQueue * volatile mQueues;    // all sub-queues, prepend only
+        SubQueue * volatile mNextPop;   // round robin cursor for consumers
+
+    private:
+        DISALLOW_EVILS(ConcurrentQueueImpl);
+};
+
+/**
+ * a blocking queue on top of the lock free queue.
+ * consumers park on a futex word, and producers only wake
+ * them when there is someone parked.
+ */
+class ABE_EXPORT BlockingQueueImpl : public LockFreeQueueImpl {
+    public:
+        BlockingQueueImpl(const TypeHelper& helper);
+        ~BlockingQueueImpl();
+
+    protected:
+        void            push(const void * what);
+        // timeout < 0: wait until success
+        bool            pop(void * what, int64_t timeout /* us */);
+
+    private:
+        void            wait(int seq, int64_t timeout /* us */);
+        void            wake();
+
+        volatile int        mSequence;  // futex word, increase on each push
+        volatile int        mWaiters;   // number of parked consumers
+        Mutex               mLock;      // used when futex is not available
+        Condition           mWait;
+
+    private:
+        DISALLOW_EVILS(BlockingQueueImpl);
+};
 __END_NAMESPACE_ABE_PRIVATE
 
 __BEGIN_NAMESPACE_ABE
@@ -78,7 +145,41 @@ namespace LockFree {
             ABE_INLINE void        clear()             { LockFreeQueueImpl::clear();           }
             ABE_INLINE void        push(const TYPE& v) { LockFreeQueueImpl::pushN(&v);         }
             ABE_INLINE bool        pop(TYPE& v)        { return LockFreeQueueImpl::popN(&v);   }
+
+            // push n items with a single CAS on tail
+            ABE_INLINE void        pushBulk(const TYPE * v, size_t n)  { LockFreeQueueImpl::pushBulk(v, n);            }
+            // pop at most max items with a single CAS on head, return number of items popped
+            ABE_INLINE size_t      popBulk(TYPE * v, size_t max)       { return LockFreeQueueImpl::popBulk(v, max);    }
     };
 };
+
+namespace LockFree {
+    template <class TYPE> class ConcurrentQueue : protected __NAMESPACE_ABE_PRIVATE::ConcurrentQueueImpl, public NonSharedObject {
+        public:
+            ABE_INLINE ConcurrentQueue() : ConcurrentQueueImpl(TypeHelperBuilder<TYPE, false, true, true>()) { }
+            ABE_INLINE ~ConcurrentQueue() { }
+
+            ABE_INLINE size_t      size() const        { return ConcurrentQueueImpl::size();   }
+            ABE_INLINE bool        empty() const       { return size() == 0;                   }
+            ABE_INLINE void        clear()             { ConcurrentQueueImpl::clear();         }
+            ABE_INLINE void        push(const TYPE& v) { ConcurrentQueueImpl::push(&v);        }
+            ABE_INLINE bool        pop(TYPE& v)        { return ConcurrentQueueImpl::pop(&v);  }
+    };
+};
+
+template <class TYPE> class BlockingQueue : protected __NAMESPACE_ABE_PRIVATE::BlockingQueueImpl, public NonSharedObject {
+    public:
+        ABE_INLINE BlockingQueue() : BlockingQueueImpl(TypeHelperBuilder<TYPE, false, true, true>()) { }
+        ABE_INLINE ~BlockingQueue() { }
+
+        ABE_INLINE size_t      size() const        { return BlockingQueueImpl::size();     }
+        ABE_INLINE bool        empty() const       { return size() == 0;                   }
+        ABE_INLINE void        clear()             { BlockingQueueImpl::clear();           }
+        ABE_INLINE void        push(const TYPE& v) { BlockingQueueImpl::push(&v);          }
+        // wait until an item is available
+        ABE_INLINE void        pop(TYPE& v)        { BlockingQueueImpl::pop(&v, -1);       }
+        // wait at most timeout us, return false on timeout
+        ABE_INLINE bool        pop(TYPE& v, int64_t timeout)   { return BlockingQueueImpl::pop(&v, timeout);   }
+};
 __END_NAMESPACE_ABE
 #endif // ABE_HEADERS_STL_QUEUE_H
@@ -0,0 +1,163 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+// File:    Stack.cpp
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20161018     initial version
+//
+
+#define LOG_TAG "Stack"
+//#define LOG_NDEBUG 0
+#include "core/Log.h"
+
+#include "Stack.h"
+#include <stdlib.h>
+
+// https://en.wikipedia.org/wiki/Treiber_stack
+// https://en.wikipedia.org/wiki/ABA_problem
+
+__BEGIN_NAMESPACE_ABE
+namespace LockFree {
+using namespace abe_private;
+
+FreeList::FreeList() : mTop(0) {
+}
+
+void FreeList::push(Node * node) {
+    push(node, node);
+}
+
+// last->mNext = top;
+// top = first;
+void FreeList::push(Node * first, Node * last) {
+    CHECK_TRUE(TaggedPtr(TaggedPack(first, 0)) == first, "pointer out of range");
+    uint64_t top = ABE_ATOMIC_LOAD(&mTop);
+    do {
+        ABE_ATOMIC_STORE(&last->mNext, (Node *)TaggedPtr(top));
+    } while (!ABE_ATOMIC_CAS(&mTop, &top, TaggedPack(first, TaggedTag(top) + 1)));
+}
+
+// node = top;
+// top = node->mNext;
+FreeList::Node * FreeList::pop() {
+    uint64_t top = ABE_ATOMIC_LOAD(&mTop);
+    Node * node;
+    do {
+        node = (Node *)TaggedPtr(top);
+        if (node == NULL) return NULL;
+        // node may be popped by others at this moment, but its memory
+        // is still valid, and the tag will fail the CAS below.
+    } while (!ABE_ATOMIC_CAS(&mTop, &top, TaggedPack(ABE_ATOMIC_LOAD(&node->mNext), TaggedTag(top) + 1)));
+    return node;
+}
+
+FreeList::Node * FreeList::popAll() {
+    uint64_t top = ABE_ATOMIC_LOAD(&mTop);
+    while (!ABE_ATOMIC_CAS(&mTop, &top, TaggedPack(NULL, TaggedTag(top) + 1))) { }
+    return (Node *)TaggedPtr(top);
+}
+
+bool FreeList::empty() const {
+    return TaggedPtr(ABE_ATOMIC_LOAD(&mTop)) == NULL;
+}
+
+};
+__END_NAMESPACE_ABE
+
+__BEGIN_NAMESPACE_ABE_PRIVATE
+
+struct LockFreeStackImpl::NodeImpl {
+    LockFree::FreeList::Node    mNode;
+    void *                      mData;
+};
+
+LockFreeStackImpl::LockFreeStackImpl(const TypeHelper& helper) :
+    mTypeHelper(helper), mLength(0) {
+    }
+
+LockFreeStackImpl::~LockFreeStackImpl() {
+    clear();
+    LockFree::FreeList::Node * node = mFreeNodes.popAll();
+    while (node) {
+        LockFree::FreeList::Node * next = node->mNext;
+        free(node);
+        node = next;
+    }
+}
+
+void LockFreeStackImpl::clear() {
+    while (pop(NULL)) { }
+}
+
+size_t LockFreeStackImpl::size() const {
+    return ABE_ATOMIC_LOAD(&mLength);
+}
+
+// reuse popped nodes first, LIFO keeps the hottest node
+LockFreeStackImpl::NodeImpl * LockFreeStackImpl::allocateNode() {
+    NodeImpl * node = reinterpret_cast<NodeImpl *>(mFreeNodes.pop());
+    if (node == NULL) {
+        const size_t length = sizeof(NodeImpl) + mTypeHelper.size();
+        node = static_cast<NodeImpl *>(malloc(length));
+        node->mData = node + 1;
+    }
+    node->mNode.mNext = NULL;
+    return node;
+}
+
+void LockFreeStackImpl::freeNode(NodeImpl * node) {
+    mFreeNodes.push(&node->mNode);
+}
+
+void LockFreeStackImpl::push(const void * what) {
+    NodeImpl * node = allocateNode();
+    mTypeHelper.do_copy(node->mData, what, 1);
+    // increase length before push, so length never underflow
+    ABE_ATOMIC_ADD(&mLength, 1);
+    mStack.push(&node->mNode);
+}
+
+bool LockFreeStackImpl::pop(void * where) {
+    NodeImpl * node = reinterpret_cast<NodeImpl *>(mStack.pop());
+    if (node == NULL) return false;
+    ABE_ATOMIC_SUB(&mLength, 1);
+
+    if (where) {
+        // the target is a constructed object
+        mTypeHelper.do_destruct(where, 1);
+        mTypeHelper.do_move(where, node->mData, 1);
+    } else {
+        mTypeHelper.do_destruct(node->mData, 1);
+    }
+    freeNode(node);
+    return true;
+}
+
+__END_NAMESPACE_ABE_PRIVATE
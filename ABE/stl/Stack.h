@@ -0,0 +1,143 @@
+/******************************************************************************
+ * Copyright (c) 2016, Chen Fang <mtdcy.chen@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+
+// File:    Stack.h
+// Author:  mtdcy.chen
+// Changes:
+//          1. 20161018     initial version
+//
+#ifndef ABE_HEADERS_STL_STACK_H
+#define ABE_HEADERS_STL_STACK_H
+#include <ABE/stl/TypeHelper.h>
+
+__BEGIN_NAMESPACE_ABE_PRIVATE
+// pack a pointer and a version tag into one 64 bits word, for ABA safe CAS.
+// 64 bits: user space pointer uses only the low 48 bits, tag is 16 bits.
+// 32 bits: tag is 32 bits.
+#define TAGGED_SHIFT    (sizeof(void *) == 8 ? 48 : 32)
+#define TAGGED_MASK     ((1ULL << TAGGED_SHIFT) - 1)
+
+static ABE_INLINE uint64_t TaggedPack(const void * ptr, uint64_t tag) {
+    return (uint64_t)(uintptr_t)ptr | (tag << TAGGED_SHIFT);
+}
+
+static ABE_INLINE void * TaggedPtr(uint64_t v) {
+    return (void *)(uintptr_t)(v & TAGGED_MASK);
+}
+
+static ABE_INLINE uint64_t TaggedTag(uint64_t v) {
+    return v >> TAGGED_SHIFT;
+}
+__END_NAMESPACE_ABE_PRIVATE
+
+__BEGIN_NAMESPACE_ABE
+namespace LockFree {
+    /**
+     * an intrusive lock free LIFO, a.k.a. Treiber stack.
+     * client put Node as the first member of its own struct, and owns
+     * the memory of the nodes. a node must NOT be freed while others
+     * may still pop(), free them after all threads finished.
+     *
+     * ABA is avoided by a version tag packed with the top pointer,
+     * so only a single word CAS is needed.
+     */
+    class ABE_EXPORT FreeList : public NonSharedObject {
+        public:
+            struct Node {
+                Node *      mNext;
+            };
+
+        public:
+            FreeList();
+            ~FreeList() { }
+
+            void            push(Node * node);
+            // push a chain of nodes [first, last] with a single CAS
+            void            push(Node * first, Node * last);
+            // return NULL if empty
+            Node *          pop();
+            // detach the whole list, return NULL if empty
+            Node *          popAll();
+            bool            empty() const;
+
+        private:
+            volatile uint64_t   mTop;       // pointer | tag
+
+        private:
+            DISALLOW_EVILS(FreeList);
+    };
+};
+__END_NAMESPACE_ABE
+
+__BEGIN_NAMESPACE_ABE_PRIVATE
+/**
+ * a lock free stack implement
+ */
+class ABE_EXPORT LockFreeStackImpl {
+    public:
+        LockFreeStackImpl(const TypeHelper& helper);
+        ~LockFreeStackImpl();
+
+    protected:
+        void            push(const void * what);
+        bool            pop(void * what);
+        size_t          size() const;
+        void            clear();
+
+    private:
+        struct NodeImpl;
+        NodeImpl *      allocateNode();
+        void            freeNode(NodeImpl *);
+
+        TypeHelper          mTypeHelper;
+        LockFree::FreeList  mStack;
+        LockFree::FreeList  mFreeNodes; // popped nodes, reused by push()
+        volatile size_t     mLength;
+
+    private:
+        DISALLOW_EVILS(LockFreeStackImpl);
+};
+__END_NAMESPACE_ABE_PRIVATE
+
+__BEGIN_NAMESPACE_ABE
+namespace LockFree {
+    template <class TYPE> class Stack : protected __NAMESPACE_ABE_PRIVATE::LockFreeStackImpl, public NonSharedObject {
+        public:
+            ABE_INLINE Stack() : LockFreeStackImpl(TypeHelperBuilder<TYPE, false, true, true>()) { }
+            ABE_INLINE ~Stack() { }
+
+            ABE_INLINE size_t      size() const        { return LockFreeStackImpl::size();     }
+            ABE_INLINE bool        empty() const       { return size() == 0;                   }
+            ABE_INLINE void        clear()             { LockFreeStackImpl::clear();           }
+            ABE_INLINE void        push(const TYPE& v) { LockFreeStackImpl::push(&v);          }
+            ABE_INLINE bool        pop(TYPE& v)        { return LockFreeStackImpl::pop(&v);    }
+    };
+};
+__END_NAMESPACE_ABE
+#endif // ABE_HEADERS_STL_STACK_H
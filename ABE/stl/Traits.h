@@ -80,6 +80,18 @@ template <typename T> struct is_trivial_move<sp<T> >    { enum { value = true };
 template <> struct is_trivial_move<String>              { enum { value = true }; };
 #endif
 
+#ifdef ABE_HEADERS_STRING_VIEW_H   // StringView.h
+template <> struct is_trivial_dtor<StringView>          { enum { value = true }; };
+template <> struct is_trivial_copy<StringView>          { enum { value = true }; };
+template <> struct is_trivial_move<StringView>          { enum { value = true }; };
+#endif
+
+#ifdef ABE_HEADERS_ATOM_H      // Atom.h
+template <> struct is_trivial_dtor<Atom>                { enum { value = true }; };
+template <> struct is_trivial_copy<Atom>                { enum { value = true }; };
+template <> struct is_trivial_move<Atom>                { enum { value = true }; };
+#endif
+
 __END_NAMESPACE_ABE
 
 #endif // ABE_STL_TRAITS_H
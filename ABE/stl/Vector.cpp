@@ -88,13 +88,17 @@ VectorImpl& VectorImpl::operator=(const VectorImpl& rhs) {
 }
 
 void* VectorImpl::access(size_t index) {
+#if ABE_HARDENING > 0
     CHECK_LT(index, mItemCount);
+#endif
     _edit();
     return (void *)(mStorage->data() + index * mTypeHelper.size());
 }
 
 const void* VectorImpl::access(size_t index) const {
+#if ABE_HARDENING > 0
     CHECK_LT(index, mItemCount);
+#endif
     return (void *)(mStorage->data() + index * mTypeHelper.size());
 }
 
@@ -111,6 +111,7 @@ template <typename TYPE> class Vector : protected __NAMESPACE_ABE_PRIVATE::Vecto
 
     public:
         // element access with range check which is not like std::vector::operator[]
+        // range check is skipped if built with HARDENING=none
         ABE_INLINE TYPE&       operator[](size_t index)        { return *static_cast<TYPE*>(access(index));        }
         ABE_INLINE const TYPE& operator[](size_t index) const  { return *static_cast<const TYPE*>(access(index));  }
 
@@ -47,15 +47,45 @@ __BEGIN_NAMESPACE_ABE
 ///////////////////////////////////////////////////////////////////////////
 BitReader::BitReader(const char *data, size_t length) :
     mData(data), mLength(length),
-    mHead(0), mReservoir(0), mBitsLeft(0), mByteOrder(Little)
+    mHead(0), mReservoir(0), mBitsLeft(0), mByteOrder(Little),
+    mChain(NULL), mSliceStart(0), mSliceEnd(length)
 {
     CHECK_NULL(mData);
 }
 
+BitReader::BitReader(const BufferChain& chain) :
+    mData(NULL), mLength(chain.size()),
+    mHead(0), mReservoir(0), mBitsLeft(0), mByteOrder(Little),
+    mChain(&chain), mSliceStart(0), mSliceEnd(0)
+{
+    reset();
+}
+
 void BitReader::reset() const {
     mHead = 0;
     mReservoir = 0;
     mBitsLeft = 0;
+    if (mChain && mLength) {
+        // back to the first slice
+        mSlice      = mChain->cbegin();
+        StringView slice = *mSlice;
+        mData       = slice.data();
+        mSliceStart = 0;
+        mSliceEnd   = slice.size();
+    }
+}
+
+// move forward to the slice holding mHead
+void BitReader::nextSlice() const {
+    CHECK_NULL(mChain);
+    CHECK_LT(mHead, mLength);
+    while (mHead >= mSliceEnd) {
+        ++mSlice;
+        StringView slice = *mSlice;
+        mData       = slice.data();
+        mSliceStart = mSliceEnd;
+        mSliceEnd   += slice.size();
+    }
 }
 
 size_t BitReader::remains() const {
@@ -85,7 +115,7 @@ void BitReader::skip(size_t n) const {
 
         n %= 8;
         if (n) {
-            mReservoir = (uint32_t)mData[mHead++];
+            mReservoir = (uint32_t)fetch();
             mBitsLeft  = 8 - n;
             mReservoir &= _bitmask64(mBitsLeft);
         }
@@ -109,7 +139,7 @@ uint32_t BitReader::show(size_t n) const {
         DEBUG("read %zu bytes", numBytes);
         DEBUG("mReservoir = %#x", mReservoir);
         for (size_t i = 0; i < numBytes; i++) {
-            mReservoir = (mReservoir << 8) | (uint8_t)mData[mHead++];
+            mReservoir = (mReservoir << 8) | fetch();
             mBitsLeft  += 8;
         }
         DEBUG("mReservoir = %#x, mBitsLeft %zu", mReservoir, mBitsLeft);
@@ -135,8 +165,14 @@ String BitReader::readS(size_t n) const {
 
     String s;
 
-    if (__builtin_expect(mBitsLeft == 0, true)) {
-        s = String(mData + mHead, n);
+    if (__builtin_expect(mBitsLeft == 0 && mHead + n <= mSliceEnd, true)) {
+        s = String(mData + mHead - mSliceStart, n);
+        mHead += n;
+    } else if (mBitsLeft == 0) {
+        // across slices
+        char tmp[n];
+        mChain->peek(tmp, n, mHead);
+        s = String(tmp, n);
         mHead += n;
     } else {
         uint8_t tmp[n];
@@ -149,9 +185,15 @@ String BitReader::readS(size_t n) const {
 sp<Buffer> BitReader::readB(size_t n) const {
     CHECK_LE(n * 8, remains());
 
-    if (__builtin_expect(mBitsLeft == 0, true)) {
+    if (__builtin_expect(mBitsLeft == 0 && mHead + n <= mSliceEnd, true)) {
+        sp<Buffer> b = new Buffer(n);
+        b->write(mData + mHead - mSliceStart, n);
+        mHead += n;
+        return b;
+    } else if (mBitsLeft == 0) {
+        // across slices
         sp<Buffer> b = new Buffer(n);
-        b->write(mData + mHead, n);
+        b->step(mChain->peek(b->data(), n, mHead));
         mHead += n;
         return b;
     } else {
@@ -240,7 +282,7 @@ BitWriter::BitWriter(char *data, size_t n) : mData(data), mSize(n),
     CHECK_NULL(mData);
 }
 
-BitWriter::BitWriter(Buffer& data) : mData(data.data()), mSize(data.capacity()),
+BitWriter::BitWriter(Buffer& data) : mData(data.edit()), mSize(data.capacity()),
     mHead(0), mReservoir(0), mBitsPopulated(0)
 {
     CHECK_NULL(mData);
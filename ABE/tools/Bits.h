@@ -36,13 +36,12 @@
 #define ABE_HEADERS_BITS_H
 
 #include <ABE/core/Buffer.h>
+#include <ABE/core/BufferChain.h>
 __BEGIN_NAMESPACE_ABE
 
 /**
- * read bits from data
- * @note always do in-place operation
- *
- * TODO: BitReader as universal reader of content & buffer
+ * read bits from data or a BufferChain
+ * @note always do in-place operation, BufferChain is not flattened
  */
 class ABE_EXPORT BitReader : public NonSharedObject {
     public:
@@ -53,6 +52,12 @@ class ABE_EXPORT BitReader : public NonSharedObject {
          */
         BitReader(const char *data, size_t n);
 
+        /**
+         * create a bit reader across slices of a chain.
+         * @param chain chain MUST not change while reading
+         */
+        BitReader(const BufferChain& chain);
+
     public:
         /**
          * get length in bits
@@ -198,13 +203,24 @@ class ABE_EXPORT BitReader : public NonSharedObject {
         ABE_INLINE uint32_t   r32() const { return mByteOrder == Big ? rb32() : rl32(); }
         ABE_INLINE uint64_t   r64() const { return mByteOrder == Big ? rb64() : rl64(); }
     
+    private:
+        void                nextSlice() const;
+        ABE_INLINE uint8_t  fetch() const {
+            if (__builtin_expect(mHead >= mSliceEnd, false)) nextSlice();
+            return mData[mHead++ - mSliceStart];
+        }
+
     protected:
-        const char *        mData;
+        mutable const char * mData;         // current slice
         size_t              mLength;
         mutable size_t      mHead;
         mutable uint64_t    mReservoir;
         mutable size_t      mBitsLeft;
         mutable eByteOrder  mByteOrder;
+        const BufferChain * mChain;
+        mutable BufferChain::const_iterator mSlice;
+        mutable size_t      mSliceStart;    // byte offset of current slice
+        mutable size_t      mSliceEnd;
 
     DISALLOW_EVILS(BitReader);
 };
@@ -4,6 +4,7 @@ cmake_minimum_required (VERSION 2.8)
 include (CheckIncludeFiles)
 include (CheckFunctionExists)
 include (CheckLibraryExists)
+include (CheckCXXCompilerFlag)
 
 # pthread check
 check_include_files (pthread.h  HAVE_PTHREAD_H)
@@ -15,5 +16,24 @@ check_library_exists (pthread pthread_setname_np pthread.h HAVE_PTHREAD_SETNAME_
 check_library_exists (pthread pthread_condattr_setclock pthread.h HAVE_PTHREAD_CONDATTR_SETCLOCK)
 check_library_exists (pthread pthread_main_np pthread.h HAVE_PTHREAD_MAIN_NP)
 
+# futex check
+check_include_files (linux/futex.h HAVE_LINUX_FUTEX_H)
+
+# mmap check
+check_include_files (sys/mman.h HAVE_SYS_MMAN_H)
+check_function_exists (mremap  HAVE_MREMAP)
+check_function_exists (memfd_create HAVE_MEMFD_CREATE)
+
+# malloc check
+check_include_files (malloc.h HAVE_MALLOC_H)
+check_include_files (malloc/malloc.h HAVE_MALLOC_MALLOC_H)
+check_function_exists (malloc_usable_size HAVE_MALLOC_USABLE_SIZE)
+check_function_exists (malloc_size HAVE_MALLOC_SIZE)
+
+# avx2 check, string kernels are selected at runtime
+if (CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|i.86")
+    check_cxx_compiler_flag (-mavx2 HAVE_AVX2)
+endif()
+
 configure_file(${CMAKE_CURRENT_SOURCE_DIR}/Config.h.in ${CMAKE_CURRENT_BINARY_DIR}/Config.h)
 
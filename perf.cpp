@@ -34,9 +34,16 @@
 #define REMOVE_ATOMICS
 #define LOG_TAG "perf"
 #include <ABE/ABE.h>
+#include <ABE/core/debug/heapprof.h>
+#include <ABE/core/private/strsimd.h>
+#include <ABE/core/private/ConvertUTF.h>
 
 #include <list>     // std::list
 #include <vector>   // std::vector
+#include <algorithm>    // std::sort
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #if defined(__APPLE__)
 #include <unordered_map>    // std::unordered_map
 #endif
@@ -46,10 +53,12 @@ using namespace std;
 
 #define PERF_TEST_COUNT     1000000
 #define PERF_PRODUCER       3
+#define PERF_BULK_COUNT     64
 #define LOOPER_TEST_COUNT   1000
 #define LOOPER_TEST_SLEEP   1000  // 1ms
 
 #define MULTI_THREAD 1
+#define NELEM(x)    (sizeof(x) / sizeof(x[0]))
 
 struct Integer {
     int value;
@@ -82,6 +91,25 @@ struct QueueSingleConsumer : public Job {
     }
 };
 
+struct BlockingQueueConsumer : public Job {
+    BlockingQueue<Integer>      mQueue;
+    int                         mNext;
+    BlockingQueueConsumer() : mNext(0) { }
+    virtual void onJob() {
+        int64_t now = SystemTimeUs();
+        for (;;) {
+            Integer i;
+            mQueue.pop(i);
+            CHECK_EQ(i.value, mNext++);
+            if (i.value == PERF_TEST_COUNT) {
+                break;
+            }
+        }
+        int64_t delta = SystemTimeUs() - now;
+        INFO("BlockingQueue pop() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    }
+};
+
 struct QueueProducer : public Job {
     LockFree::Queue<Integer>    mQueue;
     volatile int                mNext;
@@ -96,6 +124,18 @@ struct QueueProducer : public Job {
     }
 };
 
+struct ConcurrentQueueProducer : public Job {
+    LockFree::ConcurrentQueue<Integer>  mQueue;
+    virtual void onJob() {
+        int64_t now = SystemTimeUs();
+        for (int i = 0; i <= PERF_TEST_COUNT; ++i) {
+            mQueue.push(i);
+        }
+        int64_t delta = SystemTimeUs() - now;
+        INFO("ConcurrentQueue push() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    }
+};
+
 void QueuePerf() {
     INFO("Queue push() | pop()");
     int64_t now, delta;
@@ -116,6 +156,25 @@ void QueuePerf() {
     delta = SystemTimeUs() - now;
     INFO("Queue pop() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
     INFO("---");
+
+    INFO("Queue pushBulk() | popBulk()");
+    int bulk[PERF_BULK_COUNT];
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; i += PERF_BULK_COUNT) {
+        for (int j = 0; j < PERF_BULK_COUNT; ++j) bulk[j] = i + j;
+        queue.pushBulk(bulk, PERF_BULK_COUNT);
+    }
+    delta = SystemTimeUs() - now;
+    INFO("Queue pushBulk() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; i += PERF_BULK_COUNT) {
+        CHECK_EQ(queue.popBulk(bulk, PERF_BULK_COUNT), PERF_BULK_COUNT);
+        CHECK_EQ(bulk[0], i);
+    }
+    delta = SystemTimeUs() - now;
+    INFO("Queue popBulk() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    INFO("---");
     
 #if MULTI_THREAD
     // single producer & single consumer test
@@ -132,6 +191,20 @@ void QueuePerf() {
     thread.join();
     INFO("---");
 
+    // single producer & single blocking consumer test
+    INFO("BlockingQueue single producer & single consumer");
+    sp<BlockingQueueConsumer> blocking = new BlockingQueueConsumer;
+    Thread thread1(blocking);
+    thread1.run();
+    now = SystemTimeUs();
+    for (int i = 0; i <= PERF_TEST_COUNT; ++i) {
+        blocking->mQueue.push(i);
+    }
+    delta = SystemTimeUs() - now;
+    INFO("BlockingQueue push() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    thread1.join();
+    INFO("---");
+
     // multi producer & single consumer test
     INFO("Queue multi producer & single consumer");
     sp<QueueProducer> producer = new QueueProducer;
@@ -155,6 +228,118 @@ void QueuePerf() {
     }
     threads.clear();
     INFO("---");
+
+    // multi producer & single consumer test, sub-queue per producer
+    INFO("ConcurrentQueue multi producer & single consumer");
+    sp<ConcurrentQueueProducer> producer1 = new ConcurrentQueueProducer;
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads.push(Thread(producer1));
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads[i].run();
+
+    now = SystemTimeUs();
+    for (int n = 0; n < (PERF_TEST_COUNT + 1) * PERF_PRODUCER; ) {
+        Integer tmp;
+        if (producer1->mQueue.pop(tmp)) ++n;
+    }
+    delta = SystemTimeUs() - now;
+    INFO("ConcurrentQueue pop() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / (PERF_TEST_COUNT * PERF_PRODUCER));
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) {
+        threads[i].join();
+    }
+    threads.clear();
+    INFO("---");
+#endif
+}
+
+struct StackWorker : public Job {
+    LockFree::Stack<int>    mStack;
+    virtual void onJob() {
+        int64_t now = SystemTimeUs();
+        for (int i = 0; i < PERF_TEST_COUNT; ++i) {
+            int tmp;
+            mStack.push(i);
+            while (!mStack.pop(tmp)) { }
+        }
+        int64_t delta = SystemTimeUs() - now;
+        INFO("Stack push() & pop() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    }
+};
+
+// compare to LockFree::Stack
+struct VectorStackWorker : public Job {
+    Mutex           mLock;
+    Vector<int>     mVector;
+    virtual void onJob() {
+        int64_t now = SystemTimeUs();
+        for (int i = 0; i < PERF_TEST_COUNT; ++i) {
+            { AutoLock _l(mLock); mVector.push(i); }
+            { AutoLock _l(mLock); mVector.pop(); }
+        }
+        int64_t delta = SystemTimeUs() - now;
+        INFO("Vector push() & pop() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    }
+};
+
+void StackPerf() {
+    INFO("Stack push() | pop()");
+    int64_t now, delta;
+    LockFree::Stack<int> stack;
+    now = SystemTimeUs();
+    for (int i = 0; i <= PERF_TEST_COUNT; ++i) {
+        stack.push(i);
+    }
+    delta = SystemTimeUs() - now;
+    INFO("Stack push() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+
+    now = SystemTimeUs();
+    for (int i = PERF_TEST_COUNT; i >= 0; --i) {
+        int tmp;
+        CHECK_TRUE(stack.pop(tmp));
+        CHECK_EQ(tmp, i);
+    }
+    delta = SystemTimeUs() - now;
+    INFO("Stack pop() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    INFO("---");
+
+    INFO("Vector with Mutex push() | pop()");
+    Mutex lock;
+    Vector<int> vec;
+    now = SystemTimeUs();
+    for (int i = 0; i <= PERF_TEST_COUNT; ++i) {
+        AutoLock _l(lock);
+        vec.push(i);
+    }
+    delta = SystemTimeUs() - now;
+    INFO("Vector push() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+
+    now = SystemTimeUs();
+    for (int i = PERF_TEST_COUNT; i >= 0; --i) {
+        AutoLock _l(lock);
+        CHECK_EQ(vec.back(), i);
+        vec.pop();
+    }
+    delta = SystemTimeUs() - now;
+    INFO("Vector pop() test takes %" PRId64 " us, each %.3f us", delta, (double)delta / PERF_TEST_COUNT);
+    INFO("---");
+
+#if MULTI_THREAD
+    INFO("Stack multi producer & multi consumer");
+    sp<StackWorker> worker = new StackWorker;
+    Vector<Thread> threads;
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads.push(Thread(worker));
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads[i].run();
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads[i].join();
+    CHECK_TRUE(worker->mStack.empty());
+    threads.clear();
+    INFO("---");
+
+    INFO("Vector with Mutex multi producer & multi consumer");
+    sp<VectorStackWorker> vworker = new VectorStackWorker;
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads.push(Thread(vworker));
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads[i].run();
+    for (size_t i = 0; i < PERF_PRODUCER; ++i) threads[i].join();
+    CHECK_TRUE(vworker->mVector.empty());
+    threads.clear();
+    INFO("---");
 #endif
 }
 
@@ -402,12 +587,12 @@ void STDVectorPerf() {
     STDVectorPerfInt<Integer>();
 }
 
-void HashTablePerf() {
+void HashTablePerfInt(const sp<Allocator>& allocator) {
     int64_t now, delta;
     double each;
     INFO("HashTable insert() | erase()");
     now = SystemTimeUs();
-    HashTable<int, int> hashtable;
+    HashTable<int, int> hashtable(4, allocator);
     for (int i = 0; i <= PERF_TEST_COUNT; ++i) {
         hashtable.insert(i, i);
     }
@@ -433,6 +618,13 @@ void HashTablePerf() {
     INFO("---");
 }
 
+void HashTablePerf() {
+    INFO("HashTable with default allocator");
+    HashTablePerfInt(kAllocatorDefault);
+    INFO("HashTable with pool allocator");
+    HashTablePerfInt(new PoolAllocator(64));
+}
+
 #if defined(__APPLE__)
 void STDHashTablePerf() {
     int64_t now, delta;
@@ -531,14 +723,993 @@ void LooperPerf() {
     INFO("Thread() takes %" PRId64 " us, each %.3f us, overhead %.3f", delta, each, each / LOOPER_TEST_SLEEP - 1);
 }
 
+// sizes requested by SharedBuffer::Create() for short strings and by Buffer
+static const size_t kAllocatorPerfSizes[] = { 72, 120, 312, 1024, 4096 };
+
+struct AllocatorWorker : public Job {
+    sp<Allocator>   mAllocator;
+    size_t          mSize;
+    AllocatorWorker(const sp<Allocator>& allocator, size_t size) : mAllocator(allocator), mSize(size) { }
+    virtual void onJob() {
+        void * ptrs[16];
+        for (int i = 0; i < PERF_TEST_COUNT; i += 16) {
+            for (int j = 0; j < 16; ++j) ptrs[j] = mAllocator->allocate(mSize);
+            for (int j = 0; j < 16; ++j) mAllocator->deallocate(ptrs[j]);
+        }
+    }
+};
+
+void AllocatorPerfInt(const char * name, const sp<Allocator>& allocator) {
+    int64_t now, delta;
+    for (size_t i = 0; i < NELEM(kAllocatorPerfSizes); ++i) {
+        sp<AllocatorWorker> worker = new AllocatorWorker(allocator, kAllocatorPerfSizes[i]);
+        now = SystemTimeUs();
+        worker->onJob();
+        delta = SystemTimeUs() - now;
+        INFO("%s allocate(%zu) & deallocate() takes %" PRId64 " us, each %.3f us",
+                name, kAllocatorPerfSizes[i], delta, (double)delta / PERF_TEST_COUNT);
+
+#if MULTI_THREAD
+        Vector<Thread> threads;
+        for (size_t j = 0; j < PERF_PRODUCER; ++j) threads.push(Thread(worker));
+        now = SystemTimeUs();
+        for (size_t j = 0; j < PERF_PRODUCER; ++j) threads[j].run();
+        for (size_t j = 0; j < PERF_PRODUCER; ++j) threads[j].join();
+        delta = SystemTimeUs() - now;
+        INFO("%s allocate(%zu) & deallocate() with %d threads takes %" PRId64 " us, each %.3f us",
+                name, kAllocatorPerfSizes[i], PERF_PRODUCER, delta, (double)delta / (PERF_TEST_COUNT * PERF_PRODUCER));
+#endif
+    }
+    INFO("---");
+}
+
+// kAllocatorDefault may be replaced by environment
+struct MallocAllocator : public Allocator {
+    virtual void * allocate(size_t n)                   { return malloc(n);         }
+    virtual void * reallocate(void * ptr, size_t n)     { return realloc(ptr, n);   }
+    virtual void   deallocate(void * ptr)               { free(ptr);                }
+};
+
+// large buffers: allocate, first touch & deallocate, like video frames
+#define LARGE_BUFFER_SIZE   (8 * 1024 * 1024)
+#define LARGE_BUFFER_COUNT  (32)
+void LargeAllocatorPerf(const char * name, sp<Allocator> allocator) {
+    int64_t now = SystemTimeUs();
+    for (size_t i = 0; i < LARGE_BUFFER_COUNT; ++i) {
+        void * p = allocator->allocate(LARGE_BUFFER_SIZE);
+        memset(p, i, LARGE_BUFFER_SIZE);
+        allocator->deallocate(p);
+    }
+    int64_t delta = SystemTimeUs() - now;
+    INFO("%s allocate(%d) & touch takes %" PRId64 " us, each %.3f us",
+            name, LARGE_BUFFER_SIZE, delta, (double)delta / LARGE_BUFFER_COUNT);
+}
+
+void AllocatorPerf() {
+    AllocatorPerfInt("malloc", new MallocAllocator);
+    AllocatorPerfInt("ThreadCacheAllocator", new ThreadCacheAllocator);
+
+    // overhead of sampling heap profiler
+    heap_profile_start(2 * 1024 * 1024);
+    AllocatorPerfInt("malloc with heap profiler", new MallocAllocator);
+    heap_profile_stop();
+
+    LargeAllocatorPerf("malloc", new MallocAllocator);
+    LargeAllocatorPerf("HugePageAllocator", new HugePageAllocator);
+    LargeAllocatorPerf("HugePageAllocator(populate)", new HugePageAllocator(true));
+    INFO("---");
+}
+
+// short strings are inline, long strings are in SharedBuffer
+void StringPerfInt(const char * name, const char * s) {
+    int64_t now, delta;
+    double each;
+
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { String tmp(s); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("String(%s) construct test takes %" PRId64 " us, each %.3f us", name, delta, each);
+
+    const String str(s);
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { String tmp(str); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("String(%s) copy test takes %" PRId64 " us, each %.3f us", name, delta, each);
+
+    size_t hash = 0;
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { hash += str.hash(); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("String(%s) hash test takes %" PRId64 " us, each %.3f us, %zu", name, delta, each, hash);
+}
+
+// Message keys: literal is interned on each call, static atom is not
+void MessagePerf() {
+    int64_t now, delta;
+    double each;
+    sp<Message> message = new Message;
+    message->setInt32("width", 1920);
+
+    int32_t sum = 0;
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { sum += message->findInt32("width"); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("Message findInt32(literal) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    static const Atom kWidth("width");
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { sum += message->findInt32(kWidth); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("Message findInt32(atom) test takes %" PRId64 " us, each %.3f us, %d", delta, each, sum);
+
+    size_t equals = 0;
+    const Atom a("a string longer than inline storage");
+    const Atom b("a string longer than inline storage");
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { equals += (a == b); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("Atom compare test takes %" PRId64 " us, each %.3f us, %zu", delta, each, equals);
+
+    for (int i = 0; i < 16; ++i) message->setInt64(String::format("key-%d", i), i);
+    size_t length = 0;
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT / 100; ++i) { length += message->string().size(); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / (PERF_TEST_COUNT / 100);
+    INFO("Message string() test takes %" PRId64 " us, each %.3f us, %zu", delta, each, length);
+    INFO("---");
+}
+
+// append heavy: buffer grows in place within its capacity
+void StringPerf() {
+    int64_t now, delta;
+    double each;
+
+    StringPerfInt("short", "width");
+    StringPerfInt("long", "a string longer than inline storage");
+
+    now = SystemTimeUs();
+    String s;
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { s.append("a", 1); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("String append() test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    sp<InstrumentedAllocator> allocator = new InstrumentedAllocator("perf");
+    now = SystemTimeUs();
+    SharedBuffer * buffer = SharedBuffer::Create(allocator, 1);
+    for (int i = 2; i <= PERF_TEST_COUNT; ++i) { buffer = buffer->edit(i); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("SharedBuffer edit(+1) test takes %" PRId64 " us, each %.3f us, %zu reallocations",
+            delta, each, allocator->snapshot().mReallocations);
+    buffer->ReleaseBuffer();
+
+    // format & append vs format in place
+    String formatted;
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { formatted.append(String::format("%d,", i)); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("String append(format()) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    StringBuilder builder;
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { builder.appendFormat("%d,", i); }
+    formatted = builder.toString();
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("StringBuilder appendFormat() test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    // parse url with substring vs view
+    String url = "pipe://12+4096+1048576";
+    int64_t sum = 0;
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) {
+        int index0 = url.indexOf(7, "+");
+        int index1 = url.indexOf(index0 + 1, "+");
+        sum += url.substring(7, index0 - 7).toInt32();
+        sum += url.substring(index0 + 1, index1 - index0 - 1).toInt64();
+        sum += url.substring(index1 + 1).toInt64();
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("String substring() parse test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) {
+        StringView view = url;
+        ssize_t index0 = view.indexOf(7, '+');
+        ssize_t index1 = view.indexOf(index0 + 1, '+');
+        sum -= view.substring(7, index0 - 7).toInt32();
+        sum -= view.substring(index0 + 1, index1 - index0 - 1).toInt64();
+        sum -= view.substring(index1 + 1).toInt64();
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    CHECK_EQ(sum, 0);
+    INFO("StringView substring() parse test takes %" PRId64 " us, each %.3f us", delta, each);
+    INFO("---");
+}
+
+// old hash of String & integers, for comparison
+static size_t Hash31(const char * s, size_t n) {
+    size_t x = 0;
+    for (size_t i = 0; i < n; ++i) x = (x * 31) + s[i];
+    return x;
+}
+
+// longest chain of n strided int keys in a table grown like HashTable
+template <class HASH> static size_t MaxChain(size_t n, size_t stride, HASH h) {
+    size_t length = 16;
+    while (n > (length * 3) / 4) length *= 2;
+    Vector<size_t> chains(length);
+    for (size_t i = 0; i < length; ++i) chains.push(0);
+    size_t max = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t& chain = chains[h(i * stride) % length];
+        if (++chain > max) max = chain;
+    }
+    return max;
+}
+static size_t HashIdentity(size_t x)    { return x;                 }
+static size_t HashMixed(size_t x)       { return hash<int>(x);      }
+
+void HashPerf() {
+    int64_t now, delta;
+    double each;
+    static const size_t kLengths[] = { 8, 32, 256, 4096 };
+
+    char data[4096];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = 'a' + i % 26;
+    for (size_t k = 0; k < NELEM(kLengths); ++k) {
+        const size_t n = kLengths[k];
+        const int count = PERF_TEST_COUNT / (n / 8);
+        size_t sum = 0;
+
+        now = SystemTimeUs();
+        for (int i = 0; i < count; ++i) { data[0] = i; sum += Hash31(data, n); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / count;
+        INFO("hash x*31+c %zu bytes test takes %" PRId64 " us, each %.3f us, %.0f MB/s",
+                n, delta, each, n / each);
+
+        now = SystemTimeUs();
+        for (int i = 0; i < count; ++i) { data[0] = i; sum += HashBytes(data, n); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / count;
+        INFO("HashBytes %zu bytes test takes %" PRId64 " us, each %.3f us, %.0f MB/s, %zu",
+                n, delta, each, n / each, sum);
+    }
+
+    for (size_t stride = 1; stride <= 4096; stride *= 64) {
+        INFO("HashTable<int> 100000 keys of stride %zu, max chain %zu -> %zu", stride,
+                MaxChain(100000, stride, HashIdentity), MaxChain(100000, stride, HashMixed));
+    }
+
+    HashTable<int, int> table;
+    now = SystemTimeUs();
+    for (int i = 0; i < 100000; ++i) { table.insert(i * 4096, i); }
+    for (int i = 0; i < 100000; ++i) { table.find(i * 4096); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / 200000;
+    INFO("HashTable<int> insert() & find() of stride 4096 test takes %" PRId64 " us, each %.3f us",
+            delta, each);
+    INFO("---");
+}
+
+// string kernels on a 4k header blob, at each simd level
+#define SIMD_TEST_COUNT     (PERF_TEST_COUNT / 100)
+void StringSIMDPerf() {
+    int64_t now, delta;
+    double each;
+    static const char * kNames[] = { "none", "sse2", "avx2", "neon" };
+
+    String blob;
+    for (size_t i = 0; blob.size() < 4096; ++i) {
+        blob.append(String::format("X-Header-%zu: some value of header %zu\r\n", i, i));
+    }
+    String upper = blob;
+    upper.upper();
+
+    const str_simd_level_t saved = str_simd_level();
+    for (int level = STR_SIMD_NONE; level <= STR_SIMD_NEON; ++level) {
+        if (str_simd_set_level((str_simd_level_t)level) != level) continue;
+        const char * name = kNames[level];
+        ssize_t sum = 0;
+
+        now = SystemTimeUs();
+        for (int i = 0; i < SIMD_TEST_COUNT; ++i) { sum += blob.indexOf("Content-Length"); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / SIMD_TEST_COUNT;
+        INFO("String(%s) indexOf() test takes %" PRId64 " us, each %.3f us", name, delta, each);
+
+        now = SystemTimeUs();
+        for (int i = 0; i < SIMD_TEST_COUNT; ++i) { sum += blob.lastIndexOf("Content-Length"); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / SIMD_TEST_COUNT;
+        INFO("String(%s) lastIndexOf() test takes %" PRId64 " us, each %.3f us", name, delta, each);
+
+        now = SystemTimeUs();
+        for (int i = 0; i < SIMD_TEST_COUNT; ++i) { sum += blob.compareIgnoreCase(upper); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / SIMD_TEST_COUNT;
+        INFO("String(%s) compareIgnoreCase() test takes %" PRId64 " us, each %.3f us", name, delta, each);
+
+        String tmp = blob;
+        now = SystemTimeUs();
+        for (int i = 0; i < SIMD_TEST_COUNT; ++i) { tmp.upper(); tmp.lower(); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / SIMD_TEST_COUNT;
+        INFO("String(%s) upper() & lower() test takes %" PRId64 " us, each %.3f us, %zd", name, delta, each, sum);
+    }
+    str_simd_set_level(saved);
+    INFO("---");
+}
+
+// utf8 <-> utf16 of subtitles, vs ConvertUTF
+static void UTFPerf(const char * text, const char * tag) {
+    int64_t now, delta;
+    double each;
+    static const char * kNames[] = { "none", "sse2", "avx2", "neon" };
+
+    String blob;
+    while (blob.size() < 4096) blob.append(text);
+    sp<Buffer> utf16 = blob.toUTF16LE();
+    const size_t units = utf16->size() / 2;
+    UTF16 * ref16 = new UTF16[blob.size()];
+    UTF8 * ref8 = new UTF8[3 * units];
+    size_t sum = 0;
+
+    now = SystemTimeUs();
+    for (int i = 0; i < SIMD_TEST_COUNT; ++i) {
+        const UTF8 * source = (const UTF8 *)blob.c_str();
+        UTF16 * target = ref16;
+        ConvertUTF8toUTF16(&source, source + blob.size(), &target, ref16 + blob.size(), strictConversion);
+        sum += target - ref16;
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / SIMD_TEST_COUNT;
+    INFO("ConvertUTF8toUTF16(%s) test takes %" PRId64 " us, each %.3f us", tag, delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < SIMD_TEST_COUNT; ++i) {
+        const UTF16 * source = ref16;
+        UTF8 * target = ref8;
+        ConvertUTF16toUTF8(&source, source + units, &target, ref8 + 3 * units, lenientConversion);
+        sum += target - ref8;
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / SIMD_TEST_COUNT;
+    INFO("ConvertUTF16toUTF8(%s) test takes %" PRId64 " us, each %.3f us", tag, delta, each);
+
+    const str_simd_level_t saved = str_simd_level();
+    for (int level = STR_SIMD_NONE; level <= STR_SIMD_NEON; ++level) {
+        if (str_simd_set_level((str_simd_level_t)level) != level) continue;
+        const char * name = kNames[level];
+
+        now = SystemTimeUs();
+        for (int i = 0; i < SIMD_TEST_COUNT; ++i) { sum += blob.isUTF8(); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / SIMD_TEST_COUNT;
+        INFO("String(%s) isUTF8(%s) test takes %" PRId64 " us, each %.3f us", name, tag, delta, each);
+
+        now = SystemTimeUs();
+        for (int i = 0; i < SIMD_TEST_COUNT; ++i) { sum += blob.toUTF16LE()->size(); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / SIMD_TEST_COUNT;
+        INFO("String(%s) toUTF16LE(%s) test takes %" PRId64 " us, each %.3f us", name, tag, delta, each);
+
+        now = SystemTimeUs();
+        for (int i = 0; i < SIMD_TEST_COUNT; ++i) { sum += String::UTF16LE(utf16->data(), utf16->size()).size(); }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / SIMD_TEST_COUNT;
+        INFO("String(%s) UTF16LE(%s) test takes %" PRId64 " us, each %.3f us, %zu", name, tag, delta, each, sum);
+    }
+    str_simd_set_level(saved);
+    delete [] ref16;
+    delete [] ref8;
+    INFO("---");
+}
+
+void UTFPerf() {
+    UTFPerf("00:01:02,345 --> 00:01:04,567\nWhere are you going tonight?\n\n", "ascii");
+    UTFPerf("00:01:02,345 --> 00:01:04,567\n\xe4\xbd\xa0\xe4\xbb\x8a\xe6\x99\x9a"
+            "\xe8\xa6\x81\xe5\x8e\xbb\xe5\x93\xaa\xe9\x87\x8c\xef\xbc\x9f\n\n", "cjk");
+}
+
+// number <-> chars, vs printf & strto*
+#define NUMBER_TEST_COUNT   (PERF_TEST_COUNT / 10)
+void NumberPerf() {
+    int64_t now, delta;
+    double each;
+
+    enum { kValues = 1024 };
+    int64_t * ints = new int64_t[kValues];
+    double * doubles = new double[kValues];
+    char (* intChars)[kNumberChars] = new char[kValues][kNumberChars];
+    char (* doubleChars)[kNumberChars] = new char[kValues][kNumberChars];
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < kValues; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        ints[i] = (int64_t)x >> (x % 56);
+        doubles[i] = (double)(x >> 11) / (1ULL << (x % 53));
+        snprintf(intChars[i], kNumberChars, "%" PRId64, ints[i]);
+        snprintf(doubleChars[i], kNumberChars, "%.17g", doubles[i]);
+    }
+
+    char buf[kNumberChars + 1];
+    size_t sum = 0;
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) { sum += snprintf(buf, sizeof(buf), "%" PRId64, ints[i % kValues]); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("snprintf(int64_t) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) { sum += ToChars(buf, ints[i % kValues]); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("ToChars(int64_t) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) { sum += snprintf(buf, sizeof(buf), "%.17g", doubles[i % kValues]); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("snprintf(double) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) { sum += ToChars(buf, doubles[i % kValues]); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("ToChars(double) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) { sum += String(doubles[i % kValues]).size(); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("String(double) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) { sum += strtoll(intChars[i % kValues], NULL, 10); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("strtoll() test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) {
+        const char * s = intChars[i % kValues];
+        int64_t v;
+        sum += FromChars(s, strlen(s), v);
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("FromChars(int64_t) test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    double total = 0;
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) { total += strtod(doubleChars[i % kValues], NULL); }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("strtod() test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (int i = 0; i < NUMBER_TEST_COUNT; ++i) {
+        const char * s = doubleChars[i % kValues];
+        double v;
+        sum += FromChars(s, strlen(s), v);
+        total += v;
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / NUMBER_TEST_COUNT;
+    INFO("FromChars(double) test takes %" PRId64 " us, each %.3f us, %zu %g", delta, each, sum, total);
+
+    delete [] ints;
+    delete [] doubles;
+    delete [] intChars;
+    delete [] doubleChars;
+    INFO("---");
+}
+
+// build a large output, like a playlist
+#define CORD_TEST_COUNT     (PERF_TEST_COUNT / 100)
+void CordPerf() {
+    int64_t now, delta;
+    double each;
+    static const char * kLine = "#EXTINF:10.000,\nhttp://example.com/segment.ts\n";
+    String header;
+    for (size_t i = 0; i < 64; ++i) header.append("#EXT-X-HEADER:0123456789\n");
+
+    now = SystemTimeUs();
+    String s;
+    for (int i = 0; i < CORD_TEST_COUNT; ++i) { s.append(kLine); }
+    s = header + s;
+    delta = SystemTimeUs() - now;
+    each = (double)delta / CORD_TEST_COUNT;
+    INFO("String append() test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    StringBuilder builder;
+    for (int i = 0; i < CORD_TEST_COUNT; ++i) { builder.append(kLine); }
+    String built = header + builder.toString();
+    delta = SystemTimeUs() - now;
+    each = (double)delta / CORD_TEST_COUNT;
+    INFO("StringBuilder append() test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    Cord cord;
+    for (int i = 0; i < CORD_TEST_COUNT; ++i) { cord.append(kLine); }
+    cord.prepend(header);
+    delta = SystemTimeUs() - now;
+    each = (double)delta / CORD_TEST_COUNT;
+    INFO("Cord append() test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    String flat = cord.string();
+    delta = SystemTimeUs() - now;
+    INFO("Cord string() test takes %" PRId64 " us, %zu chunks, %zu %zu %zu", delta,
+            cord.chunks(), s.size(), built.size(), flat.size());
+    INFO("---");
+}
+
+#define RING_TEST_COUNT     (PERF_TEST_COUNT / 10)
+// a stream through a half full ring, default allocator is mirrored
+void RingPerf() {
+    int64_t now, delta;
+    double each;
+    char chunk[4096];
+    memset(chunk, 0xa5, sizeof(chunk));
+
+    sp<Allocator> allocators[] = { kAllocatorDefault, GetAlignedAllocator(64) };
+    const char * names[] = { "mirrored", "fallback" };
+    for (size_t k = 0; k < 2; ++k) {
+        sp<Buffer> ring = new Buffer(64 * 1024, Buffer::Ring, allocators[k]);
+        ring->write('x', 32 * 1024 + 1000);
+        now = SystemTimeUs();
+        for (int i = 0; i < RING_TEST_COUNT; ++i) {
+            ring->write(chunk, sizeof(chunk));
+            ring->read(chunk, sizeof(chunk));
+        }
+        delta = SystemTimeUs() - now;
+        each = (double)delta / RING_TEST_COUNT;
+        INFO("Ring %s write/read 4k test takes %" PRId64 " us, each %.3f us", names[k], delta, each);
+    }
+    INFO("---");
+}
+
+#define CHAIN_TEST_COUNT    (PERF_TEST_COUNT / 100)
+// frame payloads with headers, copy vs reference
+void BufferChainPerf() {
+    int64_t now, delta;
+    double each;
+    sp<Buffer> header = new Buffer("\x00\x00\x00\x01", 4);
+    sp<Buffer> payload = new Buffer(1400);
+    payload->write(0x5a, 1400);
+
+    now = SystemTimeUs();
+    sp<Buffer> flat = new Buffer(CHAIN_TEST_COUNT * 1404);
+    for (int i = 0; i < CHAIN_TEST_COUNT; ++i) {
+        flat->write(*header);
+        flat->write(*payload);
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / CHAIN_TEST_COUNT;
+    INFO("Buffer write() framing test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    BufferChain chain;
+    for (int i = 0; i < CHAIN_TEST_COUNT; ++i) {
+        chain.append(header);
+        chain.append(payload);
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / CHAIN_TEST_COUNT;
+    INFO("BufferChain append() framing test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    BitReader reader(chain);
+    uint64_t sum = 0;
+    for (int i = 0; i < CHAIN_TEST_COUNT; ++i) {
+        sum += reader.rb32();
+        reader.skipBytes(1400);
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / CHAIN_TEST_COUNT;
+    INFO("BitReader over chain test takes %" PRId64 " us, each %.3f us, %" PRIu64, delta, each, sum);
+    INFO("---");
+}
+
+// slice a 1M packet into nal units, copy vs shared storage
+void BufferSlicePerf() {
+    int64_t now, delta;
+    double each;
+    sp<Buffer> packet = new Buffer(1024 * 1024);
+    packet->write(0x5a, packet->capacity());
+    const size_t count = packet->size() / 1024;
+    now = SystemTimeUs();
+    for (size_t i = 0; i < count; ++i) {
+        sp<Buffer> nal = new Buffer(packet->data() + i * 1024, 1024);
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / count;
+    INFO("Buffer copy 1k slices test takes %" PRId64 " us, each %.3f us", delta, each);
+
+    now = SystemTimeUs();
+    for (size_t i = 0; i < count; ++i) {
+        sp<Buffer> nal = packet->split(i * 1024, 1024);
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / count;
+    INFO("Buffer split() 1k slices test takes %" PRId64 " us, each %.3f us", delta, each);
+    INFO("---");
+}
+
+// hot paths guarded by hardening checks, build with HARDENING=full|fast|none
+void HardeningPerf() {
+    int64_t now, delta;
+    double each;
+    INFO("hardening level %d", ABE_HARDENING);
+
+    SharedBuffer * buffer = SharedBuffer::Create(kAllocatorDefault, 64);
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) {
+        SharedBuffer * copy = buffer->RetainBuffer()->edit();  // cow
+        copy->ReleaseBuffer();
+    }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("SharedBuffer retain & edit() & release test takes %" PRId64 " us, each %.3f us", delta, each);
+    buffer->ReleaseBuffer();
+
+    Vector<int> vec;
+    for (int i = 0; i < 1024; ++i) vec.push(i);
+    const Vector<int>& cvec = vec;
+    int sum = 0;
+    now = SystemTimeUs();
+    for (int i = 0; i < PERF_TEST_COUNT; ++i) { sum += cvec[i & 1023]; }
+    delta = SystemTimeUs() - now;
+    each = (double)delta / PERF_TEST_COUNT;
+    INFO("Vector operator[] test takes %" PRId64 " us, each %.3f us, sum %d", delta, each, sum);
+    INFO("---");
+}
+
+// scaling benchmark:
+// sweep producer/consumer counts & payload sizes, report ops/s and
+// latency percentiles of each primitive to csv or json.
+// perf --scaling [--json] [--count N] [--output file]
+#define SCALING_TEST_COUNT  100000
+
+static const size_t kScalingProducers[]   = { 1, 2, 4, 8 };
+static const size_t kScalingConsumers[]   = { 1, 2, 4 };
+static const size_t kScalingPayloads[]    = { 16, 64, 256 };
+
+struct ScalingResult {
+    const char *    primitive;
+    size_t          producers;
+    size_t          consumers;
+    size_t          payload;
+    size_t          ops;
+    double          seconds;
+    double          p50;        // us
+    double          p99;
+    double          p999;
+    double          max;
+};
+
+// push timestamp is carried by the payload
+template <size_t N> struct Payload {
+    int64_t     ts;
+    char        data[N - sizeof(int64_t)];
+};
+
+// adapters with the same push/pop interface
+template <class T> struct LockFreeQueueAdapter {
+    static const char * Name() { return "LockFree::Queue"; }
+    LockFree::Queue<T>  mQueue;
+    void push(const T& v)   { mQueue.push(v);           }
+    bool pop(T& v)          { return mQueue.pop(v);     }
+};
+
+template <class T> struct ConcurrentQueueAdapter {
+    static const char * Name() { return "LockFree::ConcurrentQueue"; }
+    LockFree::ConcurrentQueue<T>    mQueue;
+    void push(const T& v)   { mQueue.push(v);           }
+    bool pop(T& v)          { return mQueue.pop(v);     }
+};
+
+template <class T> struct BlockingQueueAdapter {
+    static const char * Name() { return "BlockingQueue"; }
+    BlockingQueue<T>    mQueue;
+    void push(const T& v)   { mQueue.push(v);               }
+    bool pop(T& v)          { return mQueue.pop(v, 1000);   }   // 1ms, check stop
+};
+
+// baselines
+template <class T> struct MutexListAdapter {
+    static const char * Name() { return "Mutex+List"; }
+    Mutex       mLock;
+    List<T>     mList;
+    void push(const T& v)   { AutoLock _l(mLock); mList.push(v); }
+    bool pop(T& v) {
+        AutoLock _l(mLock);
+        if (mList.empty()) return false;
+        v = mList.front();
+        mList.pop();
+        return true;
+    }
+};
+
+template <class T> struct MutexSTDListAdapter {
+    static const char * Name() { return "Mutex+std::list"; }
+    Mutex       mLock;
+    list<T>     mList;
+    void push(const T& v)   { AutoLock _l(mLock); mList.push_back(v); }
+    bool pop(T& v) {
+        AutoLock _l(mLock);
+        if (mList.empty()) return false;
+        v = mList.front();
+        mList.pop_front();
+        return true;
+    }
+};
+
+static void ScalingSummary(vector<int64_t>& latency, ScalingResult& result) {
+    sort(latency.begin(), latency.end());
+    const size_t n = latency.size();
+    if (n == 0) return;
+    result.p50  = latency[n * 50 / 100] / 1E3;
+    result.p99  = latency[n * 99 / 100] / 1E3;
+    result.p999 = latency[n * 999 / 1000] / 1E3;
+    result.max  = latency[n - 1] / 1E3;
+}
+
+template <class QUEUE, class T> struct ScalingQueueJob : public Job {
+    QUEUE               mQueue;
+    size_t              mCount;         // items per producer
+    size_t              mTotal;
+    volatile size_t     mStarted;
+    volatile int        mGo;
+    volatile size_t     mProducerId;
+    volatile size_t     mConsumed;
+    Mutex               mLock;
+    vector<int64_t>     mLatency;       // ns
+
+    ScalingQueueJob(size_t count, size_t total) : mCount(count), mTotal(total),
+        mStarted(0), mGo(0), mProducerId(0), mConsumed(0) { mLatency.reserve(total); }
+
+    virtual void onJob() {
+        // the first mProducers threads are producers
+        const size_t id = __atomic_fetch_add(&mProducerId, 1, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&mStarted, 1, __ATOMIC_SEQ_CST);
+        while (!__atomic_load_n(&mGo, __ATOMIC_SEQ_CST)) { }
+
+        if (id < mTotal / mCount) {
+            T v;
+            for (size_t i = 0; i < mCount; ++i) {
+                v.ts = SystemTimeNs();
+                mQueue.push(v);
+            }
+        } else {
+            vector<int64_t> latency;
+            latency.reserve(mTotal);
+            T v;
+            while (__atomic_load_n(&mConsumed, __ATOMIC_SEQ_CST) < mTotal) {
+                if (mQueue.pop(v)) {
+                    latency.push_back(SystemTimeNs() - v.ts);
+                    __atomic_add_fetch(&mConsumed, 1, __ATOMIC_SEQ_CST);
+                }
+            }
+            AutoLock _l(mLock);
+            mLatency.insert(mLatency.end(), latency.begin(), latency.end());
+        }
+    }
+};
+
+template <template <class> class QUEUE, size_t N>
+static ScalingResult ScalingQueue(size_t producers, size_t consumers, size_t count) {
+    typedef ScalingQueueJob<QUEUE<Payload<N> >, Payload<N> > job_t;
+    sp<job_t> job = new job_t(count / producers, (count / producers) * producers);
+    Vector<Thread> threads;
+    for (size_t i = 0; i < producers + consumers; ++i) threads.push(Thread(job));
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].run();
+    while (__atomic_load_n(&job->mStarted, __ATOMIC_SEQ_CST) < threads.size()) { }
+
+    int64_t now = SystemTimeNs();
+    __atomic_store_n(&job->mGo, 1, __ATOMIC_SEQ_CST);
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+    ScalingResult result;
+    result.primitive    = QUEUE<Payload<N> >::Name();
+    result.producers    = producers;
+    result.consumers    = consumers;
+    result.payload      = N;
+    result.ops          = job->mTotal;
+    result.seconds      = (SystemTimeNs() - now) / 1E9;
+    ScalingSummary(job->mLatency, result);
+    return result;
+}
+
+// Looper::post & DispatchQueue::dispatch: consumer is always the looper thread
+struct ScalingLooperJob : public Job {
+    int64_t             mTs;
+    vector<int64_t> *   mLatency;       // only touched by looper thread
+    volatile size_t *   mConsumed;
+    ScalingLooperJob(int64_t ts, vector<int64_t> * latency, volatile size_t * consumed) :
+        mTs(ts), mLatency(latency), mConsumed(consumed) { }
+    virtual void onJob() {
+        mLatency->push_back(SystemTimeNs() - mTs);
+        __atomic_add_fetch(mConsumed, 1, __ATOMIC_SEQ_CST);
+    }
+};
+
+struct ScalingLooperProducer : public Job {
+    sp<Looper>          mLooper;
+    sp<DispatchQueue>   mDispatch;      // dispatch instead of post if not NULL
+    size_t              mCount;
+    volatile size_t     mStarted;
+    volatile int        mGo;
+    volatile size_t     mConsumed;
+    vector<int64_t>     mLatency;
+
+    ScalingLooperProducer(size_t count) : mCount(count), mStarted(0), mGo(0), mConsumed(0) { }
+
+    virtual void onJob() {
+        __atomic_add_fetch(&mStarted, 1, __ATOMIC_SEQ_CST);
+        while (!__atomic_load_n(&mGo, __ATOMIC_SEQ_CST)) { }
+        for (size_t i = 0; i < mCount; ++i) {
+            sp<Job> job = new ScalingLooperJob(SystemTimeNs(), &mLatency, &mConsumed);
+            if (mDispatch != NULL)  mDispatch->dispatch(job);
+            else                    mLooper->post(job);
+        }
+    }
+};
+
+static ScalingResult ScalingLooper(size_t producers, size_t count, bool dispatch) {
+    sp<ScalingLooperProducer> job = new ScalingLooperProducer(count / producers);
+    const size_t total = (count / producers) * producers;
+    job->mLatency.reserve(total);
+    job->mLooper = new Looper("ScalingLooper");
+    if (dispatch) job->mDispatch = new DispatchQueue(job->mLooper);
+
+    Vector<Thread> threads;
+    for (size_t i = 0; i < producers; ++i) threads.push(Thread(job));
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].run();
+    while (__atomic_load_n(&job->mStarted, __ATOMIC_SEQ_CST) < threads.size()) { }
+
+    int64_t now = SystemTimeNs();
+    __atomic_store_n(&job->mGo, 1, __ATOMIC_SEQ_CST);
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    while (__atomic_load_n(&job->mConsumed, __ATOMIC_SEQ_CST) < total) { SleepTimeUs(100); }
+
+    ScalingResult result;
+    result.primitive    = dispatch ? "DispatchQueue::dispatch" : "Looper::post";
+    result.producers    = producers;
+    result.consumers    = 1;
+    result.payload      = sizeof(ScalingLooperJob);
+    result.ops          = total;
+    result.seconds      = (SystemTimeNs() - now) / 1E9;
+    ScalingSummary(job->mLatency, result);
+
+    job->mDispatch.clear();
+    job->mLooper.clear();
+    return result;
+}
+
+template <template <class> class QUEUE>
+static void ScalingQueueSweep(vector<ScalingResult>& results, size_t count) {
+    for (size_t i = 0; i < NELEM(kScalingPayloads); ++i) {
+        for (size_t p = 0; p < NELEM(kScalingProducers); ++p) {
+            for (size_t c = 0; c < NELEM(kScalingConsumers); ++c) {
+                ScalingResult result;
+                switch (kScalingPayloads[i]) {
+                    case 16:    result = ScalingQueue<QUEUE, 16>(kScalingProducers[p], kScalingConsumers[c], count);   break;
+                    case 64:    result = ScalingQueue<QUEUE, 64>(kScalingProducers[p], kScalingConsumers[c], count);   break;
+                    default:    result = ScalingQueue<QUEUE, 256>(kScalingProducers[p], kScalingConsumers[c], count);  break;
+                }
+                INFO("%s: %zu producer(s) & %zu consumer(s), payload %zu, %.0f ops/s, p99 %.3f us",
+                        result.primitive, result.producers, result.consumers, result.payload,
+                        result.ops / result.seconds, result.p99);
+                results.push_back(result);
+            }
+        }
+    }
+}
+
+static void ScalingReport(const vector<ScalingResult>& results, FILE * fp, bool json) {
+    if (json) fprintf(fp, "[\n");
+    else fprintf(fp, "primitive,producers,consumers,payload,ops,seconds,ops_per_sec,p50_us,p99_us,p999_us,max_us\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScalingResult& r = results[i];
+        if (json) {
+            fprintf(fp, "  { \"primitive\": \"%s\", \"producers\": %zu, \"consumers\": %zu, \"payload\": %zu, "
+                    "\"ops\": %zu, \"seconds\": %.6f, \"ops_per_sec\": %.0f, "
+                    "\"p50_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f }%s\n",
+                    r.primitive, r.producers, r.consumers, r.payload,
+                    r.ops, r.seconds, r.ops / r.seconds,
+                    r.p50, r.p99, r.p999, r.max, i + 1 < results.size() ? "," : "");
+        } else {
+            fprintf(fp, "%s,%zu,%zu,%zu,%zu,%.6f,%.0f,%.3f,%.3f,%.3f,%.3f\n",
+                    r.primitive, r.producers, r.consumers, r.payload,
+                    r.ops, r.seconds, r.ops / r.seconds,
+                    r.p50, r.p99, r.p999, r.max);
+        }
+    }
+    if (json) fprintf(fp, "]\n");
+}
+
+int ScalingPerf(int argc, char ** argv) {
+    bool json = false;
+    size_t count = SCALING_TEST_COUNT;
+    const char * output = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--json"))                     json = true;
+        else if (!strcmp(argv[i], "--csv"))                 json = false;
+        else if (!strcmp(argv[i], "--count") && i + 1 < argc)   count = strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)  output = argv[++i];
+    }
+    if (output == NULL) output = json ? "perf_scaling.json" : "perf_scaling.csv";
+
+    size_t minCount = 0;
+    for (size_t p = 0; p < NELEM(kScalingProducers); ++p) {
+        if (kScalingProducers[p] > minCount) minCount = kScalingProducers[p];
+    }
+    if (count < minCount) {
+        WARN("--count %zu is less than %zu producers, use %zu", count, minCount, minCount);
+        count = minCount;
+    }
+
+    vector<ScalingResult> results;
+    ScalingQueueSweep<LockFreeQueueAdapter>(results, count);
+    ScalingQueueSweep<ConcurrentQueueAdapter>(results, count);
+    ScalingQueueSweep<BlockingQueueAdapter>(results, count);
+    ScalingQueueSweep<MutexListAdapter>(results, count);
+    ScalingQueueSweep<MutexSTDListAdapter>(results, count);
+    for (size_t p = 0; p < NELEM(kScalingProducers); ++p) {
+        results.push_back(ScalingLooper(kScalingProducers[p], count, false));
+        results.push_back(ScalingLooper(kScalingProducers[p], count, true));
+    }
+
+    FILE * fp = fopen(output, "w");
+    if (fp == NULL) {
+        ERROR("open %s failed", output);
+        return 1;
+    }
+    ScalingReport(results, fp, json);
+    fclose(fp);
+    INFO("scaling report written to %s", output);
+    return 0;
+}
+
 int main(int argc, char ** argv) {
+    if (argc > 1 && !strcmp(argv[1], "--scaling")) {
+        return ScalingPerf(argc - 1, argv + 1);
+    }
 
+    AllocatorPerf();
     QueuePerf();
+    StackPerf();
     ListPerf();
     STDListPerf();
     VectorPerf();
     STDVectorPerf();
     HashTablePerf();
+    StringPerf();
+    StringSIMDPerf();
+    UTFPerf();
+    NumberPerf();
+    CordPerf();
+    RingPerf();
+    BufferChainPerf();
+    BufferSlicePerf();
+    HashPerf();
+    HardeningPerf();
+    MessagePerf();
 #if defined(__APPLE__)
     STDHashTablePerf();
 #endif    
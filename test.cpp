@@ -34,9 +34,15 @@
 #define REMOVE_ATOMICS
 #define LOG_TAG "Toolkit"
 #include <ABE/ABE.h>
+#include <ABE/core/debug/heapprof.h>
+#include <ABE/core/private/strsimd.h>
+#include <ABE/core/private/ConvertUTF.h>
 
 #include <gtest/gtest.h>
 #include <inttypes.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/types.h>
@@ -109,6 +115,33 @@ void testSharedObject() {
     sp_shared1.clear();
 }
 
+void testSharedBuffer() {
+    sp<InstrumentedAllocator> allocator = new InstrumentedAllocator("sharedbuffer");
+    SharedBuffer * buffer = SharedBuffer::Create(allocator, 1);
+    ASSERT_GE(buffer->capacity(), buffer->size());
+
+    // grow by one byte: in place within capacity, no realloc each time
+    for (size_t i = 1; i <= 4096; ++i) {
+        buffer = buffer->edit(i);
+        ASSERT_EQ(buffer->size(), i);
+        ASSERT_GE(buffer->capacity(), i);
+        buffer->data()[i - 1] = (char)i;
+    }
+    ASSERT_LT(allocator->snapshot().mReallocations, 64);
+    for (size_t i = 1; i <= 4096; ++i) ASSERT_EQ(buffer->data()[i - 1], (char)i);
+
+    // shared buffer is copied even if it fits capacity
+    SharedBuffer * copy = buffer->RetainBuffer();
+    copy = copy->edit(buffer->size() + 1);
+    ASSERT_TRUE(copy != buffer);
+    ASSERT_EQ(buffer->size(), 4096);
+    ASSERT_EQ(copy->size(), 4097);
+    ASSERT_EQ(memcmp(copy->data(), buffer->data(), 4096), 0);
+    copy->ReleaseBuffer();
+    buffer->ReleaseBuffer();
+    ASSERT_EQ(allocator->snapshot().mLive, 0);
+}
+
 void testAllocator() {
     sp<Allocator> allocator = kAllocatorDefault;
     void * p = allocator->allocate(1024);
@@ -118,6 +151,273 @@ void testAllocator() {
     ASSERT_TRUE(p != NULL);
 
     allocator->deallocate(p);
+
+    // reallocate keeps data & alignment with multi blocks alive
+    allocator = GetAlignedAllocator(64);
+    uint8_t * a = (uint8_t *)allocator->allocate(256);
+    uint8_t * b = (uint8_t *)allocator->allocate(8);
+    for (size_t i = 0; i < 256; ++i) a[i] = (uint8_t)i;
+    a = (uint8_t *)allocator->reallocate(a, 4096);
+    ASSERT_EQ((uintptr_t)a & 63, 0);
+    for (size_t i = 0; i < 256; ++i) ASSERT_EQ(a[i], (uint8_t)i);
+    allocator->deallocate(a);
+    allocator->deallocate(b);
+}
+
+struct ThreadCacheWorker : public Job {
+    sp<Allocator>   mAllocator;
+    LockFree::Queue<void *> mQueue;     // free blocks from other threads
+    ThreadCacheWorker() : mAllocator(new ThreadCacheAllocator) { }
+    virtual void onJob() {
+        for (size_t i = 0; i < 10000; ++i) {
+            const size_t n = (i * 37) % 5000 + 1;
+            uint8_t * p = (uint8_t *)mAllocator->allocate(n);
+            p[0] = p[n - 1] = (uint8_t)i;
+            mQueue.push(p);
+            void * q;
+            if (mQueue.pop(q)) mAllocator->deallocate(q);
+        }
+    }
+};
+
+void testThreadCacheAllocator() {
+    sp<Allocator> allocator = new ThreadCacheAllocator;
+    void * ptrs[1000];
+    for (size_t i = 0; i < 1000; ++i) {
+        const size_t n = i * 8 + 1;
+        ptrs[i] = allocator->allocate(n);
+        ASSERT_TRUE(ptrs[i] != NULL);
+        memset(ptrs[i], i, n);
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(((uint8_t *)ptrs[i])[i * 8], (uint8_t)i);
+        ptrs[i] = allocator->reallocate(ptrs[i], i * 16 + 1);
+        ASSERT_EQ(((uint8_t *)ptrs[i])[i * 8], (uint8_t)i);
+    }
+    for (size_t i = 0; i < 1000; ++i) allocator->deallocate(ptrs[i]);
+
+    // cross thread frees
+    sp<ThreadCacheWorker> worker = new ThreadCacheWorker;
+    Vector<Thread> threads;
+    for (size_t i = 0; i < 4; ++i) threads.push(Thread(worker));
+    for (size_t i = 0; i < 4; ++i) threads[i].run();
+    for (size_t i = 0; i < 4; ++i) threads[i].join();
+    void * q;
+    while (worker->mQueue.pop(q)) worker->mAllocator->deallocate(q);
+}
+
+struct ArenaJob : public Job {
+    volatile size_t mSize;
+    Atomic<int>     mCount;
+    ArenaJob() : mSize(0) { }
+    virtual void onJob() {
+        sp<ArenaAllocator> arena = Looper::Current()->arena();
+        ASSERT_TRUE(arena != NULL);
+        ASSERT_EQ(arena->size(), 0);    // reset after last job
+        Vector<int> vec(4, arena);
+        for (int i = 0; i < 1000; ++i) vec.push(i);
+        mSize = arena->size();
+        ++mCount;
+    }
+};
+
+void testArenaAllocator() {
+    sp<ArenaAllocator> arena = new ArenaAllocator(1024);
+    ASSERT_EQ(arena->size(), 0);
+
+    uint8_t * p = (uint8_t *)arena->allocate(100);
+    memset(p, 0xa5, 100);
+    ASSERT_GE(arena->size(), 100);
+    // grow last block in place
+    ASSERT_TRUE(arena->reallocate(p, 200) == p);
+    p = (uint8_t *)arena->reallocate(p, 4096);  // larger than chunk
+    ASSERT_EQ(p[99], 0xa5);
+    arena->deallocate(p);
+
+    const size_t size = arena->size();
+    {
+        ArenaScope scope(arena);
+        for (size_t i = 0; i < 100; ++i) arena->allocate(64);
+        ASSERT_GT(arena->size(), size);
+    }
+    ASSERT_EQ(arena->size(), size);
+
+    arena->reset();
+    ASSERT_EQ(arena->size(), 0);
+
+    // per-job arena
+    sp<Looper> looper = new Looper("arena");
+    looper->enableArena();
+    sp<ArenaJob> job = new ArenaJob;
+    looper->post(job);
+    looper->post(job);
+    // Looper::Current() retains looper in job, wait before release looper
+    while (job->mCount.load() < 2) SleepTimeMs(1);
+    looper.clear();
+    ASSERT_GT(job->mSize, 1000 * sizeof(int));
+}
+
+void testHugePageAllocator() {
+    for (size_t k = 0; k < 2; ++k) {
+        sp<Allocator> allocator = new HugePageAllocator(k, 4096);
+        uint8_t * p = (uint8_t *)allocator->allocate(1024);      // malloc
+        memset(p, 1, 1024);
+        p = (uint8_t *)allocator->reallocate(p, 8192);          // -> mmap
+        ASSERT_EQ(p[1023], 1);
+        memset(p, 2, 8192);
+        // block stays huge page aligned when mremap moves it
+        const uintptr_t offset = (uintptr_t)p & (2 * 1024 * 1024 - 1);
+        void * next = allocator->allocate(8192);                // may block growing in place
+        p = (uint8_t *)allocator->reallocate(p, 4 * 1024 * 1024);   // mremap
+        ASSERT_EQ((uintptr_t)p & (2 * 1024 * 1024 - 1), offset);
+        allocator->deallocate(next);
+        ASSERT_EQ(p[8191], 2);
+        p[4 * 1024 * 1024 - 1] = 3;
+        p = (uint8_t *)allocator->reallocate(p, 1024);          // shrink
+        ASSERT_EQ(p[1023], 2);
+        allocator->deallocate(p);
+    }
+}
+
+static __attribute__((noinline)) void * HeapProfileAllocate(size_t n) {
+    void * p = malloc(n);
+    memset(p, 0, n);
+    return p;
+}
+
+void testHeapProfiler() {
+#ifdef HEAP_PROFILER
+    heap_profile_site_t sites[16];
+    void * ptrs[100];
+    heap_profile_start(1);  // sample all
+    for (size_t i = 0; i < 100; ++i) ptrs[i] = HeapProfileAllocate(1000);
+    heap_profile_stop();
+
+    // the first allocation only initializes the sampler
+    size_t n = heap_profile_report(sites, 16);
+    ASSERT_GT(n, 0);
+    ASSERT_GE(sites[0].live_count, 99);
+    ASSERT_GE(sites[0].live_bytes, 99 * 1000);
+
+    // realloc drops the old sample, and the new block is not sampled after stop
+    for (size_t i = 0; i < 10; ++i) ptrs[i] = realloc(ptrs[i], 2000);
+    n = heap_profile_report(sites, 16);
+    ASSERT_GT(n, 0);
+    ASSERT_LE(sites[0].live_count, 90);
+
+    for (size_t i = 0; i < 100; ++i) free(ptrs[i]);
+    n = heap_profile_report(sites, 16);
+    for (size_t i = 0; i < n; ++i) ASSERT_LT(sites[i].live_count, 99);
+    heap_profile_dump(2);
+#endif
+}
+
+struct InstrumentedWorker : public Job {
+    sp<Allocator>   mAllocator;
+    InstrumentedWorker(const sp<Allocator>& allocator) : mAllocator(allocator) { }
+    virtual void onJob() {
+        for (size_t i = 0; i < 1000; ++i) {
+            void * p = mAllocator->allocate(16);
+            p = mAllocator->reallocate(p, 32);
+            mAllocator->deallocate(p);
+        }
+    }
+};
+
+void testInstrumentedAllocator() {
+    sp<InstrumentedAllocator> allocator = new InstrumentedAllocator("test", GetAlignedAllocator(64), 64);
+    void * p = allocator->allocate(100);
+    ASSERT_EQ((uintptr_t)p & 63, 0);
+    InstrumentedAllocator::Stats stats = allocator->snapshot();
+    ASSERT_STREQ(stats.mName, "test");
+    ASSERT_EQ(stats.mLive, 100);
+    ASSERT_EQ(stats.mHistogram[7], 1);
+    allocator->deallocate(p);
+
+    sp<InstrumentedWorker> worker = new InstrumentedWorker(allocator);
+    Vector<Thread> threads;
+    for (size_t i = 0; i < 4; ++i) threads.push(Thread(worker));
+    for (size_t i = 0; i < 4; ++i) threads[i].run();
+    for (size_t i = 0; i < 4; ++i) threads[i].join();
+    stats = allocator->snapshot();
+    ASSERT_EQ(stats.mLive, 0);
+    ASSERT_EQ(stats.mPeak, 100);
+    ASSERT_EQ(stats.mAllocations, 4001);
+    ASSERT_EQ(stats.mReallocations, 4000);
+    ASSERT_EQ(stats.mDeallocations, 4001);
+    ASSERT_EQ(stats.mHistogram[5], 4000);   // 16
+    ASSERT_EQ(stats.mHistogram[6], 4000);   // 32
+}
+
+struct PoolWorker : public Job {
+    sp<Allocator>   mAllocator;
+    PoolWorker(const sp<Allocator>& allocator) : mAllocator(allocator) { }
+    virtual void onJob() {
+        void * ptrs[64];
+        for (size_t i = 0; i < 1000; ++i) {
+            for (size_t j = 0; j < 64; ++j) {
+                ptrs[j] = mAllocator->allocate(24);
+                memset(ptrs[j], j, 24);
+            }
+            for (size_t j = 0; j < 64; ++j) {
+                ASSERT_EQ(((uint8_t *)ptrs[j])[23], (uint8_t)j);
+                mAllocator->deallocate(ptrs[j]);
+            }
+        }
+    }
+};
+
+void testPoolAllocator() {
+    sp<PoolAllocator> pool = new PoolAllocator(32, false, 1024);
+    ASSERT_EQ(pool->size(), 32);
+
+    // allocate more than one slab
+    void * ptrs[256];
+    for (size_t i = 0; i < 256; ++i) {
+        ptrs[i] = pool->allocate(32);
+        ASSERT_TRUE(ptrs[i] != NULL);
+        ASSERT_EQ((uintptr_t)ptrs[i] & (2 * sizeof(void *) - 1), 0);
+        memset(ptrs[i], i, 32);
+    }
+    for (size_t i = 0; i < 256; ++i) {
+        ASSERT_EQ(((uint8_t *)ptrs[i])[31], (uint8_t)i);
+    }
+    // free in mixed order, slabs will be returned
+    for (size_t i = 0; i < 256; i += 2) pool->deallocate(ptrs[i]);
+    for (size_t i = 1; i < 256; i += 2) pool->deallocate(ptrs[i]);
+
+    // fall back to malloc
+    void * p = pool->allocate(16);
+    p = pool->reallocate(p, 1024);
+    ASSERT_TRUE(p != NULL);
+    p = pool->reallocate(p, 4096);
+    pool->deallocate(p);
+
+    // containers
+    {
+        List<int> list(pool);
+        HashTable<int, int> table(4, pool);
+        for (int i = 0; i < 1000; ++i) {
+            list.push(i);
+            table.insert(i, i);
+        }
+        ASSERT_EQ(list.size(), 1000);
+        ASSERT_EQ(table.size(), 1000);
+        for (int i = 0; i < 1000; ++i) {
+            ASSERT_EQ(list.front(), i);
+            list.pop();
+            ASSERT_EQ(table[i], i);
+            table.erase(i);
+        }
+    }
+
+    // deallocate is lock free
+    sp<PoolAllocator> shared = new PoolAllocator(24, true, 1024);
+    sp<PoolWorker> worker = new PoolWorker(shared);
+    Vector<Thread> threads;
+    for (size_t i = 0; i < 4; ++i) threads.push(Thread(worker));
+    for (size_t i = 0; i < 4; ++i) threads[i].run();
+    for (size_t i = 0; i < 4; ++i) threads[i].join();
 }
 
 void testString() {
@@ -212,6 +512,596 @@ void testString() {
         tmp.trim();
         ASSERT_TRUE(tmp == s1);
     }
+
+    // short strings are inline, cross the inline limit both ways
+    {
+        const char * LONG = "0123456789abcdefghijklmnopqrstuvwxyz";
+        String tmp("");
+        ASSERT_TRUE(tmp.empty());
+        ASSERT_STREQ(tmp.c_str(), "");
+        for (size_t i = 0; i < strlen(LONG); ++i) {
+            tmp.append(LONG + i, 1);
+            ASSERT_EQ(tmp.size(), i + 1);
+            ASSERT_EQ(strncmp(tmp.c_str(), LONG, i + 1), 0);
+            ASSERT_EQ(tmp.c_str()[i + 1], '\0');
+        }
+        String copy = tmp;
+        copy.erase(20, copy.size() - 20);
+        ASSERT_EQ(copy.size(), 20);
+        ASSERT_STREQ(tmp.c_str(), LONG);    // cow
+        copy.insert(10, LONG);
+        ASSERT_EQ(copy.size(), 20 + strlen(LONG));
+        copy.set("short");
+        ASSERT_STREQ(copy.c_str(), "short");
+        copy.swap(tmp);
+        ASSERT_STREQ(copy.c_str(), LONG);
+        ASSERT_STREQ(tmp.c_str(), "short");
+        tmp.upper();
+        ASSERT_STREQ(tmp.c_str(), "SHORT");
+        ASSERT_EQ(String("0123456789012345678901").size(), 22);
+        ASSERT_EQ(String("01234567890123456789012").size(), 23);
+        ASSERT_TRUE(String(LONG).substring(30) == "uvwxyz");
+        ASSERT_EQ(String(LONG, 10).hash(), String("0123456789").hash());
+
+        // strings are moved by memcpy in containers
+        Vector<String> vec;
+        for (size_t i = 0; i < 256; ++i) vec.push(String(LONG, i % 36 + 1));
+        for (size_t i = 0; i < 256; ++i) ASSERT_EQ(vec[i].size(), i % 36 + 1);
+        vec.erase(0);
+        ASSERT_TRUE(vec[0] == "01");
+    }
+}
+
+void testStringBuilder() {
+    StringBuilder builder;
+    ASSERT_TRUE(builder.empty());
+    builder.append("width").append('=').appendFormat("%d", 1920);
+    ASSERT_STREQ(builder.c_str(), "width=1920");
+
+    // geometric growth
+    size_t grows = 0;
+    size_t capacity = builder.capacity();
+    for (size_t i = 0; i < 100000; ++i) {
+        builder.append("0123456789", i % 10 + 1);
+        if (builder.capacity() != capacity) {
+            ASSERT_GE(builder.capacity(), capacity * 2);
+            capacity = builder.capacity();
+            ++grows;
+        }
+    }
+    ASSERT_LT(grows, 24);
+    const size_t size = builder.size();
+    String s = builder.toString();
+    ASSERT_EQ(s.size(), size);
+    ASSERT_TRUE(s.startsWith("width=19200"));
+    ASSERT_TRUE(builder.empty());
+    ASSERT_STREQ(builder.c_str(), "");
+
+    // no limit on format
+    String big(s.c_str(), 5000);
+    String formatted = String::format("[%s]", big.c_str());
+    ASSERT_EQ(formatted.size(), 5002);
+    ASSERT_TRUE(formatted.endsWith("]"));
+    ASSERT_TRUE(String::format("%s", "") == "");
+    ASSERT_TRUE(String::format("%d-%s", 1, "short") == "1-short");
+}
+
+void testStringView() {
+    StringView empty;
+    ASSERT_TRUE(empty.empty());
+    ASSERT_TRUE(empty == "");
+
+    String url = "pipe://12+4096+-8";
+    StringView view = url;
+    ASSERT_EQ(view.data(), url.c_str());
+    ASSERT_EQ(view.size(), url.size());
+    ASSERT_TRUE(view.startsWithIgnoreCase("PIPE://"));
+    ssize_t index0 = view.indexOf(7, '+');
+    ssize_t index1 = view.indexOf(index0 + 1, '+');
+    ASSERT_EQ(index0, 9);
+    ASSERT_EQ(index1, 14);
+    ASSERT_EQ(view.substring(7, index0 - 7).toInt32(), 12);
+    ASSERT_EQ(view.substring(index0 + 1, index1 - index0 - 1).toInt64(), 4096);
+    ASSERT_EQ(view.substring(index1 + 1).toInt64(), -8);
+    ASSERT_EQ(view.indexOf("+"), 9);
+    ASSERT_EQ(view.lastIndexOf("+"), 14);
+    ASSERT_EQ(view.lastIndexOf('p'), 2);
+    ASSERT_EQ(view.indexOf('#'), -1);
+    // views are not null-terminated
+    StringView sub = view.substring(7, 2);
+    ASSERT_TRUE(sub == "12");
+    ASSERT_EQ(sub.indexOf('+'), -1);
+    ASSERT_EQ(StringView("123456", 3).toInt32(), 123);
+    ASSERT_EQ(StringView(" -2147483648x").toInt32(), -2147483647 - 1);
+    ASSERT_EQ(StringView("99999999999999999999").toInt64(), INT64_MAX);
+    ASSERT_EQ(StringView("0.25", 3).toDouble(), 0.2);
+    ASSERT_EQ(StringView("1.5e3").toFloat(), 1500.f);
+
+    ASSERT_TRUE(StringView("  a b \t\n").trim() == "a b");
+    ASSERT_TRUE(StringView(" \t").trim().empty());
+    ASSERT_TRUE(StringView("/a/b/c.mp4").basename() == "c");
+    ASSERT_TRUE(StringView("/a/b/c.mp4").dirname() == "/a/b");
+    ASSERT_TRUE(String("/a/b/c.mp4").dirname() == "/a/b");
+    ASSERT_TRUE(StringView("/a").dirname() == "/");
+    ASSERT_TRUE(String("/a").dirname() == "/");
+    ASSERT_TRUE(StringView("a").dirname().empty());
+    ASSERT_TRUE(StringView("c.mp4").basename() == String("c.mp4").basename());
+
+    // compare
+    ASSERT_TRUE(StringView("abc") < "abd");
+    ASSERT_TRUE(StringView("ab") < "abc");
+    ASSERT_TRUE(StringView("abc") > StringView("abcd", 2));
+    ASSERT_TRUE(StringView("Hello").equalsIgnoreCase("hELLO"));
+    ASSERT_TRUE(StringView("video.MP4").endsWithIgnoreCase(".mp4"));
+    ASSERT_FALSE(StringView("mp4").endsWith("video.mp4"));
+
+    // hash & lookup without temporary String
+    ASSERT_EQ(StringView("width").hash(), String("width").hash());
+    HashTable<String, int> table;
+    table.insert("width", 1920);
+    table.insert("height", 1080);
+    const char * line = "height=1080";
+    StringView key(line, 6);
+    ASSERT_TRUE(table.find(key) != NULL);
+    ASSERT_EQ(*table.find(key), 1080);
+    ASSERT_TRUE(table.find(StringView(line, 5)) == NULL);
+    ASSERT_EQ(*table.find("width"), 1920);
+    Atom atom(key);
+    ASSERT_TRUE(atom == Atom("height"));
+    // view lookup of Atom keys resolves by Atom::Find(), never interns
+    HashTable<Atom, int> atoms;
+    atoms.insert(Atom("height"), 1080);
+    atoms.insert(Atom(), 0);
+    ASSERT_TRUE(atoms.find(key) != NULL);
+    ASSERT_EQ(*atoms.find(key), 1080);
+    ASSERT_TRUE(atoms.find(StringView(line, 5)) == NULL);
+    ASSERT_TRUE(atoms.find(StringView("atoms-never-interned")) == NULL);
+    ASSERT_TRUE(atoms.find(String("atoms-never-interned")) == NULL);
+    ASSERT_TRUE(Atom::Find("atoms-never-interned").empty());
+    ASSERT_EQ(*atoms.find(StringView()), 0);
+}
+
+// digits without leading & trailing zeros
+static int SignificantDigits(const char * s) {
+    int n = 0, zeros = 0;
+    for (; *s && *s != 'e'; ++s) {
+        if (!isdigit(*s) || (*s == '0' && n == 0)) continue;
+        zeros = *s == '0' ? zeros + 1 : 0;
+        ++n;
+    }
+    return n - zeros;
+}
+
+void testNumber() {
+    char buf[kNumberChars + 1];
+#define TO_CHARS(v) (buf[ToChars(buf, v)] = '\0', buf)
+    ASSERT_STREQ(TO_CHARS((int32_t)0), "0");
+    ASSERT_STREQ(TO_CHARS((int32_t)-2147483647 - 1), "-2147483648");
+    ASSERT_STREQ(TO_CHARS((uint32_t)4294967295u), "4294967295");
+    ASSERT_STREQ(TO_CHARS((int64_t)INT64_MIN), "-9223372036854775808");
+    ASSERT_STREQ(TO_CHARS((uint64_t)UINT64_MAX), "18446744073709551615");
+    // shortest round trip, javascript style
+    ASSERT_STREQ(TO_CHARS(0.1), "0.1");
+    ASSERT_STREQ(TO_CHARS(0.1f), "0.1");
+    ASSERT_STREQ(TO_CHARS(1.0 / 3), "0.3333333333333333");
+    ASSERT_STREQ(TO_CHARS(-1.5), "-1.5");
+    ASSERT_STREQ(TO_CHARS(100.0), "100");
+    ASSERT_STREQ(TO_CHARS(1e20), "100000000000000000000");
+    ASSERT_STREQ(TO_CHARS(1e21), "1e+21");
+    ASSERT_STREQ(TO_CHARS(0.000001), "0.000001");
+    ASSERT_STREQ(TO_CHARS(1.5e-7), "1.5e-7");
+    ASSERT_STREQ(TO_CHARS(5e-324), "5e-324");
+    ASSERT_STREQ(TO_CHARS(1.7976931348623157e308), "1.7976931348623157e+308");
+    ASSERT_STREQ(TO_CHARS(3.4028235e38f), "3.4028235e+38");
+    ASSERT_STREQ(TO_CHARS(-0.0), "-0");
+    ASSERT_STREQ(TO_CHARS(HUGE_VAL), "inf");
+    ASSERT_STREQ(TO_CHARS(-HUGE_VALF), "-inf");
+    ASSERT_STREQ(TO_CHARS(NAN), "nan");
+#undef TO_CHARS
+
+    int32_t i32 = 7;
+    ASSERT_EQ(FromChars("-2147483648", 11, i32), 11);
+    ASSERT_EQ(i32, INT32_MIN);
+    ASSERT_EQ(FromChars("2147483648", 10, i32), 0);     // overflow
+    ASSERT_EQ(i32, INT32_MIN);                          // not modified
+    ASSERT_EQ(FromChars("+1", 2, i32), 0);
+    ASSERT_EQ(FromChars(" 1", 2, i32), 0);
+    ASSERT_EQ(FromChars("12345678901234", 4, i32), 4);  // not null-terminated
+    ASSERT_EQ(i32, 1234);
+    uint64_t u64;
+    ASSERT_EQ(FromChars("18446744073709551615x", 21, u64), 20);
+    ASSERT_EQ(u64, UINT64_MAX);
+    ASSERT_EQ(FromChars("18446744073709551616", 20, u64), 0);
+    ASSERT_EQ(FromChars("-1", 2, u64), 0);
+    ASSERT_EQ(FromChars("0000000000000000000000012", 25, u64), 25);
+    ASSERT_EQ(u64, 12);
+    int64_t i64;
+    ASSERT_EQ(FromChars("-9223372036854775808", 20, i64), 20);
+    ASSERT_EQ(i64, INT64_MIN);
+    ASSERT_EQ(FromChars("9223372036854775808", 19, i64), 0);
+
+    double d;
+    ASSERT_EQ(FromChars("1.5e3x", 6, d), 5);
+    ASSERT_EQ(d, 1500);
+    ASSERT_EQ(FromChars(".5", 2, d), 2);
+    ASSERT_EQ(d, 0.5);
+    ASSERT_EQ(FromChars("1e", 2, d), 1);                // exponent needs digits
+    ASSERT_EQ(FromChars("-", 1, d), 0);
+    ASSERT_EQ(FromChars(".", 1, d), 0);
+    ASSERT_EQ(FromChars("9007199254740993", 16, d), 16);    // ties to even
+    ASSERT_EQ(d, 9007199254740992.0);
+    ASSERT_EQ(FromChars("2.2250738585072011e-308", 23, d), 23);
+    ASSERT_EQ(d, 2.2250738585072011e-308);
+    ASSERT_EQ(FromChars("1e400", 5, d), 5);
+    ASSERT_EQ(d, HUGE_VAL);
+    ASSERT_EQ(FromChars("-Infinity", 9, d), 9);
+    ASSERT_EQ(d, -HUGE_VAL);
+    ASSERT_EQ(FromChars("nan", 3, d), 3);
+    ASSERT_TRUE(d != d);
+    const char * digits = "3.14159265358979323846264338327950288";
+    ASSERT_EQ(FromChars(digits, strlen(digits), d), strlen(digits));
+    ASSERT_EQ(d, strtod(digits, NULL));
+    float f;
+    ASSERT_EQ(FromChars("7.038531e-26", 12, f), 12);
+    ASSERT_EQ(f, 7.038531e-26f);
+
+    // round trip of random bits, both ways against libc
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < 20000; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        double v;
+        memcpy(&v, &x, sizeof(v));
+        if (v != v) continue;
+        const size_t n = ToChars(buf, v);
+        buf[n] = '\0';
+        ASSERT_EQ(strtod(buf, NULL), v);
+        double w;
+        ASSERT_EQ(FromChars(buf, n, w), n);
+        ASSERT_EQ(w, v);
+        // no shorter %e round trips
+        char shorter[kNumberChars];
+        for (int p = 0; p < 16; ++p) {
+            snprintf(shorter, sizeof(shorter), "%.*e", p, v);
+            if (strtod(shorter, NULL) == v) {
+                ASSERT_LE(SignificantDigits(buf), p + 1);
+                break;
+            }
+        }
+
+        float g;
+        const uint32_t y = (uint32_t)x;
+        memcpy(&g, &y, sizeof(g));
+        if (g != g) continue;
+        const size_t m = ToChars(buf, g);
+        buf[m] = '\0';
+        ASSERT_EQ(strtof(buf, NULL), g);
+        float h;
+        ASSERT_EQ(FromChars(buf, m, h), m);
+        ASSERT_EQ(h, g);
+    }
+
+    // String & StringBuilder
+    ASSERT_TRUE(String(0.1) == "0.1");
+    ASSERT_TRUE(String(1.5f) == "1.5");
+    ASSERT_TRUE(String((int64_t)-42) == "-42");
+    ASSERT_TRUE(String((uint8_t)255) == "255");
+    ASSERT_EQ(String(0.1).toDouble(), 0.1);
+    ASSERT_EQ(String(" +1.5e3").toDouble(), 1500);
+    ASSERT_EQ(String("+-1").toDouble(), 0);
+    ASSERT_EQ(String("0x10").toDouble(), 16);
+    ASSERT_EQ(String("0.1").toFloat(), 0.1f);
+    ASSERT_EQ(String(" -42abc").toInt32(), -42);
+    ASSERT_EQ(String("-99999999999999999999").toInt64(), INT64_MIN);
+    StringBuilder builder;
+    builder.append((int32_t)-1).append(' ').append((uint64_t)UINT64_MAX)
+        .append(' ').append(0.25).append(' ').append(1e-7f);
+    ASSERT_STREQ(builder.c_str(), "-1 18446744073709551615 0.25 1e-7");
+}
+
+void testCord() {
+    Cord cord;
+    ASSERT_TRUE(cord.empty());
+    ASSERT_TRUE(cord.string() == "");
+
+    // small appends are packed into chunks
+    StringBuilder builder;
+    for (size_t i = 0; i < 10000; ++i) {
+        cord.append("item ").append(String(i)).append("\n");
+        builder.append("item ").append((uint64_t)i).append('\n');
+    }
+    ASSERT_EQ(cord.size(), builder.size());
+    ASSERT_LE(cord.chunks(), builder.size() / Cord::kChunkLength + 1);
+    ASSERT_TRUE(cord.string() == builder.toString());
+
+    // prepend fills the head chunk backward
+    Cord header("body");
+    header.prepend(": ").prepend("header");
+    ASSERT_TRUE(header.string() == "header: body");
+    ASSERT_EQ(header.chunks(), 2);
+
+    // large strings are shared, and not changed by later edits of them
+    String big(cord.string().c_str(), 1000);
+    Cord shared;
+    shared.append(big).append(big).prepend(big);
+    ASSERT_EQ(shared.chunks(), 3);
+    ASSERT_EQ(shared.size(), 3000);
+    big.upper();
+    ASSERT_TRUE(shared.substring(0, 5).string() == "item ");
+
+    // copies and substrings share chunks
+    Cord copy = cord;
+    cord.append("tail");
+    ASSERT_EQ(copy.size() + 4, cord.size());
+    ASSERT_TRUE(cord.string().endsWith("tail"));
+    ASSERT_FALSE(copy.string().endsWith("tail"));
+    const String flat = cord.string();
+    for (size_t pos = 0; pos < flat.size(); pos += 997) {
+        Cord sub = cord.substring(pos, 5000);
+        const size_t n = flat.size() - pos < 5000 ? flat.size() - pos : 5000;
+        ASSERT_EQ(sub.size(), n);
+        ASSERT_TRUE(sub.string() == flat.substring(pos, n));
+    }
+    ASSERT_TRUE(cord.substring(flat.size()).empty());
+    ASSERT_TRUE(cord.substring(flat.size() - 4).string() == "tail");
+
+    // cords of cords
+    Cord twice = header;
+    twice.append(twice).prepend(Cord("> "));
+    ASSERT_TRUE(twice.string() == "> header: bodyheader: body");
+
+    // write chunks to content without flatten
+    char path[] = "/tmp/cordXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    sp<Content> out = Content::Create(String(path), Content::Write);
+    ASSERT_EQ(out->write(header), header.size());  // cached
+    ASSERT_EQ(out->write(cord), cord.size());      // vectored
+    out.clear();
+    sp<Content> in = Content::Create(String(path));
+    ASSERT_EQ(in->length(), header.size() + cord.size());
+    sp<Buffer> data = in->read(in->length());
+    ASSERT_TRUE(String(data->data(), data->size()) == header.string() + flat);
+    unlink(path);
+}
+
+// reference of string kernels
+static ssize_t RefFind(const char * s, size_t n, const char * p, size_t m) {
+    for (size_t i = 0; i + m <= n; ++i) if (!memcmp(s + i, p, m)) return i;
+    return -1;
+}
+
+static ssize_t RefRFind(const char * s, size_t n, const char * p, size_t m) {
+    for (size_t i = n + 1; i-- > m; ) if (!memcmp(s + i - m, p, m)) return i - m;
+    return -1;
+}
+
+static int Sign(int x) { return x > 0 ? 1 : (x < 0 ? -1 : 0); }
+
+void testStringSIMD() {
+    // letters & bytes around 'A'-'Z' and 'a'-'z'
+    static const char kAlphabet[] = "aAbBzZ@[`{\xc0\xff";
+    const str_simd_level_t saved = str_simd_level();
+    const str_simd_level_t levels[] = { STR_SIMD_NONE, STR_SIMD_SSE2, STR_SIMD_AVX2, STR_SIMD_NEON };
+    srand(1);
+    for (size_t k = 0; k < sizeof(levels) / sizeof(levels[0]); ++k) {
+        if (str_simd_set_level(levels[k]) != levels[k]) continue;
+        INFO("test string kernels level %d", levels[k]);
+
+        for (size_t round = 0; round < 2000; ++round) {
+            char s[160], t[160], p[8];
+            const size_t n = rand() % 150;
+            const size_t m = rand() % 6;
+            for (size_t i = 0; i < n; ++i) s[i] = kAlphabet[rand() % (sizeof(kAlphabet) - 1)];
+            for (size_t i = 0; i < m; ++i) p[i] = kAlphabet[rand() % 3];
+            s[n] = '\0';
+            p[m] = '\0';
+
+            ASSERT_EQ(str_find(s, n, p, m), RefFind(s, n, p, m));
+            ASSERT_EQ(str_rfind(s, n, p, m), RefRFind(s, n, p, m));
+            ASSERT_EQ(str_find_char(s, n, p[0]), RefFind(s, n, p, 1));
+            ASSERT_EQ(str_rfind_char(s, n, p[0]), RefRFind(s, n, p, 1));
+
+            // same string in random case, differs at a random position
+            for (size_t i = 0; i <= n; ++i) t[i] = (rand() & 1) ? tolower((uint8_t)s[i]) : toupper((uint8_t)s[i]);
+            if (n && (rand() & 1)) t[rand() % n] = kAlphabet[rand() % (sizeof(kAlphabet) - 1)];
+            ASSERT_EQ(Sign(str_casecmp(s, t, n)), Sign(strncasecmp(s, t, n)));
+
+            String a(s), b(t);
+            ASSERT_EQ(Sign(a.compareIgnoreCase(b)), Sign(strcasecmp(s, t)));
+            ASSERT_EQ(Sign(a.compareIgnoreCase(t)), Sign(strcasecmp(s, t)));
+            ASSERT_EQ(a.indexOf(p), RefFind(s, n, p, m));
+            ASSERT_EQ(a.lastIndexOf(p), RefRFind(s, n, p, m));
+            a.lower();
+            b.upper();
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(a[i], (char)tolower((uint8_t)s[i]));
+                ASSERT_EQ(b[i], (char)toupper((uint8_t)t[i]));
+            }
+        }
+    }
+    str_simd_set_level(saved);
+
+    String s("abcabc");
+    ASSERT_EQ(s.lastIndexOf("abc"), 3);
+    ASSERT_EQ(s.lastIndexOf("abca"), 0);
+    ASSERT_EQ(s.indexOf(3, "abc"), 3);
+    ASSERT_EQ(s.indexOf(4, 'a'), -1);
+    ASSERT_EQ(s.indexOf('\0'), 6);
+    ASSERT_TRUE(String("Content-Type").startsWithIgnoreCase("content-"));
+    ASSERT_TRUE(String("Content-Type").endsWithIgnoreCase("-TYPE"));
+    ASSERT_FALSE(String("Content-Type").endsWithIgnoreCase("-TYP"));
+}
+
+// random code point, surrogates included
+static uint32_t RandomCodePoint(int ascii) {
+    if (rand() % 100 < ascii) return rand() % 0x80;
+    switch (rand() % 3) {
+        case 0:     return 0x80 + rand() % (0x800 - 0x80);
+        case 1:     return 0x800 + rand() % (0x10000 - 0x800);
+        default:    return 0x10000 + rand() % (0x110000 - 0x10000);
+    }
+}
+
+// utf8 encode without any check
+static size_t EncodeUTF8(uint32_t c, char * p) {
+    if (c < 0x80) { p[0] = c; return 1; }
+    if (c < 0x800) { p[0] = 0xC0 | (c >> 6); p[1] = 0x80 | (c & 0x3F); return 2; }
+    if (c < 0x10000) {
+        p[0] = 0xE0 | (c >> 12); p[1] = 0x80 | ((c >> 6) & 0x3F); p[2] = 0x80 | (c & 0x3F);
+        return 3;
+    }
+    p[0] = 0xF0 | (c >> 18); p[1] = 0x80 | ((c >> 12) & 0x3F);
+    p[2] = 0x80 | ((c >> 6) & 0x3F); p[3] = 0x80 | (c & 0x3F);
+    return 4;
+}
+
+static uint32_t UnitOf(const char * p, bool be) {
+    const uint8_t * u = (const uint8_t *)p;
+    return be ? (u[0] << 8) | u[1] : u[0] | (u[1] << 8);
+}
+
+// compare with ConvertUTF on random & broken input
+void testStringUTF() {
+    const str_simd_level_t saved = str_simd_level();
+    const str_simd_level_t levels[] = { STR_SIMD_NONE, STR_SIMD_SSE2, STR_SIMD_AVX2, STR_SIMD_NEON };
+    srand(1);
+    for (size_t k = 0; k < sizeof(levels) / sizeof(levels[0]); ++k) {
+        if (str_simd_set_level(levels[k]) != levels[k]) continue;
+        INFO("test utf kernels level %d", levels[k]);
+
+        for (size_t round = 0; round < 4000; ++round) {
+            const int ascii = (round % 4) * 33;     // percent of ascii
+            const size_t count = rand() % 200;
+
+            // utf8 -> utf16
+            char s[1024];
+            size_t n = 0;
+            for (size_t i = 0; i < count; ++i) n += EncodeUTF8(RandomCodePoint(ascii), s + n);
+            if (n && rand() % 4 == 0) s[rand() % n] = rand();
+            if (n && rand() % 4 == 0) n -= rand() % 3 % n;
+
+            const UTF8 * source = (const UTF8 *)s;
+            const bool legal = isLegalUTF8String(&source, source + n);
+            ASSERT_EQ(str_utf8_valid(s, n) != 0, legal);
+
+            UTF16 ref[1024];
+            UTF16 * target = ref;
+            source = (const UTF8 *)s;
+            ConversionResult result = ConvertUTF8toUTF16(&source, source + n, &target, ref + 1024, strictConversion);
+            char le[2048], be[2048];
+            const ssize_t units = str_utf8_to_utf16(s, n, le, 0);
+            ASSERT_EQ(str_utf8_to_utf16(s, n, be, 1), units);
+            if (result == conversionOK) {
+                ASSERT_TRUE(legal);
+                ASSERT_EQ(units, target - ref);
+                for (ssize_t i = 0; i < units; ++i) {
+                    ASSERT_EQ(UnitOf(le + 2 * i, false), ref[i]);
+                    ASSERT_EQ(UnitOf(be + 2 * i, true), ref[i]);
+                }
+            } else {
+                ASSERT_EQ(units, -1);
+            }
+
+            // utf16 -> utf8, with unpaired surrogates
+            UTF16 u[512];
+            size_t m = 0;
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t c = RandomCodePoint(ascii);
+                if (rand() % 16 == 0) c = 0xD800 + rand() % 0x800;
+                if (c < 0x10000) {
+                    u[m++] = c;
+                } else {
+                    u[m++] = 0xD800 + ((c - 0x10000) >> 10);
+                    u[m++] = 0xDC00 + ((c - 0x10000) & 0x3FF);
+                }
+            }
+            for (size_t i = 0; i < m; ++i) {
+                le[2 * i] = u[i];       le[2 * i + 1] = u[i] >> 8;
+                be[2 * i] = u[i] >> 8;  be[2 * i + 1] = u[i];
+            }
+
+            UTF8 ref8[2048];
+            const UTF16 * source16 = u;
+            UTF8 * target8 = ref8;
+            result = ConvertUTF16toUTF8(&source16, u + m, &target8, ref8 + 2048, lenientConversion);
+            char out[2048];
+            const ssize_t bytes = str_utf16_to_utf8(le, m, out, 0);
+            if (result == conversionOK) {
+                ASSERT_EQ(bytes, target8 - ref8);
+                ASSERT_EQ(memcmp(out, ref8, bytes), 0);
+                ASSERT_EQ(str_utf16_to_utf8(be, m, out, 1), bytes);
+                ASSERT_EQ(memcmp(out, ref8, bytes), 0);
+            } else {
+                ASSERT_EQ(bytes, -1);
+                ASSERT_EQ(str_utf16_to_utf8(be, m, out, 1), -1);
+            }
+        }
+    }
+    str_simd_set_level(saved);
+
+    String s("subtitle: \xe5\xad\x97\xe5\xb9\x95 \xf0\x9f\x8e\xac caf\xc3\xa9");
+    ASSERT_TRUE(s.isUTF8());
+    ASSERT_FALSE(String("\xc0\xaf").isUTF8());        // overlong
+    ASSERT_FALSE(String("\xed\xa0\x80").isUTF8());    // surrogate
+    sp<Buffer> le = s.toUTF16LE();
+    sp<Buffer> be = s.toUTF16BE();
+    ASSERT_EQ(le->size(), 2 * 20);
+    ASSERT_EQ(be->size(), le->size());
+    ASSERT_EQ(UnitOf(le->data() + 2 * 10, false), 0x5b57);
+    ASSERT_EQ(UnitOf(be->data() + 2 * 13, true), 0xd83c);
+    ASSERT_TRUE(String::UTF16LE(le->data(), le->size()) == s);
+    ASSERT_TRUE(String::UTF16BE(be->data(), be->size()) == s);
+    ASSERT_TRUE(String::UTF16(le->data(), le->size()) == s);
+    ASSERT_TRUE(String("\xff").toUTF16LE().isNIL());
+    ASSERT_TRUE(String::UTF16LE(le->data(), 2 * 14) == String::Null);  // cut in a surrogate pair
+    ASSERT_TRUE(String("").toUTF16BE()->size() == 0);
+}
+
+struct AtomWorker : public Job {
+    Atomic<int>     mIndex;
+    size_t          mIds[4][1000];
+    virtual void onJob() {
+        const int index = mIndex++;
+        for (size_t i = 0; i < 1000; ++i) {
+            mIds[index][i] = Atom(String::format("atom-%zu", i)).id();
+        }
+    }
+};
+
+void testAtom() {
+    const Atom a0;
+    const Atom a1("width");
+    const Atom a2(String("width"));
+    const Atom a3("width-height", 5);
+    const Atom a4("height");
+    ASSERT_TRUE(a0 == Atom(""));
+    ASSERT_TRUE(a0.empty());
+    ASSERT_STREQ(a0.c_str(), "");
+    ASSERT_TRUE(a1 == a2);
+    ASSERT_TRUE(a1 == a3);
+    ASSERT_TRUE(a1 != a4);
+    ASSERT_EQ(a1.hash(), a2.hash());
+    ASSERT_EQ(a1.size(), 5);
+    ASSERT_STREQ(a1.c_str(), "width");
+    ASSERT_TRUE(a1.string() == "width");
+    ASSERT_TRUE(Atom::Find("width") == a1);
+    ASSERT_TRUE(Atom::Find(StringView("width-height", 5)) == a1);
+    ASSERT_TRUE(Atom::Find(String("atom-never-interned")).empty());
+
+    // intern same strings from threads
+    sp<AtomWorker> worker = new AtomWorker;
+    Vector<Thread> threads;
+    for (size_t i = 0; i < 4; ++i) threads.push(Thread(worker));
+    for (size_t i = 0; i < 4; ++i) threads[i].run();
+    for (size_t i = 0; i < 4; ++i) threads[i].join();
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_GT(worker->mIds[0][i], 0);
+        for (size_t j = 1; j < 4; ++j) ASSERT_EQ(worker->mIds[j][i], worker->mIds[0][i]);
+        if (i) {
+            ASSERT_NE(worker->mIds[0][i], worker->mIds[0][i - 1]);
+        }
+    }
 }
 
 void testBuffer() {
@@ -241,10 +1131,213 @@ void testBuffer() {
     ASSERT_EQ(buffer->capacity(), 128);
     ASSERT_EQ(buffer->empty(), 120);
     ASSERT_EQ(buffer->ready(), 0);
+
+    // slices share storage, copy on write
+    sp<Buffer> packet = new Buffer(1024);
+    packet->write("\x00\x00\x01\x67" "sps" "\x00\x00\x01\x68" "pps", 14);
+    sp<Buffer> sps = packet->split(4, 3);
+    sp<Buffer> pps = packet->split(11, 3);
+    ASSERT_EQ(sps->data(), packet->data() + 4);     // no copy
+    ASSERT_TRUE(*sps == "sps");
+    ASSERT_EQ(sps->empty(), 0);
+    sp<Buffer> head = packet->read(4);
+    ASSERT_EQ(head->data() + 4, sps->data());
+    ASSERT_EQ(packet->ready(), 10);
+    packet->write("idr");                           // after slices, no copy
+    ASSERT_EQ(packet->data() + 7, pps->data());
+    ASSERT_TRUE(*packet == "sps\x00\x00\x01\x68ppsidr");
+    packet->replace(0, "SPS");                      // copy on write
+    ASSERT_NE(packet->data(), sps->data());
+    ASSERT_TRUE(*packet == "SPS\x00\x00\x01\x68ppsidr");
+    ASSERT_TRUE(*sps == "sps");
+    ASSERT_TRUE(*pps == "pps");
+    pps->edit()[0] = 'P';                           // slice copies too
+    ASSERT_TRUE(*pps == "Pps");
+    ASSERT_TRUE(packet->compare(7, "pps") == 0);
+    sp<Buffer> sei = packet->split(7, 3);
+    const char * bytes = packet->data();
+    ASSERT_EQ(sei->data(), bytes + 7);              // data() never copies
+    ASSERT_EQ(packet->data(), bytes);
+    ASSERT_EQ(&(*packet)[7], sei->data());
+    sei->edit()[0] = 'S';                           // edit() copies
+    ASSERT_TRUE(*sei == "Sps");
+    ASSERT_TRUE(packet->compare(7, "pps") == 0);
+    packet->edit()[7] = 'Q';                        // parent copies too
+    ASSERT_TRUE(*sei == "Sps");
+    ASSERT_TRUE(packet->compare(7, "Qps") == 0);
+    packet->replace(7, "pps");
+    sps->resize(8);                                 // grow slice
+    sps->write("+vui");
+    ASSERT_TRUE(*sps == "sps+vui");
+    ASSERT_TRUE(*head == "\x00\x00\x01\x67");
+    sp<Buffer> tail = packet->split(10, 3);
+    packet->reset();                                // drop bytes, no copy
+    packet->write("reused");
+    ASSERT_TRUE(*tail == "idr");
+    ASSERT_TRUE(*packet == "reused");
+    sp<Buffer> last = packet->read(6);
+    packet.clear();                                 // slices keep storage
+    ASSERT_TRUE(*last == "reused");
+
+    // ring wraps around, default allocator is mirrored, others are not
+    sp<Allocator> allocators[] = { kAllocatorDefault, GetAlignedAllocator(64) };
+    for (size_t k = 0; k < 2; ++k) {
+        sp<Buffer> ring = new Buffer(4096, Buffer::Ring, allocators[k]);
+        ASSERT_EQ(ring->capacity(), 4096);
+        char model[8192];
+        size_t head = 0, tail = 0;  // model of ready bytes
+        uint8_t next = 0;
+        for (size_t i = 0; i < 1000; ++i) {
+            char chunk[1500];
+            size_t n = 1 + (i * 7919) % sizeof(chunk);
+            if (n > ring->empty()) n = ring->empty();
+            for (size_t j = 0; j < n; ++j) chunk[j] = model[tail++] = next++;
+            if (n) ring->write(chunk, n);
+            ASSERT_EQ(ring->ready(), tail - head);
+            // ready bytes are contiguous across the boundary
+            ASSERT_EQ(memcmp(ring->data(), model + head, tail - head), 0);
+
+            size_t m = (i * 104729) % 1400;
+            if (m > ring->ready()) m = ring->ready();
+            if (m) {
+                ASSERT_EQ(ring->read(chunk, m), m);
+                ASSERT_EQ(memcmp(chunk, model + head, m), 0);
+                head += m;
+            }
+            memmove(model, model + head, tail - head);
+            tail -= head;
+            head = 0;
+        }
+
+        // keep ready bytes on resize
+        size_t n = ring->ready();
+        ring->resize(8192);
+        ASSERT_EQ(ring->capacity(), 8192);
+        ASSERT_EQ(ring->ready(), n);
+        ASSERT_EQ(memcmp(ring->data(), model, n), 0);
+        ring->write('x', ring->empty());
+        ASSERT_EQ(ring->ready(), 8192);
+    }
+}
+
+void testBufferChain() {
+    sp<Buffer> header = new Buffer("HDR:");
+    sp<Buffer> payload = new Buffer("0123456789");
+    BufferChain chain;
+    ASSERT_TRUE(chain.empty());
+    chain.append(payload, 2, 6);    // "234567"
+    chain.prepend(header);
+    chain.append(payload, 8);       // "89"
+    ASSERT_EQ(chain.size(), 12);
+    ASSERT_EQ(chain.slices(), 3);
+    ASSERT_TRUE(chain.flatten()->compare("HDR:23456789") == 0);
+    payload->replace(2, "xx");      // copy on write, chain keeps old bytes
+    ASSERT_TRUE(chain.flatten()->compare("HDR:23456789") == 0);
+
+    // cursor crosses slices
+    char tmp[16];
+    ASSERT_EQ(chain.peek(tmp, 4, 3), 4);
+    ASSERT_EQ(memcmp(tmp, ":234", 4), 0);
+    ASSERT_EQ(chain.read(tmp, 5), 5);
+    ASSERT_EQ(memcmp(tmp, "HDR:2", 5), 0);
+    ASSERT_EQ(chain.slices(), 2);
+
+    // move bytes out without copy
+    BufferChain part;
+    ASSERT_EQ(chain.read(part, 6), 6);
+    ASSERT_EQ(part.slices(), 2);
+    ASSERT_TRUE(part.flatten()->compare("345678") == 0);
+    ASSERT_EQ(chain.size(), 1);
+    chain.prepend(part);
+    chain.skip(2);
+    ASSERT_TRUE(chain.flatten()->compare("5678" "9") == 0);
+
+    struct iovec iov[4];
+    ASSERT_EQ(chain.toIovec(iov, 4, 3), 2);
+    ASSERT_EQ(iov[0].iov_len, 1);
+    ASSERT_EQ(*(char *)iov[0].iov_base, '8');
+    ASSERT_EQ(iov[1].iov_len, 1);
+
+    // write & read content with vectored io
+    BufferChain packets;
+    String expected;
+    for (size_t i = 0; i < 100; ++i) {
+        sp<Buffer> body = new Buffer(1000);
+        body->write('a' + i % 26, 1000);
+        char head[8];
+        snprintf(head, sizeof(head), "%04zu", i);
+        packets.append(body);
+        packets.prepend(new Buffer(head));
+        expected = String(head) + expected + String(body->data(), body->size());
+    }
+    char path[] = "/tmp/chainXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    sp<Content> out = Content::Create(String(path), Content::Write);
+    ASSERT_EQ(out->write(packets), packets.size());
+    out.clear();
+
+    sp<Content> in = Content::Create(String(path));
+    ASSERT_EQ(in->length(), expected.size());
+    BufferChain input;
+    ASSERT_EQ(in->read(input, 10), 10);                 // cached
+    ASSERT_EQ(in->read(input, 200000), expected.size() - 10);   // direct
+    ASSERT_EQ(in->read(input, 10), 0);
+    ASSERT_EQ(input.size(), expected.size());
+    ASSERT_EQ(memcmp(input.flatten()->data(), expected.c_str(), expected.size()), 0);
+
+    // scatter read into unshared buffers, then chain them
+    in->seek(0);
+    sp<Buffer> a = new Buffer(7);
+    sp<Buffer> b = new Buffer(65536);
+    a->step(7);
+    b->step(65536);
+    iov[0].iov_base = a->edit();
+    iov[0].iov_len  = a->size();
+    iov[1].iov_base = b->edit();
+    iov[1].iov_len  = b->size();
+    ASSERT_EQ(in->read(iov, 2), 7 + 65536);
+    BufferChain slices;
+    slices.append(a);
+    slices.append(b);
+    ASSERT_EQ(memcmp(slices.flatten()->data(), expected.c_str(), 7 + 65536), 0);
+    ASSERT_EQ(in->tell(), 7 + 65536);
+    unlink(path);
 }
 
 void testBitReader() {
-    
+    const char data[] = "\x12\x34\x56\x78\x9a\xbc\xde\xf0";
+    BitReader plain(data, 8);
+    ASSERT_EQ(plain.length(), 64);
+    ASSERT_EQ(plain.read(4), 0x1);
+    ASSERT_EQ(plain.read(8), 0x23);
+    ASSERT_EQ(plain.rb16(), 0x4567);
+    plain.skip();
+    ASSERT_EQ(plain.rb32(), 0x9abcdef0);
+    ASSERT_EQ(plain.remains(), 0);
+
+    // same bits across slices
+    BufferChain chain;
+    for (size_t i = 0; i < 8; i += 3) {
+        chain.append(new Buffer(data + i, i + 3 > 8 ? 8 - i : 3));
+    }
+    ASSERT_EQ(chain.slices(), 3);
+    BitReader reader(chain);
+    ASSERT_EQ(reader.length(), 64);
+    ASSERT_EQ(reader.read(4), 0x1);
+    ASSERT_EQ(reader.read(8), 0x23);
+    ASSERT_EQ(reader.rb16(), 0x4567);
+    reader.skip();
+    ASSERT_EQ(reader.rb32(), 0x9abcdef0);
+    ASSERT_EQ(reader.remains(), 0);
+
+    reader.seekBytes(1);
+    ASSERT_TRUE(reader.readS(4) == String(data + 1, 4));
+    reader.reset();
+    reader.skipBytes(4);
+    ASSERT_EQ(reader.offset(), 32);
+    ASSERT_TRUE(reader.readB(4)->compare(data + 4, 4) == 0);
 }
 
 void testBitWritter() {
@@ -284,6 +1377,26 @@ void testMessage() {
     message.set<Integer>("Integer", Int);
     ASSERT_TRUE(message.contains("Integer"));
     ASSERT_EQ(message.find<Integer>("Integer"), Int);
+
+    // keys are atoms
+    const Atom kWidth("width");
+    message.setInt32(kWidth, 1920);
+    ASSERT_EQ(message.findInt32("width"), 1920);
+    ASSERT_EQ(message.findInt32(String("width")), 1920);
+    ASSERT_TRUE(message.string().indexOf("int32_t width = 1920\n") > 0);
+    ASSERT_TRUE(message.string().indexOf("string String = \"abcdefg\"\n") > 0);
+    ASSERT_TRUE(message.remove(kWidth));
+
+    // lookups of missing keys never intern
+    const size_t id = Atom("message-probe-0").id();
+    ASSERT_FALSE(message.contains("message-missing"));
+    ASSERT_EQ(message.findInt32(StringView("message-missing"), -1), -1);
+    ASSERT_FALSE(message.remove(String("message-missing")));
+    ASSERT_TRUE(Atom::Find("message-missing").empty());
+    ASSERT_EQ(Atom("message-probe-1").id(), id + 1);
+    message.setInt32("", 1);
+    ASSERT_EQ(message.findInt32("", 0), 1);
+    ASSERT_FALSE(message.contains("message-missing"));
 }
 
 struct ThreadJob : public Job {
@@ -489,6 +1602,22 @@ template <class TYPE> void testQueue() {
     ASSERT_EQ(value, 2);
     ASSERT_EQ(queue.size(), 0);
 
+    // bulk push & pop
+    TYPE values[8];
+    for (int i = 0; i < 8; ++i) values[i] = i;
+    queue.push(8);
+    queue.pushBulk(values, 8);
+    ASSERT_EQ(queue.size(), 9);
+    queue.pop(value);
+    ASSERT_EQ(value, 8);
+    ASSERT_EQ(queue.popBulk(values, 5), 5);
+    for (int i = 0; i < 5; ++i) ASSERT_EQ(values[i], i);
+    ASSERT_EQ(queue.size(), 3);
+    ASSERT_EQ(queue.popBulk(values, 8), 3);
+    for (int i = 0; i < 3; ++i) ASSERT_EQ(values[i], 5 + i);
+    ASSERT_EQ(queue.popBulk(values, 8), 0);
+    ASSERT_TRUE(queue.empty());
+
     // single producer & single consumer test
     sp<QueueConsumer<TYPE> > consumer = new QueueConsumer<TYPE>();
     Thread thread(consumer);
@@ -506,6 +1635,199 @@ template <class TYPE> void testQueue() {
 void testQueue1() { testQueue<int>();       }
 void testQueue2() { testQueue<Integer>();   }
 
+// multi producer & multi consumer, bulk push & pop of random sizes
+struct QueueBulkWorker : public Job {
+    enum { kProducers = 4, kConsumers = 4, kCount = 20000 };
+    LockFree::Queue<int>    mQueue;
+    volatile int            mThreads;
+    volatile int            mConsumed;
+    volatile uint8_t        mSeen[kProducers * kCount];
+    QueueBulkWorker() : Job(), mThreads(0), mConsumed(0) {
+        memset((void *)mSeen, 0, sizeof(mSeen));
+    }
+
+    virtual void onJob() {
+        const int id = __atomic_fetch_add(&mThreads, 1, __ATOMIC_SEQ_CST);
+        int values[16];
+        if (id < kProducers) {
+            for (int i = 0; i < kCount; ) {
+                int n = 1 + (i * 7 + id) % 16;
+                if (n > kCount - i) n = kCount - i;
+                for (int j = 0; j < n; ++j) values[j] = id * kCount + i + j;
+                mQueue.pushBulk(values, n);
+                i += n;
+            }
+            return;
+        }
+
+        int last[kProducers];   // FIFO per producer
+        for (int i = 0; i < kProducers; ++i) last[i] = -1;
+        for (size_t k = id; __atomic_load_n(&mConsumed, __ATOMIC_SEQ_CST) < kProducers * kCount; ++k) {
+            const size_t n = mQueue.popBulk(values, 1 + k % 16);
+            for (size_t j = 0; j < n; ++j) {
+                const int producer = values[j] / kCount;
+                ASSERT_GT(values[j], last[producer]);
+                last[producer] = values[j];
+                __atomic_fetch_add(&mSeen[values[j]], 1, __ATOMIC_SEQ_CST);
+            }
+            __atomic_fetch_add(&mConsumed, (int)n, __ATOMIC_SEQ_CST);
+        }
+    }
+};
+
+void testQueue3() {
+    sp<QueueBulkWorker> worker = new QueueBulkWorker;
+    Vector<Thread> threads;
+    const size_t count = QueueBulkWorker::kProducers + QueueBulkWorker::kConsumers;
+    for (size_t i = 0; i < count; ++i) threads.push(Thread(worker));
+    for (size_t i = 0; i < count; ++i) threads[i].run();
+    for (size_t i = 0; i < count; ++i) threads[i].join();
+
+    ASSERT_TRUE(worker->mQueue.empty());
+    for (size_t i = 0; i < QueueBulkWorker::kProducers * QueueBulkWorker::kCount; ++i) {
+        ASSERT_EQ(worker->mSeen[i], 1);
+    }
+}
+
+struct ConcurrentQueueProducer : public Job {
+    LockFree::ConcurrentQueue<int>  mQueue;
+    volatile int                    mProducer;
+    const int                       kCount;
+    ConcurrentQueueProducer() : Job(), mProducer(0), kCount(10000) { }
+
+    virtual void onJob() {
+        const int id = __atomic_fetch_add(&mProducer, 1, __ATOMIC_SEQ_CST);
+        for (int i = 0; i < kCount; ++i) {
+            mQueue.push(id * kCount + i);
+        }
+    }
+};
+
+void testConcurrentQueue() {
+    LockFree::ConcurrentQueue<int> queue;
+    ASSERT_TRUE(queue.empty());
+    queue.push(1);
+    queue.push(2);
+    ASSERT_EQ(queue.size(), 2);
+    int value;
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 2);
+    ASSERT_FALSE(queue.pop(value));
+    queue.push(3);
+    queue.clear();
+    ASSERT_TRUE(queue.empty());
+
+    // multi producer: FIFO per producer
+    const size_t kProducers = 4;
+    sp<ConcurrentQueueProducer> producer = new ConcurrentQueueProducer;
+    Vector<Thread> threads;
+    for (size_t i = 0; i < kProducers; ++i) threads.push(Thread(producer));
+    for (size_t i = 0; i < kProducers; ++i) threads[i].run();
+
+    int next[kProducers] = { 0 };
+    for (int n = 0; n < (int)kProducers * producer->kCount; ) {
+        if (producer->mQueue.pop(value)) {
+            const int id = value / producer->kCount;
+            ASSERT_EQ(value % producer->kCount, next[id]++);
+            ++n;
+        }
+    }
+    for (size_t i = 0; i < kProducers; ++i) threads[i].join();
+    ASSERT_TRUE(producer->mQueue.empty());
+}
+
+template <class TYPE> struct BlockingQueueConsumer : public Job {
+    BlockingQueue<TYPE> mQueue;
+    const int kCount;
+    BlockingQueueConsumer() : Job(), kCount(10000) { }
+
+    virtual void onJob() {
+        for (int next = 0; next < kCount; ++next) {
+            TYPE value;
+            mQueue.pop(value);      // wait without spin
+            ASSERT_TRUE(value == next);
+        }
+        ASSERT_TRUE(mQueue.empty());
+    }
+};
+
+template <class TYPE> void testBlockingQueue() {
+    BlockingQueue<TYPE> queue;
+    TYPE value;
+    ASSERT_FALSE(queue.pop(value, 0));
+    int64_t now = SystemTimeUs();
+    ASSERT_FALSE(queue.pop(value, 10000));  // 10ms
+    ASSERT_GE(SystemTimeUs() - now, 10000);
+
+    queue.push(1);
+    ASSERT_TRUE(queue.pop(value, 10000));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(queue.empty());
+
+    sp<BlockingQueueConsumer<TYPE> > consumer = new BlockingQueueConsumer<TYPE>();
+    Thread thread(consumer);
+    thread.run();
+    for (int i = 0; i < consumer->kCount; ++i) {
+        consumer->mQueue.push(i);
+        if ((i % 1000) == 0) SleepTimeMs(1);    // let consumer park
+    }
+    thread.join();
+    ASSERT_TRUE(consumer->mQueue.empty());
+}
+
+void testBlockingQueue1() { testBlockingQueue<int>();       }
+void testBlockingQueue2() { testBlockingQueue<Integer>();   }
+
+template <class TYPE> struct StackWorker : public Job {
+    static const int kCount = 10000;
+    LockFree::Stack<TYPE>   mStack;
+    virtual void onJob() {
+        // push & pop from multi threads, total count is not changed
+        for (int i = 0; i < kCount; ++i) {
+            TYPE value;
+            mStack.push(i);
+            while (!mStack.pop(value)) { }
+        }
+    }
+};
+
+template <class TYPE> void testStack() {
+    LockFree::Stack<TYPE> stack;
+    ASSERT_EQ(stack.size(), 0);
+    ASSERT_TRUE(stack.empty());
+
+    stack.push(1);
+    ASSERT_EQ(stack.size(), 1);
+    stack.push(2);
+    ASSERT_EQ(stack.size(), 2);
+
+    TYPE value;
+    ASSERT_TRUE(stack.pop(value));
+    ASSERT_EQ(value, 2);
+    ASSERT_EQ(stack.size(), 1);
+    ASSERT_TRUE(stack.pop(value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(stack.empty());
+    ASSERT_FALSE(stack.pop(value));
+
+    stack.push(3);
+    stack.clear();
+    ASSERT_TRUE(stack.empty());
+
+    // multi producer & multi consumer
+    sp<StackWorker<TYPE> > worker = new StackWorker<TYPE>;
+    Vector<Thread> threads;
+    for (size_t i = 0; i < 4; ++i) threads.push(Thread(worker));
+    for (size_t i = 0; i < 4; ++i) threads[i].run();
+    for (size_t i = 0; i < 4; ++i) threads[i].join();
+    ASSERT_TRUE(worker->mStack.empty());
+}
+
+void testStack1() { testStack<int>();       }
+void testStack2() { testStack<Integer>();   }
+
 template <class TYPE> void testList() {
     List<TYPE> list;
     
@@ -653,6 +1975,28 @@ template <class TYPE> void testHashTable() {
     }
 }
 
+void testHash() {
+    // all lengths through each code path, prefixes differ
+    char data[256];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = (char)i;
+    HashTable<uint64_t, size_t> seen;
+    for (size_t n = 0; n <= sizeof(data); ++n) {
+        const uint64_t h = HashBytes(data, n);
+        ASSERT_EQ(h, HashBytes(data, n));
+        ASSERT_NE(h, HashBytes(data, n, kHashSeed + 1));
+        ASSERT_TRUE(seen.find(h) == NULL);
+        seen.insert(h, n);
+    }
+    ASSERT_EQ(String("a string longer than 16 bytes").hash(),
+            HashBytes("a string longer than 16 bytes", 29));
+
+    // strided keys spread over buckets
+    size_t buckets[64] = { 0 };
+    for (size_t i = 0; i < 64 * 16; ++i) buckets[hash<int>(i * 1024) % 64]++;
+    for (size_t i = 0; i < 64; ++i) ASSERT_LT(buckets[i], 48);
+    ASSERT_NE(HashMix(1), HashMix(2));
+}
+
 void testHashTable1() { testHashTable<int>();       }
 void testHashTable2() { testHashTable<Integer>();   }
 
@@ -704,17 +2048,40 @@ extern "C" void malloc_finalize();
 
 TEST_ENTRY(testAtomic);
 TEST_ENTRY(testSharedObject);
+TEST_ENTRY(testSharedBuffer);
 TEST_ENTRY(testAllocator);
+TEST_ENTRY(testPoolAllocator);
+TEST_ENTRY(testArenaAllocator);
+TEST_ENTRY(testHugePageAllocator);
+TEST_ENTRY(testInstrumentedAllocator);
+TEST_ENTRY(testHeapProfiler);
+TEST_ENTRY(testThreadCacheAllocator);
 TEST_ENTRY(testQueue1);
 TEST_ENTRY(testQueue2);
+TEST_ENTRY(testQueue3);
+TEST_ENTRY(testConcurrentQueue);
+TEST_ENTRY(testBlockingQueue1);
+TEST_ENTRY(testBlockingQueue2);
+TEST_ENTRY(testStack1);
+TEST_ENTRY(testStack2);
 TEST_ENTRY(testList1);
 TEST_ENTRY(testList2);
 TEST_ENTRY(testVector1);
 TEST_ENTRY(testVector2);
+TEST_ENTRY(testHash);
 TEST_ENTRY(testHashTable1);
 TEST_ENTRY(testHashTable2);
 TEST_ENTRY(testString);
+TEST_ENTRY(testStringSIMD);
+TEST_ENTRY(testStringUTF);
+TEST_ENTRY(testStringBuilder);
+TEST_ENTRY(testStringView);
+TEST_ENTRY(testNumber);
+TEST_ENTRY(testCord);
+TEST_ENTRY(testAtom);
 TEST_ENTRY(testBuffer);
+TEST_ENTRY(testBufferChain);
+TEST_ENTRY(testBitReader);
 TEST_ENTRY(testMessage);
 TEST_ENTRY(testThread);
 TEST_ENTRY(testLooper);
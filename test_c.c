@@ -24,9 +24,39 @@ void testBuffer() {
     malloc_finalize();
 }
 
+void testAllocatorStats() {
+    AllocatorRef allocator = AllocatorGetDefault();
+    AllocatorRef instrumented = AllocatorCreateInstrumented("test", allocator);
+
+    AllocatorStats stats;
+    CHECK_FALSE(AllocatorGetStats(allocator, &stats));
+    CHECK_EQ(stats.allocations, 0);
+    SharedObjectRelease(allocator);
+
+    void * p = AllocatorAllocate(instrumented, 100);
+    p = AllocatorReallocate(instrumented, p, 1000);
+
+    CHECK_TRUE(AllocatorGetStats(instrumented, &stats));
+    CHECK_TRUE(!strcmp(stats.name, "test"));
+    CHECK_EQ(stats.live, 1000);
+    CHECK_EQ(stats.allocations, 1);
+    CHECK_EQ(stats.reallocations, 1);
+    CHECK_EQ(stats.histogram[7], 1);    // 100
+    CHECK_EQ(stats.histogram[10], 1);   // 1000
+
+    AllocatorDeallocate(instrumented, p);
+    AllocatorGetStats(instrumented, &stats);
+    CHECK_EQ(stats.live, 0);
+    CHECK_EQ(stats.peak, 1000);
+    CHECK_EQ(stats.deallocations, 1);
+
+    SharedObjectRelease(instrumented);
+}
+
 int main (int argc, char ** argv) {
     
     testBuffer();
+    testAllocatorStats();
     
     return 0;
 }